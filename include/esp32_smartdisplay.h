@@ -6,6 +6,9 @@
 #include <display/lv_display_private.h>
 #include <misc/lv_timer_private.h>
 #include <indev/lv_indev_private.h>
+#include <esp32_smartdisplay_assets.h>
+#include <esp32_smartdisplay_trace.h>
+#include <esp32_smartdisplay_window.h>
 
 // Use last PWM_CHANNEL for backlight
 #define PWM_CHANNEL_BCKL (SOC_LEDC_CHANNEL_NUM - 1)
@@ -49,6 +52,319 @@ extern "C"
 #ifdef BOARD_HAS_RGB_LED
     void smartdisplay_led_set_rgb(bool r, bool g, bool b);
 #endif
+
+    // Idle power governor
+    typedef enum
+    {
+        SMARTDISPLAY_POWER_ACTIVE,
+        SMARTDISPLAY_POWER_DIMMED,
+        SMARTDISPLAY_POWER_SLEEP,
+        SMARTDISPLAY_POWER_STATES
+    } smartdisplay_power_state_t;
+
+    typedef struct
+    {
+        uint32_t dim_timeout;      // Inactivity [ms] before dimming the backlight and slowing the refresh. 0 = disabled
+        uint32_t sleep_timeout;    // Inactivity [ms] before the backlight, panel and touch are put to sleep. 0 = disabled
+        float dim_brightness;      // Backlight when dimmed, relative to the active brightness [0, 1]
+        uint32_t dim_refr_period;  // LVGL refresh period [ms] when dimmed
+        bool touch_sleep;          // Put the touch controller in sleep mode when sleeping
+    } smartdisplay_power_config_t;
+
+    typedef struct
+    {
+        smartdisplay_power_state_t state;
+        uint32_t wakeups;
+        uint32_t last_wake_latency_us; // Time between the wake event (touch INT, touch or call) and the display being restored
+        uint32_t max_wake_latency_us;
+        uint64_t state_time_us[SMARTDISPLAY_POWER_STATES]; // Time spent in each state, to multiply with the measured current per state
+    } smartdisplay_power_stats_t;
+
+// XPT2046 keeps PENIRQ enabled in power down. The capacitive controllers stop scanning when asleep
+#ifdef TOUCH_XPT2046_SPI
+#define SMARTDISPLAY_POWER_TOUCH_SLEEP true
+#else
+#define SMARTDISPLAY_POWER_TOUCH_SLEEP false
+#endif
+
+#define SMARTDISPLAY_POWER_CONFIG_DEFAULT() {.dim_timeout = 30000, .sleep_timeout = 120000, .dim_brightness = 0.2f, .dim_refr_period = 100, .touch_sleep = SMARTDISPLAY_POWER_TOUCH_SLEEP}
+
+    // Enable the idle power governor. NULL disables the governor (and wakes the display)
+    void smartdisplay_power_set_config(const smartdisplay_power_config_t *config);
+    // Return to the active state and restart the inactivity timeouts
+    void smartdisplay_power_wake();
+    void smartdisplay_power_get_stats(smartdisplay_power_stats_t *stats);
+
+    // Dynamic refresh rate governor
+    typedef struct
+    {
+        uint32_t min_period;       // Refresh period [ms] when interacting or animating
+        uint32_t max_period;       // Refresh period [ms] when static
+        uint32_t period;           // Current refresh period [ms]
+        uint32_t changes;          // Number of period changes
+        uint32_t invalidated_area; // Pixels invalidated in the last governor interval
+        bool animating;            // Animations running in the last governor interval
+    } smartdisplay_refresh_stats_t;
+
+    // Adapt the LVGL refresh period between min_period and max_period [ms]. 0 for both disables the governor
+    void smartdisplay_refresh_set_bounds(uint32_t min_period, uint32_t max_period);
+    void smartdisplay_refresh_get_stats(smartdisplay_refresh_stats_t *stats);
+
+    // Draw buffer selected by the tuning (SMARTDISPLAY_BUFFER_TUNE)
+    typedef struct
+    {
+        uint32_t pixels;     // Size of the draw buffer in pixels
+        uint32_t caps;       // Memory capabilities used to allocate the buffer
+        uint32_t throughput; // Measured flush throughput [pixels/s]
+        bool from_nvs;       // Result restored from a previous tuning
+    } smartdisplay_draw_buffer_info_t;
+
+    void smartdisplay_draw_buffer_get_info(smartdisplay_draw_buffer_info_t *info);
+
+    // Shadow buffer delta transport for SPI panels (SMARTDISPLAY_SHADOW_BUFFER)
+    typedef smartdisplay_window_stats_t smartdisplay_shadow_stats_t;
+
+    void smartdisplay_shadow_get_stats(smartdisplay_shadow_stats_t *stats);
+
+    // Circular mask for the GC9A01 round panel (SMARTDISPLAY_ROUND_MASK)
+    typedef smartdisplay_window_stats_t smartdisplay_round_stats_t;
+
+    void smartdisplay_round_get_stats(smartdisplay_round_stats_t *stats);
+
+    // PSRAM image and glyph cache (SMARTDISPLAY_PSRAM_CACHE)
+    typedef struct
+    {
+        uint32_t size;     // Bytes in use
+        uint32_t max_size; // Bytes available
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+    } smartdisplay_cache_stats_t;
+
+    // Copy of the font that uses the glyph cache. Returns the font itself if the cache is not enabled
+    const lv_font_t *smartdisplay_cache_font(const lv_font_t *font);
+    void smartdisplay_cache_get_stats(smartdisplay_cache_stats_t *image, smartdisplay_cache_stats_t *glyph);
+
+    // LVGL heap pools (SMARTDISPLAY_LVGL_HEAP_INTERNAL, SMARTDISPLAY_LVGL_HEAP_PSRAM)
+#define SMARTDISPLAY_HEAP_MAX_POOLS 4
+
+    typedef struct
+    {
+        uint32_t caps;         // Memory capabilities of the pool
+        uint32_t size;
+        uint32_t used;
+        uint32_t max_used;     // High-water mark (sampled every 250ms)
+        uint32_t free_biggest; // Largest free block
+        uint8_t frag_pct;
+    } smartdisplay_heap_pool_stats_t;
+
+    typedef struct
+    {
+        uint32_t total_size; // All pools including LV_MEM_SIZE
+        uint32_t used;
+        uint32_t max_used;
+        uint8_t frag_pct;
+        uint8_t pool_count;
+        smartdisplay_heap_pool_stats_t pools[SMARTDISPLAY_HEAP_MAX_POOLS];
+    } smartdisplay_heap_stats_t;
+
+    // Add a pool allocated with the capabilities (MALLOC_CAP_SPIRAM, MALLOC_CAP_INTERNAL) to the LVGL heap
+    bool smartdisplay_heap_add_pool(uint32_t size, uint32_t caps);
+    void smartdisplay_heap_get_stats(smartdisplay_heap_stats_t *stats);
+
+    // Render benchmark
+    typedef enum
+    {
+        SMARTDISPLAY_BENCHMARK_SCROLL,
+        SMARTDISPLAY_BENCHMARK_ARCS,
+        SMARTDISPLAY_BENCHMARK_FADE,
+        SMARTDISPLAY_BENCHMARK_TEXT,
+        SMARTDISPLAY_BENCHMARK_SCENES
+    } smartdisplay_benchmark_scene_t;
+
+    typedef struct
+    {
+        smartdisplay_benchmark_scene_t scene;
+        uint32_t frames;
+        float fps;
+        float render_ms;           // CPU render time per frame
+        float flush_ms;            // Time in the flush callback per frame
+        float wait_ms;             // Time waiting for the transfer per frame
+        float bus_pct;             // Part of the time the bus is busy (flush and waiting)
+        uint32_t pixels_per_frame; // Pixels flushed per frame
+        float scaled_pct;          // Frames rendered at a reduced resolution (SMARTDISPLAY_DRS)
+    } smartdisplay_benchmark_result_t;
+
+    // Run the scene on a new screen for duration [ms] as fast as possible. Blocks while running
+    void smartdisplay_benchmark_run(smartdisplay_benchmark_scene_t scene, uint32_t duration, smartdisplay_benchmark_result_t *result);
+    // Print the result for tools/smartdisplay_benchmark.py
+    void smartdisplay_benchmark_print(const smartdisplay_benchmark_result_t *result);
+
+    // Panel and touch IO recorder (SMARTDISPLAY_IO_RECORDER)
+#define SMARTDISPLAY_IO_RECORDER_MAX_IO 4
+
+    typedef struct
+    {
+        const char *name;
+        uint32_t transactions[3]; // rx_param, tx_param, tx_color
+        uint64_t bytes[3];
+    } smartdisplay_io_recorder_io_stats_t;
+
+    typedef struct
+    {
+        uint8_t io_count;
+        uint32_t overflows; // Transactions counted but not recorded
+        smartdisplay_io_recorder_io_stats_t io[SMARTDISPLAY_IO_RECORDER_MAX_IO];
+    } smartdisplay_io_recorder_stats_t;
+
+    // Recording starts at boot. Start clears the recording and counters
+    void smartdisplay_io_recorder_start();
+    void smartdisplay_io_recorder_stop();
+    // Print the recording for tools/smartdisplay_io_diff.py
+    void smartdisplay_io_recorder_dump();
+    void smartdisplay_io_recorder_get_stats(smartdisplay_io_recorder_stats_t *stats);
+
+    // Timeline of the refresh, render, flush, transfer and touch (SMARTDISPLAY_TIMELINE)
+    void smartdisplay_timeline_start();
+    void smartdisplay_timeline_stop();
+    // Markers for the application, e.g. around lv_timer_handler(). The name must be a static string
+    void smartdisplay_timeline_begin(const char *name);
+    void smartdisplay_timeline_end(const char *name);
+    // Print the timeline as Chrome trace JSON
+    void smartdisplay_timeline_dump();
+
+    // RGB panel scan out (ST7701, ST7262)
+    typedef struct
+    {
+        uint32_t pclk_hz;
+        uint32_t bounce_buffer_size_px; // 0 if scanned out from the frame buffer
+        uint32_t frames;
+        uint32_t underruns; // Refills of the bounce buffers later than sending one bounce buffer takes
+        uint32_t restarts;
+    } smartdisplay_rgb_stats_t;
+
+    void smartdisplay_rgb_get_stats(smartdisplay_rgb_stats_t *stats);
+    // Set the highest pixel clock without underruns while rendering full screen updates for duration [ms] per step. Blocks while running
+    uint32_t smartdisplay_rgb_find_pclk(uint32_t min_hz, uint32_t max_hz, uint32_t step_hz, uint32_t duration);
+
+    // Frame pacing with the tearing effect output of SPI panels (SMARTDISPLAY_TE_GPIO)
+    typedef struct
+    {
+        uint32_t edges;          // Tearing effect pulses (panel refreshes)
+        uint32_t period_us;      // Panel refresh period
+        uint32_t frames;         // Frames started after a pulse
+        uint32_t timeouts;       // Frames started without a pulse
+        uint32_t tears;          // Frames not written completely before the next pulse
+        uint32_t latency_us;     // Start of the last frame after the pulse
+        uint32_t latency_max_us;
+        uint32_t jitter_us;      // Deviation of the last frame interval from a whole number of refreshes
+        uint32_t jitter_max_us;
+    } smartdisplay_te_stats_t;
+
+    void smartdisplay_te_get_stats(smartdisplay_te_stats_t *stats);
+
+    // Frame buffer flipping at the vsync of RGB panels (SMARTDISPLAY_RGB_VSYNC)
+    typedef struct
+    {
+        uint32_t period_us;       // Panel refresh period
+        uint32_t presented;       // Frames flipped at a vsync
+        uint32_t latency_us;      // Start of the refresh to the start of the scan out of the last frame
+        uint32_t latency_max_us;
+        uint32_t present_wait_us; // Last frame ready to the start of the scan out
+    } smartdisplay_vsync_stats_t;
+
+    // Wait for the next vsync, e.g. before lv_timer_handler(). Returns false on timeout [ms]
+    bool smartdisplay_rgb_wait_vsync(uint32_t timeout);
+    void smartdisplay_vsync_get_stats(smartdisplay_vsync_stats_t *stats);
+
+    // 8 bit render (SMARTDISPLAY_RENDER_L8). Colors of the 256 luminance levels, NULL for gray
+    void smartdisplay_l8_set_lut(const lv_color_t *colors);
+
+    // Dynamic resolution scaling of RGB panels (SMARTDISPLAY_DRS)
+    typedef struct
+    {
+        bool scaled;              // Drawing the screen at half size
+        uint32_t switches;        // Changes of the scale
+        uint32_t frames;          // Frames rendered at half resolution
+        uint32_t invalidated_pct; // Invalidated part of the screen in the last governor interval
+    } smartdisplay_drs_stats_t;
+
+    // Enable or disable (default) the scaling
+    void smartdisplay_drs_enable(bool enable);
+    void smartdisplay_drs_get_stats(smartdisplay_drs_stats_t *stats);
+
+    // Hardware vertical scroll of SPI panels (SMARTDISPLAY_VSCROLL)
+    typedef struct
+    {
+        bool active;          // Scroll area defined for the attached object in the current rotation
+        uint32_t scrolls;     // Scrolls moved in the panel memory
+        uint32_t fallbacks;   // Scrolls rendered completely (too far, other changes or moved)
+        uint32_t lines;       // Lines moved in the panel memory
+        uint64_t bytes_saved; // Pixel bytes not sent because of the hardware scroll
+    } smartdisplay_vscroll_stats_t;
+
+    // Scroll a full width object with the panel. Returns false if not possible in the current rotation
+    bool smartdisplay_vscroll_attach(lv_obj_t *obj);
+    void smartdisplay_vscroll_detach();
+    void smartdisplay_vscroll_get_stats(smartdisplay_vscroll_stats_t *stats);
+
+    // Partial display and idle (8 color) mode of the SPI panels (SMARTDISPLAY_PARTIAL)
+    typedef enum
+    {
+        SMARTDISPLAY_PANEL_MODE_NORMAL = 0,
+        SMARTDISPLAY_PANEL_MODE_PARTIAL = 1,
+        SMARTDISPLAY_PANEL_MODE_IDLE = 2,
+        SMARTDISPLAY_PANEL_MODE_PARTIAL_IDLE = 3,
+        SMARTDISPLAY_PANEL_MODES
+    } smartdisplay_panel_mode_t;
+
+    typedef struct
+    {
+        smartdisplay_panel_mode_t mode;
+        int32_t y1; // Rows of the partial area
+        int32_t y2;
+        uint32_t clipped; // Invalidated areas clipped to the partial area
+        uint64_t mode_time_us[SMARTDISPLAY_PANEL_MODES];
+        uint64_t mode_bytes[SMARTDISPLAY_PANEL_MODES]; // Pixel bytes flushed in the mode
+    } smartdisplay_partial_stats_t;
+
+    // Display only the rows y1 to y2, LVGL only renders these rows. y2 < y1 returns to normal mode. Returns false if not supported (in this rotation)
+    bool smartdisplay_partial_set_area(int32_t y1, int32_t y2);
+    bool smartdisplay_partial_set_idle(bool idle);
+    void smartdisplay_partial_get_stats(smartdisplay_partial_stats_t *stats);
+
+    // SPI pixel clock selected by the tuning (SMARTDISPLAY_SPI_CLOCK_TUNE)
+    typedef struct
+    {
+        uint32_t pclk_hz;       // Pixel clock used [Hz]
+        uint32_t configured_hz; // Pixel clock of the board definition [Hz]
+        uint32_t max_pass_hz;   // Highest pixel clock that was read back correctly [Hz]
+        bool readback;          // The panel memory can be read back (MISO connected)
+        bool from_nvs;          // Result restored from a previous tuning
+    } smartdisplay_spi_clock_info_t;
+
+    void smartdisplay_spi_clock_get_info(smartdisplay_spi_clock_info_t *info);
+    // Erase the stored pixel clock, the next smartdisplay_init() tunes again
+    void smartdisplay_spi_clock_forget();
+
+    // Flushes per tile and flushes of unchanged pixels (SMARTDISPLAY_HEATMAP)
+    typedef struct
+    {
+        uint16_t tile_size; // Size of the tiles in pixels
+        uint16_t tiles_x;   // Tiles at the current resolution
+        uint16_t tiles_y;
+        uint32_t flushes;
+        uint64_t bytes;
+        uint32_t redundant; // Flushed areas with the same pixels as shown by the panel
+        uint64_t redundant_bytes;
+    } smartdisplay_heatmap_stats_t;
+
+    void smartdisplay_heatmap_get_stats(smartdisplay_heatmap_stats_t *stats);
+    void smartdisplay_heatmap_reset();
+    // Show the bytes flushed per tile on top of the screen. Not counted while shown
+    void smartdisplay_heatmap_show(bool show);
+    // Print the flushes, bytes and redundant flushes per tile
+    void smartdisplay_heatmap_dump();
 #ifdef __cplusplus
 }
 #endif
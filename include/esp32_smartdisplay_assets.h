@@ -0,0 +1,96 @@
+#ifndef ESP32_SMARTDISPLAY_ASSETS_H
+#define ESP32_SMARTDISPLAY_ASSETS_H
+
+// Asset bundle: images and fonts packed by tools/smartdisplay_pack_assets.py and used directly from the memory mapped bundle.
+// This header does not depend on Arduino so the bundle can also be loaded on Linux
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+#define SMARTDISPLAY_ASSETS_MAGIC "SDAB"
+#define SMARTDISPLAY_ASSETS_VERSION 1
+#define SMARTDISPLAY_ASSETS_NAME_LENGTH 32
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    typedef enum
+    {
+        SMARTDISPLAY_ASSET_RAW,
+        SMARTDISPLAY_ASSET_IMAGE,
+        SMARTDISPLAY_ASSET_FONT
+    } smartdisplay_asset_type_t;
+
+    // Bundle layout (little endian). Header, index and data are 4 byte aligned
+    typedef struct
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t count; // Number of index entries
+        uint32_t size;  // Size of the bundle including the header
+        uint32_t reserved;
+    } smartdisplay_assets_header_t;
+
+    typedef struct
+    {
+        char name[SMARTDISPLAY_ASSETS_NAME_LENGTH];
+        uint32_t type; // smartdisplay_asset_type_t
+        uint32_t offset; // Offset of the data from the start of the bundle
+        uint32_t size;
+        uint32_t reserved;
+    } smartdisplay_assets_entry_t;
+
+    // Data of a SMARTDISPLAY_ASSET_IMAGE, followed by the pixels
+    typedef struct
+    {
+        uint8_t cf; // lv_color_format_t
+        uint8_t reserved;
+        uint16_t flags;
+        uint16_t w;
+        uint16_t h;
+        uint16_t stride;
+        uint16_t reserved2;
+    } smartdisplay_assets_image_t;
+
+    // Data of a SMARTDISPLAY_ASSET_FONT, offsets are from the start of the font data
+    typedef struct
+    {
+        uint16_t line_height;
+        int16_t base_line;
+        int16_t underline_position;
+        int16_t underline_thickness;
+        uint8_t bpp;
+        uint8_t subpx;
+        uint16_t cmap_num;
+        uint32_t glyph_count;
+        uint32_t glyph_dsc_offset;    // lv_font_fmt_txt_glyph_dsc_t[glyph_count]
+        uint32_t glyph_bitmap_offset; // Packed glyph bitmaps
+        uint32_t cmaps_offset;        // smartdisplay_assets_cmap_t[cmap_num]
+    } smartdisplay_assets_font_t;
+
+    typedef struct
+    {
+        uint32_t range_start;
+        uint16_t range_length;
+        uint16_t glyph_id_start;
+        uint16_t list_length;
+        uint8_t type; // lv_font_fmt_txt_cmap_type_t
+        uint8_t reserved;
+        uint32_t unicode_list_offset;       // uint16_t[list_length], 0 if not used
+        uint32_t glyph_id_ofs_list_offset;  // uint8_t (format 0) or uint16_t (sparse)[list_length], 0 if not used
+    } smartdisplay_assets_cmap_t;
+
+    // Map the bundle. On the ESP32 name is the label of the data partition, on Linux the path of the bundle file
+    bool smartdisplay_assets_open(const char *name);
+    void smartdisplay_assets_close();
+    // Data of the entry in the bundle (no copy). NULL if not found
+    const void *smartdisplay_assets_get(const char *name, smartdisplay_asset_type_t *type, uint32_t *size);
+    // Image and font sources pointing to the mapped data. Valid until the bundle is closed
+    const lv_image_dsc_t *smartdisplay_assets_get_image(const char *name);
+    const lv_font_t *smartdisplay_assets_get_font(const char *name);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
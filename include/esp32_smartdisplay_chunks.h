@@ -0,0 +1,49 @@
+#ifndef ESP32_SMARTDISPLAY_CHUNKS_H
+#define ESP32_SMARTDISPLAY_CHUNKS_H
+
+// Areas sent to an SPI panel in chunks of rows, the next chunk is filled while the previous one is sent (L8 expansion,
+// pipelined byte swap and bounce buffers). This header does not depend on Arduino so the chunks can be tested on the host
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+#include <esp_lcd_types.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Chunks filled while the previous one is sent
+#define SMARTDISPLAY_CHUNK_BUFFERS 2
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    // Fill a chunk of rows x width pixels from the draw buffer (stride in bytes). dest is src when filled in place
+    typedef void (*smartdisplay_chunk_fill_cb_t)(uint16_t *dest, const uint8_t *src, int32_t width, int32_t rows, uint32_t stride, const void *user_data);
+
+    typedef struct
+    {
+        smartdisplay_chunk_fill_cb_t fill;
+        const void *user_data;
+        // DMA capable buffers the chunks are filled in. Without, the chunks are filled in place in the draw buffer
+        uint16_t *buffers[SMARTDISPLAY_CHUNK_BUFFERS];
+        uint32_t buffer_pixels;
+        SemaphoreHandle_t semaphore;
+        // Chunks of the area still to be sent
+        volatile uint32_t remaining;
+    } smartdisplay_chunks_t;
+
+    // Allocate buffer_pixels per buffer (none if 0). Returns false if the buffers can not be allocated
+    bool smartdisplay_chunks_init(smartdisplay_chunks_t *chunks, smartdisplay_chunk_fill_cb_t fill, const void *user_data, uint32_t buffer_pixels);
+    // Fill and draw the area in chunks of chunk_rows rows. Waits until the chunk previously sent from the buffer is complete
+    void smartdisplay_chunks_send(smartdisplay_chunks_t *chunks, esp_lcd_panel_handle_t panel_handle, const lv_area_t *area, uint8_t *px_map, uint32_t stride, int32_t chunk_rows);
+    // Called from the color transfer done ISR. Returns true when the last chunk of the area is sent
+    bool smartdisplay_chunks_trans_done(smartdisplay_chunks_t *chunks);
+    // RGB565 byte swap, two pixels per 32 bit word when aligned
+    void smartdisplay_chunk_swap(uint16_t *dest, const uint8_t *src, int32_t width, int32_t rows, uint32_t stride, const void *user_data);
+    // L8 to RGB565 by the lookup table of 256 colors in user_data
+    void smartdisplay_chunk_expand_l8(uint16_t *dest, const uint8_t *src, int32_t width, int32_t rows, uint32_t stride, const void *user_data);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef ESP32_SMARTDISPLAY_HEATMAP_TILES_H
+#define ESP32_SMARTDISPLAY_HEATMAP_TILES_H
+
+// Flushes counted per tile of the screen and detection of flushes that do not change pixels (heatmap).
+// This header does not depend on Arduino so the tiling can be tested on the host
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    typedef struct
+    {
+        uint32_t flushes;
+        uint32_t bytes;
+        uint32_t redundant;
+    } smartdisplay_heatmap_tile_t;
+
+    // Count the area in every (square) tile it covers, with the bytes of the part of the area in the tile. tiles_x tiles per row
+    void smartdisplay_heatmap_tiles_add(smartdisplay_heatmap_tile_t *tiles, int32_t tile_size, uint32_t tiles_x, const lv_area_t *area, uint32_t px_size, bool redundant);
+    // Compare the rendered area (stride in bytes) with the copy of the screen of hor_res pixels wide and update the copy.
+    // Returns true if no pixel changed
+    bool smartdisplay_heatmap_copy_update(uint8_t *copy, int32_t hor_res, const lv_area_t *area, const uint8_t *src, uint32_t stride, uint32_t px_size);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
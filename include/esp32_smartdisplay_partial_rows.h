@@ -0,0 +1,30 @@
+#ifndef ESP32_SMARTDISPLAY_PARTIAL_ROWS_H
+#define ESP32_SMARTDISPLAY_PARTIAL_ROWS_H
+
+// Rows of the partial display area of the SPI panels (PTLAR).
+// This header does not depend on Arduino so the clipping can be tested on the host
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    typedef enum
+    {
+        SMARTDISPLAY_PARTIAL_INSIDE,
+        SMARTDISPLAY_PARTIAL_CLIPPED,
+        SMARTDISPLAY_PARTIAL_OUTSIDE
+    } smartdisplay_partial_clip_t;
+
+    // Clip the area to the rows y1 to y2. An area completely outside the rows is not changed
+    smartdisplay_partial_clip_t smartdisplay_partial_clip(lv_area_t *area, int32_t y1, int32_t y2);
+    // Rows of the panel memory (start and end of PTLAR) of the display rows y1 to y2. Panel rows are in the opposite
+    // direction of the display rows when mirrored
+    void smartdisplay_partial_rows(int32_t gram_rows, int32_t gap_y, bool mirror, int32_t y1, int32_t y2, int32_t *start, int32_t *end);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
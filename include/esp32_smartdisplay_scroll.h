@@ -0,0 +1,56 @@
+#ifndef ESP32_SMARTDISPLAY_SCROLL_H
+#define ESP32_SMARTDISPLAY_SCROLL_H
+
+// Scroll area of the panel memory for the hardware vertical scroll (VSCRDEF and VSCRSADD).
+// This header does not depend on Arduino so the scroll calculation can be tested on the host
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+// Maximum number of windows for one area: above, two parts of the scroll area and below
+#define SMARTDISPLAY_SCROLL_MAX_WINDOWS 4
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    // Rows y1..y2 of the area (display rows) written at dest_y in the panel memory
+    typedef struct
+    {
+        int32_t y1;
+        int32_t y2;
+        int32_t dest_y;
+    } smartdisplay_scroll_window_t;
+
+    // Scroll area of height rows starting at display row y1. Panel rows are in the opposite direction of the display rows when mirrored
+    typedef struct
+    {
+        int32_t gram_rows;
+        int32_t gap_y;
+        int32_t y1;
+        int32_t height;
+        bool mirror;
+    } smartdisplay_scroll_area_t;
+
+    // Top fixed area in panel rows
+    int32_t smartdisplay_scroll_top_fixed_area(const smartdisplay_scroll_area_t *scroll);
+    // Scroll start address of the content moved offset rows
+    int32_t smartdisplay_scroll_start(const smartdisplay_scroll_area_t *scroll, int32_t offset);
+    // Offset after scrolling dy rows, modulo the height
+    int32_t smartdisplay_scroll_offset(const smartdisplay_scroll_area_t *scroll, int32_t offset, int32_t dy);
+    // Move the invalidated areas in the scroll area dy rows with the content and set the exposed rows. Returns false,
+    // without changing the areas, if an area crosses the edge of the scroll area
+    bool smartdisplay_scroll_move_areas(const smartdisplay_scroll_area_t *scroll, int32_t width, int32_t dy, lv_area_t *areas, uint32_t count, lv_area_t *exposed);
+    // Replace the invalidation of the scrolled object (full width, covering the scroll area) by the exposed rows. Returns
+    // false for other areas, e.g. the scrollbar
+    bool smartdisplay_scroll_crop(const smartdisplay_scroll_area_t *scroll, int32_t width, const lv_area_t *exposed, lv_area_t *area);
+    // Bytes of the rows of the area in the scroll area
+    uint32_t smartdisplay_scroll_bytes(const smartdisplay_scroll_area_t *scroll, const lv_area_t *area, uint32_t px_size);
+    // Split the area in the rows above, the parts of the scroll area before and after the wrap around and the rows below.
+    // Returns the number of windows
+    uint32_t smartdisplay_scroll_windows(const smartdisplay_scroll_area_t *scroll, int32_t offset, const lv_area_t *area, smartdisplay_scroll_window_t *windows);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
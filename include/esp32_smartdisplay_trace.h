@@ -0,0 +1,97 @@
+#ifndef ESP32_SMARTDISPLAY_TRACE_H
+#define ESP32_SMARTDISPLAY_TRACE_H
+
+// Deferred trace logging for the hot paths (flush, transfer done and touch).
+// Only the event id and raw arguments are recorded in a lock-free ring buffer. Formatting is done by a low priority task
+// or on the host by tools/smartdisplay_trace_decode.py. Traces above SMARTDISPLAY_TRACE_LEVEL are compiled out
+#include <stdint.h>
+#include <esp32-hal-log.h>
+
+#ifndef SMARTDISPLAY_TRACE_LEVEL
+#define SMARTDISPLAY_TRACE_LEVEL ARDUHAL_LOG_LEVEL_NONE
+#endif
+
+// Number of entries in the ring buffer (power of 2)
+#ifndef SMARTDISPLAY_TRACE_ENTRIES
+#define SMARTDISPLAY_TRACE_ENTRIES 256
+#endif
+
+#define SMARTDISPLAY_TRACE_MAX_ARGS 4
+
+// Trace events: id and format of the arguments. Parsed by tools/smartdisplay_trace_decode.py, only append
+#define SMARTDISPLAY_TRACE_EVENTS(EVENT)                                            \
+    EVENT(SMARTDISPLAY_TRACE_FLUSH, "flush x1:%d, y1:%d, x2:%d, y2:%d")             \
+    EVENT(SMARTDISPLAY_TRACE_FLUSH_DONE, "flush done")                              \
+    EVENT(SMARTDISPLAY_TRACE_TOUCH_READ, "touch read points:%d")                    \
+    EVENT(SMARTDISPLAY_TRACE_TOUCH_POINT, "touch point #%d: (%d,%d), area:%d")      \
+    EVENT(SMARTDISPLAY_TRACE_TOUCH_PRESSED, "pressed at: (%d,%d)")                  \
+    EVENT(SMARTDISPLAY_TRACE_TOUCH_CALIBRATE, "calibrate point (%d,%d) => (%d,%d)") \
+    EVENT(SMARTDISPLAY_TRACE_USER, "user %d, %d, %d, %d")
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#define SMARTDISPLAY_TRACE_EVENT_ID(id, format) id,
+    typedef enum
+    {
+        SMARTDISPLAY_TRACE_EVENTS(SMARTDISPLAY_TRACE_EVENT_ID)
+        SMARTDISPLAY_TRACE_EVENT_COUNT
+    } smartdisplay_trace_event_t;
+#undef SMARTDISPLAY_TRACE_EVENT_ID
+
+    typedef struct
+    {
+        uint32_t sequence; // Set when the entry is complete
+        uint32_t timestamp; // [us]
+        uint16_t event;
+        uint8_t core;
+        uint8_t level;
+        uint32_t args[SMARTDISPLAY_TRACE_MAX_ARGS];
+    } smartdisplay_trace_entry_t;
+
+    typedef struct
+    {
+        uint32_t recorded;
+        uint32_t dropped; // Ring buffer full
+    } smartdisplay_trace_stats_t;
+
+    // Safe to call from an ISR. Use the smartdisplay_trace_x macros so the calls are compiled out
+    void smartdisplay_trace_record(uint8_t level, uint16_t event, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+    void smartdisplay_trace_get_stats(smartdisplay_trace_stats_t *stats);
+#ifdef __cplusplus
+}
+#endif
+
+// Fill the missing arguments with 0
+#define SMARTDISPLAY_TRACE_ARGS(dummy, arg0, arg1, arg2, arg3, ...) (uint32_t)(arg0), (uint32_t)(arg1), (uint32_t)(arg2), (uint32_t)(arg3)
+#define SMARTDISPLAY_TRACE(level, event, ...) smartdisplay_trace_record(level, event, SMARTDISPLAY_TRACE_ARGS(0, ##__VA_ARGS__, 0, 0, 0, 0, 0))
+
+#if SMARTDISPLAY_TRACE_LEVEL >= ARDUHAL_LOG_LEVEL_VERBOSE
+#define smartdisplay_trace_v(event, ...) SMARTDISPLAY_TRACE(ARDUHAL_LOG_LEVEL_VERBOSE, event, ##__VA_ARGS__)
+#else
+#define smartdisplay_trace_v(event, ...) \
+    do                                   \
+    {                                    \
+    } while (0)
+#endif
+
+#if SMARTDISPLAY_TRACE_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define smartdisplay_trace_d(event, ...) SMARTDISPLAY_TRACE(ARDUHAL_LOG_LEVEL_DEBUG, event, ##__VA_ARGS__)
+#else
+#define smartdisplay_trace_d(event, ...) \
+    do                                   \
+    {                                    \
+    } while (0)
+#endif
+
+#if SMARTDISPLAY_TRACE_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+#define smartdisplay_trace_i(event, ...) SMARTDISPLAY_TRACE(ARDUHAL_LOG_LEVEL_INFO, event, ##__VA_ARGS__)
+#else
+#define smartdisplay_trace_i(event, ...) \
+    do                                   \
+    {                                    \
+    } while (0)
+#endif
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef ESP32_SMARTDISPLAY_UPSCALE_H
+#define ESP32_SMARTDISPLAY_UPSCALE_H
+
+// 2x upscaling of the areas rendered at half resolution into the RGB565 frame buffer (dynamic resolution scaling).
+// This header does not depend on Arduino so the upscaling can be tested on the host
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    typedef struct
+    {
+        // Horizontally doubled source rows, two pixels per word
+        uint32_t *rows[2];
+        // Last source row of the previous area, the odd row below it is interpolated with the next area
+        uint32_t *carry;
+        bool carried;
+        int32_t carry_x1;
+        int32_t carry_x2;
+        int32_t carry_y;
+    } smartdisplay_upscale_t;
+
+    // Row buffers of width (source) pixels
+    bool smartdisplay_upscale_init(smartdisplay_upscale_t *upscale, int32_t width);
+    // Forget the previous area, e.g. after switching the resolution
+    void smartdisplay_upscale_reset(smartdisplay_upscale_t *upscale);
+    // Every pixel is written as 2x2 pixels. stride in pixels
+    void smartdisplay_upscale_nearest(uint16_t *frame_buffer, int32_t frame_buffer_width, const lv_area_t *area, const uint16_t *src, uint32_t stride);
+    // Pixels and rows are interpolated with the next one. The last row of an area is interpolated with the first row of
+    // the area below it when flushed next. Returns the first row written in the frame buffer
+    int32_t smartdisplay_upscale_bilinear(smartdisplay_upscale_t *upscale, uint16_t *frame_buffer, int32_t frame_buffer_width, const lv_area_t *area, const uint16_t *src, uint32_t stride);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef ESP32_SMARTDISPLAY_WINDOW_H
+#define ESP32_SMARTDISPLAY_WINDOW_H
+
+// Areas sent to an SPI panel as several address windows (shadow buffer and round mask).
+// This header does not depend on Arduino so the window calculation can be tested on the host
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+#include <esp_lcd_types.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    typedef struct
+    {
+        uint32_t frame_bytes;      // Pixel bytes rendered in the last frame
+        uint32_t frame_bytes_sent; // Pixel bytes sent to the panel in the last frame
+        uint32_t frame_windows;    // Address windows set in the last frame
+        uint32_t frames;
+        uint64_t bytes_sent;
+        uint64_t bytes_saved;
+    } smartdisplay_window_stats_t;
+
+    // Part of the area. x is relative to the area, y is the row of the display
+    typedef struct
+    {
+        int16_t x1;
+        int16_t y1;
+        int16_t x2;
+        int16_t y2;
+    } smartdisplay_window_t;
+
+    typedef struct
+    {
+        smartdisplay_window_t *windows;
+        uint32_t max_windows;
+        // Cost of an extra address window (CASET, RASET and RAMWR transactions) expressed in pixel bytes
+        uint32_t window_cost;
+        lv_area_t area;
+        // Windows added, more than max_windows on overflow
+        uint32_t count;
+        uint32_t bytes;
+        // Color transfers to complete before the flush is ready
+        volatile uint32_t pending;
+        // Accumulated for the frame being rendered
+        uint32_t frame_bytes;
+        uint32_t frame_bytes_sent;
+        uint32_t frame_windows;
+        smartdisplay_window_stats_t stats;
+    } smartdisplay_window_list_t;
+
+    void smartdisplay_window_begin(smartdisplay_window_list_t *list, const lv_area_t *area);
+    // Add the pixels x1..x2 of row y. Merged with the window of the previous row if the extra pixels are cheaper than a new window
+    void smartdisplay_window_add(smartdisplay_window_list_t *list, int32_t y, int32_t x1, int32_t x2);
+    // Add the pixels of row y that differ from the copy of the panel memory. Unchanged gaps cheaper than a new window are sent
+    void smartdisplay_window_add_changes(smartdisplay_window_list_t *list, int32_t y, const uint16_t *pixels, const uint16_t *gram);
+    // Send the area as one window if the windows are not cheaper and update the statistics (at the last area of the frame)
+    void smartdisplay_window_end(smartdisplay_window_list_t *list, bool last);
+    // Move the rows of every window together in the pixels of the area and draw the windows. Returns false if there are no windows
+    bool smartdisplay_window_send(smartdisplay_window_list_t *list, esp_lcd_panel_handle_t panel_handle, uint16_t *pixels);
+    // Called from the color transfer done ISR. Returns true when the last window of the area is sent
+    bool smartdisplay_window_trans_done(smartdisplay_window_list_t *list);
+    // Visible pixels of every row of the circle filling a square display (x2 < x1 if none)
+    void smartdisplay_window_circle(int32_t width, int32_t height, int16_t *x1, int16_t *x2);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
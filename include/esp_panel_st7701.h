@@ -17,6 +17,8 @@ extern "C"
     } st7701_vendor_config_t;
 
     esp_err_t esp_lcd_new_panel_st7701(const esp_lcd_panel_io_handle_t io, const esp_lcd_rgb_panel_config_t *panel_config, const esp_lcd_panel_dev_config_t *config, esp_lcd_panel_handle_t *handle);
+    // RGB panel driven by the ST7701, for the esp_lcd_rgb_panel_* functions
+    esp_err_t esp_lcd_panel_st7701_get_rgb_panel(esp_lcd_panel_handle_t panel, esp_lcd_panel_handle_t *rgb_panel);
 
 #ifdef __cplusplus
 }
@@ -12,6 +12,53 @@
 // Functions to be defined in the tft/touch driver
 extern lv_display_t *lvgl_lcd_init();
 extern lv_indev_t *lvgl_touch_init();
+#if defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR)
+extern void lvgl_rgb_bounce_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_RGB_VSYNC
+extern void lvgl_rgb_vsync_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_RGB_DMA_COPY
+extern void lvgl_rgb_dma_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_DRS
+extern void lvgl_drs_init(lv_display_t *display);
+extern void lvgl_drs_touch(lv_indev_data_t *data);
+#endif
+#ifdef SMARTDISPLAY_TE_GPIO
+extern void lvgl_te_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_RENDER_L8
+extern void lvgl_l8_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_VSCROLL
+extern void lvgl_vscroll_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_PARTIAL
+extern void lvgl_partial_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_SPI_BOUNCE
+extern void lvgl_spi_bounce_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_BUFFER_TUNE
+extern void lvgl_draw_buffer_tune(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+extern void lvgl_shadow_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_ROUND_MASK
+extern void lvgl_round_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_HEATMAP
+extern void lvgl_heatmap_init(lv_display_t *display);
+#endif
+#ifdef SMARTDISPLAY_PSRAM_CACHE
+extern void lvgl_cache_init();
+#endif
+extern void lvgl_heap_init();
+#if SMARTDISPLAY_TRACE_LEVEL > ARDUHAL_LOG_LEVEL_NONE
+extern void lvgl_trace_init();
+#endif
 
 lv_display_t *display;
 
@@ -24,6 +71,8 @@ void (*driver_touch_read_cb)(lv_indev_t *indev, lv_indev_data_t *data);
 void lvgl_display_resolution_changed_callback(lv_event_t *drv);
 
 lv_timer_t *update_brightness_timer;
+// Last backlight duty set, restored by the power governor
+float backlight_duty;
 
 #ifdef LV_USE_LOG
 void lvgl_log(lv_log_level_t level, const char *buf)
@@ -55,6 +104,7 @@ void smartdisplay_lcd_set_backlight(float duty)
     duty = 1.0f;
   if (duty < 0.0f)
     duty = 0.0f;
+  backlight_duty = duty;
 #if ESP_ARDUINO_VERSION_MAJOR >= 3
   ledcWrite(DISPLAY_BCKL, duty * PWM_MAX_BCKL);
 #else
@@ -115,24 +165,71 @@ void smartdisplay_led_set_rgb(bool r, bool g, bool b)
 }
 #endif
 
+#if defined(SMARTDISPLAY_ROUND_MASK_RENDER) || defined(SMARTDISPLAY_PARTIAL)
+// An invalidated area can not be removed in the LV_EVENT_INVALIDATE_AREA event. An area that is not displayed is replaced by
+// the first invalidated area, so LVGL does not add it, or by a placeholder that is removed when the refresh starts
+bool invalidate_placeholder;
+
+void lvgl_invalidate_area_drop(lv_display_t *display, lv_area_t *area)
+{
+  if (display->inv_p > 0)
+  {
+    *area = display->inv_areas[0];
+    return;
+  }
+
+  *area = (lv_area_t){0};
+  invalidate_placeholder = true;
+}
+
+// Called for the invalidated areas that are displayed
+void lvgl_invalidate_area_keep(lv_display_t *display, const lv_area_t *area)
+{
+  if (!invalidate_placeholder)
+    return;
+
+  // Replace the placeholder, LVGL does not add the area again
+  if (display->inv_p == 1)
+    display->inv_areas[0] = *area;
+
+  invalidate_placeholder = false;
+}
+
+void lvgl_invalidate_refr_start(lv_event_t *event)
+{
+  // Only the placeholder is invalidated
+  if (invalidate_placeholder && display->inv_p == 1)
+    display->inv_p = 0;
+
+  invalidate_placeholder = false;
+}
+#endif
+
 #ifdef BOARD_HAS_TOUCH
 // See: https://www.maximintegrated.com/en/design/technical-documents/app-notes/5/5296.html
 void lvgl_touch_calibration_transform(lv_indev_t *indev, lv_indev_data_t *data)
 {
-  log_v("indev:0x%08x, data:0x%08x", indev, data);
-
   // Call low level read from the driver
+#ifdef SMARTDISPLAY_TIMELINE
+  smartdisplay_timeline_begin("touch read");
+#endif
   driver_touch_read_cb(indev, data);
+#ifdef SMARTDISPLAY_TIMELINE
+  smartdisplay_timeline_end("touch read");
+#endif
   // Check if transformation is required
   if (touch_calibration_data.valid && data->state == LV_INDEV_STATE_PRESSED)
   {
-    log_d("lvgl_touch_calibration_transform: transformation applied");
     lv_point_t pt = {
         .x = roundf(data->point.x * touch_calibration_data.alphaX + data->point.y * touch_calibration_data.betaX + touch_calibration_data.deltaX),
         .y = roundf(data->point.x * touch_calibration_data.alphaY + data->point.y * touch_calibration_data.betaY + touch_calibration_data.deltaY)};
-    log_d("Calibrate point (%d, %d) => (%d, %d)", data->point.x, data->point.y, pt.x, pt.y);
+    smartdisplay_trace_d(SMARTDISPLAY_TRACE_TOUCH_CALIBRATE, data->point.x, data->point.y, pt.x, pt.y);
     data->point = (lv_point_t){pt.x, pt.y};
   }
+#ifdef SMARTDISPLAY_DRS
+  // Points of the screen drawn at half size
+  lvgl_drs_touch(data);
+#endif
 }
 
 touch_calibration_data_t smartdisplay_compute_touch_calibration(const lv_point_t screen[3], const lv_point_t touch[3])
@@ -157,6 +254,10 @@ touch_calibration_data_t smartdisplay_compute_touch_calibration(const lv_point_t
 void smartdisplay_init()
 {
   log_d("smartdisplay_init");
+#if SMARTDISPLAY_TRACE_LEVEL > ARDUHAL_LOG_LEVEL_NONE
+  // Format the hot path traces in a low priority task
+  lvgl_trace_init();
+#endif
 #ifdef BOARD_HAS_RGB_LED
   // Setup RGB LED.  High is off
   pinMode(RGB_LED_R, OUTPUT);
@@ -182,6 +283,10 @@ void smartdisplay_init()
 #endif
 
   lv_init();
+#ifdef SMARTDISPLAY_PSRAM_CACHE
+  // Decoded images and glyph bitmaps in PSRAM
+  lvgl_cache_init();
+#endif
   // Setup backlight
   pinMode(DISPLAY_BCKL, OUTPUT);
   digitalWrite(DISPLAY_BCKL, LOW);
@@ -193,12 +298,75 @@ void smartdisplay_init()
 #endif
   // Setup TFT display
   display = lvgl_lcd_init();
+#if defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR)
+  // Frame timing, underrun counters and restarts of the RGB panel
+  lvgl_rgb_bounce_init(display);
+#endif
+#ifdef SMARTDISPLAY_RGB_VSYNC
+  // Render in the frame buffers and flip them at the vsync
+  lvgl_rgb_vsync_init(display);
+#endif
+#ifdef SMARTDISPLAY_RGB_DMA_COPY
+  // Copy the rendered areas into the frame buffer with the GDMA
+  lvgl_rgb_dma_init(display);
+#endif
+#ifdef SMARTDISPLAY_DRS
+  // Render at half resolution during heavy animations
+  lvgl_drs_init(display);
+#endif
+#ifdef SMARTDISPLAY_TE_GPIO
+  // Pace the frames with the tearing effect output of the panel
+  lvgl_te_init(display);
+#endif
+#ifdef SMARTDISPLAY_RENDER_L8
+  // Render 8 bit luminance, expanded by a lookup table
+  lvgl_l8_init(display);
+#endif
+#ifdef SMARTDISPLAY_VSCROLL
+  // Move scrolled content with the scroll start address of the panel
+  lvgl_vscroll_init(display);
+#endif
+#ifdef SMARTDISPLAY_PARTIAL
+  // Partial display area, idle mode and the flushed bytes per mode
+  lvgl_partial_init(display);
+#endif
+#ifdef SMARTDISPLAY_SPI_BOUNCE
+  // Internal DMA buffers to send the areas rendered in PSRAM, also while tuning the draw buffer
+  lvgl_spi_bounce_init(display);
+#endif
+#ifdef SMARTDISPLAY_BUFFER_TUNE
+  // Replace the default draw buffer by the fastest one within the budget
+  lvgl_draw_buffer_tune(display);
+#endif
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+  // Copy of the panel memory to send only the changed pixels
+  lvgl_shadow_init(display);
+#endif
+#ifdef SMARTDISPLAY_ROUND_MASK
+  // Do not send (and optionally render) the pixels outside the circle
+  lvgl_round_init(display);
+#endif
+#if defined(SMARTDISPLAY_ROUND_MASK_RENDER) || defined(SMARTDISPLAY_PARTIAL)
+  // Remove the placeholder of the invalidated areas that are not displayed
+  lv_display_add_event_cb(display, lvgl_invalidate_refr_start, LV_EVENT_REFR_START, NULL);
+#endif
+#ifdef SMARTDISPLAY_HEATMAP
+  // Flushes per tile and flushes of unchanged pixels
+  lvgl_heatmap_init(display);
+#endif
+  // Additional LVGL heap pools after the draw buffer is allocated
+  lvgl_heap_init();
 
 #ifndef DISPLAY_SOFTWARE_ROTATION
   // Register callback for hardware rotation
   lv_display_add_event_cb(display, lvgl_display_resolution_changed_callback, LV_EVENT_RESOLUTION_CHANGED, NULL);
 #endif
 
+#if defined(SMARTDISPLAY_REFR_PERIOD_MIN) && defined(SMARTDISPLAY_REFR_PERIOD_MAX)
+  // Dynamic refresh rate
+  smartdisplay_refresh_set_bounds(SMARTDISPLAY_REFR_PERIOD_MIN, SMARTDISPLAY_REFR_PERIOD_MAX);
+#endif
+
   //  Clear screen
   lv_obj_clean(lv_scr_act());
   // Turn backlight on (50%)
@@ -0,0 +1,390 @@
+#include <esp32_smartdisplay_assets.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include <esp32-hal-log.h>
+#include <esp_idf_version.h>
+#include <esp_partition.h>
+#else
+// Linux: map the bundle file
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define log_v(format, ...) LV_LOG_TRACE(format, ##__VA_ARGS__)
+#define log_d(format, ...) LV_LOG_INFO(format, ##__VA_ARGS__)
+#define log_w(format, ...) LV_LOG_WARN(format, ##__VA_ARGS__)
+#define log_e(format, ...) LV_LOG_ERROR(format, ##__VA_ARGS__)
+#endif
+
+#if LV_FONT_FMT_TXT_LARGE
+#error "Asset bundle fonts require LV_FONT_FMT_TXT_LARGE 0"
+#endif
+
+const uint8_t *assets_base;
+const smartdisplay_assets_header_t *assets_header;
+const smartdisplay_assets_entry_t *assets_index;
+// Image and font descriptors created on first use, one per index entry
+void **assets_sources;
+
+#ifdef ESP_PLATFORM
+#if ESP_IDF_VERSION_MAJOR >= 5
+esp_partition_mmap_handle_t assets_mmap_handle;
+#else
+spi_flash_mmap_handle_t assets_mmap_handle;
+#endif
+#else
+size_t assets_mmap_size;
+#endif
+
+bool assets_map(const char *name, smartdisplay_assets_header_t *header)
+{
+#ifdef ESP_PLATFORM
+  const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, name);
+  if (partition == NULL)
+  {
+    log_e("Partition %s not found", name);
+    return false;
+  }
+
+  if (esp_partition_read(partition, 0, header, sizeof(smartdisplay_assets_header_t)) != ESP_OK || header->size > partition->size)
+    return false;
+
+  // Map only the bundle, not the complete partition
+#if ESP_IDF_VERSION_MAJOR >= 5
+  return esp_partition_mmap(partition, 0, header->size, ESP_PARTITION_MMAP_DATA, (const void **)&assets_base, &assets_mmap_handle) == ESP_OK;
+#else
+  return esp_partition_mmap(partition, 0, header->size, SPI_FLASH_MMAP_DATA, (const void **)&assets_base, &assets_mmap_handle) == ESP_OK;
+#endif
+#else
+  const int fd = open(name, O_RDONLY);
+  if (fd < 0)
+  {
+    log_e("Unable to open %s", name);
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(smartdisplay_assets_header_t))
+  {
+    close(fd);
+    return false;
+  }
+
+  assets_mmap_size = st.st_size;
+  void *base = mmap(NULL, assets_mmap_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return false;
+
+  assets_base = base;
+  memcpy(header, assets_base, sizeof(smartdisplay_assets_header_t));
+  return header->size <= assets_mmap_size;
+#endif
+}
+
+void assets_unmap()
+{
+#ifdef ESP_PLATFORM
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_partition_munmap(assets_mmap_handle);
+#else
+  spi_flash_munmap(assets_mmap_handle);
+#endif
+#else
+  munmap((void *)assets_base, assets_mmap_size);
+#endif
+  assets_base = NULL;
+}
+
+// True if count elements of element_size at offset are within size bytes and aligned
+bool assets_range_valid(uint32_t offset, uint32_t count, uint32_t element_size, uint32_t size, uint32_t alignment)
+{
+  return offset <= size && offset % alignment == 0 && (uint64_t)count * element_size <= size - offset;
+}
+
+bool assets_image_valid(const uint8_t *data, uint32_t size)
+{
+  if (size < sizeof(smartdisplay_assets_image_t))
+    return false;
+
+  const smartdisplay_assets_image_t *image = (const smartdisplay_assets_image_t *)data;
+  const uint8_t bpp = lv_color_format_get_bpp(image->cf);
+  return bpp > 0 && image->stride >= ((uint32_t)image->w * bpp + 7) / 8 && (uint64_t)image->stride * image->h <= size - sizeof(smartdisplay_assets_image_t);
+}
+
+bool assets_font_valid(const uint8_t *data, uint32_t size)
+{
+  if (size < sizeof(smartdisplay_assets_font_t))
+    return false;
+
+  const smartdisplay_assets_font_t *font = (const smartdisplay_assets_font_t *)data;
+  if ((font->bpp != 1 && font->bpp != 2 && font->bpp != 4 && font->bpp != 8) || !assets_range_valid(font->cmaps_offset, font->cmap_num, sizeof(smartdisplay_assets_cmap_t), size, 4) || !assets_range_valid(font->glyph_dsc_offset, font->glyph_count, sizeof(lv_font_fmt_txt_glyph_dsc_t), size, 4) || font->glyph_bitmap_offset > size)
+    return false;
+
+  const smartdisplay_assets_cmap_t *cmaps = (const smartdisplay_assets_cmap_t *)(data + font->cmaps_offset);
+  for (uint16_t c = 0; c < font->cmap_num; c++)
+  {
+    const smartdisplay_assets_cmap_t *cmap = &cmaps[c];
+    // Highest glyph id the character map can refer to
+    uint32_t glyph_id_max;
+    switch (cmap->type)
+    {
+    case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+      glyph_id_max = cmap->glyph_id_start + cmap->range_length;
+      break;
+    case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+    {
+      if (cmap->glyph_id_ofs_list_offset == 0 || !assets_range_valid(cmap->glyph_id_ofs_list_offset, cmap->range_length, sizeof(uint8_t), size, 1))
+        return false;
+
+      const uint8_t *ofs_list = data + cmap->glyph_id_ofs_list_offset;
+      glyph_id_max = 0;
+      for (uint16_t i = 0; i < cmap->range_length; i++)
+        glyph_id_max = LV_MAX(glyph_id_max, cmap->glyph_id_start + ofs_list[i] + 1);
+      break;
+    }
+    case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+      if (cmap->unicode_list_offset == 0 || !assets_range_valid(cmap->unicode_list_offset, cmap->list_length, sizeof(uint16_t), size, 2))
+        return false;
+
+      glyph_id_max = cmap->glyph_id_start + cmap->list_length;
+      break;
+    case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
+    {
+      if (cmap->unicode_list_offset == 0 || cmap->glyph_id_ofs_list_offset == 0 || !assets_range_valid(cmap->unicode_list_offset, cmap->list_length, sizeof(uint16_t), size, 2) || !assets_range_valid(cmap->glyph_id_ofs_list_offset, cmap->list_length, sizeof(uint16_t), size, 2))
+        return false;
+
+      const uint16_t *ofs_list = (const uint16_t *)(data + cmap->glyph_id_ofs_list_offset);
+      glyph_id_max = 0;
+      for (uint16_t i = 0; i < cmap->list_length; i++)
+        glyph_id_max = LV_MAX(glyph_id_max, cmap->glyph_id_start + ofs_list[i] + 1);
+      break;
+    }
+    default:
+      return false;
+    }
+
+    if (glyph_id_max > font->glyph_count)
+      return false;
+  }
+
+  // The bitmaps of all glyphs must be within the font data
+  const lv_font_fmt_txt_glyph_dsc_t *glyph_dsc = (const lv_font_fmt_txt_glyph_dsc_t *)(data + font->glyph_dsc_offset);
+  for (uint32_t g = 0; g < font->glyph_count; g++)
+    if (glyph_dsc[g].bitmap_index + ((uint32_t)glyph_dsc[g].box_w * glyph_dsc[g].box_h * font->bpp + 7) / 8 > size - font->glyph_bitmap_offset)
+      return false;
+
+  return true;
+}
+
+// Check all the offsets and sizes in the bundle, so a corrupt bundle is rejected when opened and not when drawn
+bool assets_valid(const uint8_t *base, const smartdisplay_assets_header_t *header)
+{
+  if (memcmp(header->magic, SMARTDISPLAY_ASSETS_MAGIC, sizeof(header->magic)) != 0 || header->version != SMARTDISPLAY_ASSETS_VERSION || !assets_range_valid(sizeof(smartdisplay_assets_header_t), header->count, sizeof(smartdisplay_assets_entry_t), header->size, 4))
+  {
+    log_e("Invalid asset bundle: version:%u, count:%u, size:%u", header->version, header->count, header->size);
+    return false;
+  }
+
+  const uint32_t data_offset = sizeof(smartdisplay_assets_header_t) + header->count * sizeof(smartdisplay_assets_entry_t);
+  const smartdisplay_assets_entry_t *index = (const smartdisplay_assets_entry_t *)(base + sizeof(smartdisplay_assets_header_t));
+  for (uint16_t i = 0; i < header->count; i++)
+  {
+    const smartdisplay_assets_entry_t *entry = &index[i];
+    bool valid = entry->offset >= data_offset && assets_range_valid(entry->offset, entry->size, sizeof(uint8_t), header->size, 4);
+    if (valid && entry->type == SMARTDISPLAY_ASSET_IMAGE)
+      valid = assets_image_valid(base + entry->offset, entry->size);
+    else if (valid && entry->type == SMARTDISPLAY_ASSET_FONT)
+      valid = assets_font_valid(base + entry->offset, entry->size);
+    else if (entry->type != SMARTDISPLAY_ASSET_RAW)
+      valid = false;
+
+    if (!valid)
+    {
+      log_e("Invalid asset %.*s: type:%u, offset:%u, size:%u", SMARTDISPLAY_ASSETS_NAME_LENGTH, entry->name, entry->type, entry->offset, entry->size);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool smartdisplay_assets_open(const char *name)
+{
+  log_v("name:%s", name);
+
+  if (assets_base != NULL)
+    smartdisplay_assets_close();
+
+  smartdisplay_assets_header_t header;
+  if (!assets_map(name, &header))
+  {
+    log_e("Unable to map the asset bundle %s", name);
+    if (assets_base != NULL)
+      assets_unmap();
+
+    return false;
+  }
+
+  if (!assets_valid(assets_base, &header))
+  {
+    assets_unmap();
+    return false;
+  }
+
+  assets_header = (const smartdisplay_assets_header_t *)assets_base;
+  assets_index = (const smartdisplay_assets_entry_t *)(assets_base + sizeof(smartdisplay_assets_header_t));
+  assets_sources = lv_malloc_zeroed(header.count * sizeof(void *));
+  log_d("Asset bundle mapped: count:%u, size:%u", header.count, header.size);
+  return true;
+}
+
+void smartdisplay_assets_close()
+{
+  log_v("");
+
+  if (assets_base == NULL)
+    return;
+
+  for (uint16_t i = 0; i < assets_header->count; i++)
+  {
+    if (assets_sources[i] == NULL)
+      continue;
+
+    if (assets_index[i].type == SMARTDISPLAY_ASSET_FONT)
+    {
+      const lv_font_fmt_txt_dsc_t *dsc = ((lv_font_t *)assets_sources[i])->dsc;
+      lv_free((void *)dsc->cmaps);
+      lv_free((void *)dsc);
+    }
+
+    lv_free(assets_sources[i]);
+  }
+
+  lv_free(assets_sources);
+  assets_sources = NULL;
+  assets_header = NULL;
+  assets_index = NULL;
+  assets_unmap();
+}
+
+int32_t assets_find(const char *name, smartdisplay_asset_type_t type)
+{
+  if (assets_base == NULL)
+    return -1;
+
+  for (uint16_t i = 0; i < assets_header->count; i++)
+    if (strncmp(assets_index[i].name, name, SMARTDISPLAY_ASSETS_NAME_LENGTH) == 0)
+      return assets_index[i].type == type ? i : -1;
+
+  return -1;
+}
+
+const void *smartdisplay_assets_get(const char *name, smartdisplay_asset_type_t *type, uint32_t *size)
+{
+  log_v("name:%s", name);
+
+  if (assets_base == NULL)
+    return NULL;
+
+  for (uint16_t i = 0; i < assets_header->count; i++)
+  {
+    const smartdisplay_assets_entry_t *entry = &assets_index[i];
+    if (strncmp(entry->name, name, SMARTDISPLAY_ASSETS_NAME_LENGTH) != 0)
+      continue;
+
+    if (type != NULL)
+      *type = entry->type;
+
+    if (size != NULL)
+      *size = entry->size;
+
+    return assets_base + entry->offset;
+  }
+
+  return NULL;
+}
+
+const lv_image_dsc_t *smartdisplay_assets_get_image(const char *name)
+{
+  log_v("name:%s", name);
+
+  const int32_t i = assets_find(name, SMARTDISPLAY_ASSET_IMAGE);
+  if (i < 0)
+  {
+    log_w("Image %s not found", name);
+    return NULL;
+  }
+
+  if (assets_sources[i] == NULL)
+  {
+    const smartdisplay_assets_entry_t *entry = &assets_index[i];
+    const smartdisplay_assets_image_t *image = (const smartdisplay_assets_image_t *)(assets_base + entry->offset);
+    lv_image_dsc_t *dsc = lv_malloc_zeroed(sizeof(lv_image_dsc_t));
+    dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    dsc->header.cf = image->cf;
+    dsc->header.flags = image->flags;
+    dsc->header.w = image->w;
+    dsc->header.h = image->h;
+    dsc->header.stride = image->stride;
+    // Pixels are used directly from the mapped bundle
+    dsc->data = (const uint8_t *)(image + 1);
+    dsc->data_size = entry->size - sizeof(smartdisplay_assets_image_t);
+    assets_sources[i] = dsc;
+  }
+
+  return assets_sources[i];
+}
+
+const lv_font_t *smartdisplay_assets_get_font(const char *name)
+{
+  log_v("name:%s", name);
+
+  const int32_t i = assets_find(name, SMARTDISPLAY_ASSET_FONT);
+  if (i < 0)
+  {
+    log_w("Font %s not found", name);
+    return NULL;
+  }
+
+  if (assets_sources[i] == NULL)
+  {
+    const uint8_t *data = assets_base + assets_index[i].offset;
+    const smartdisplay_assets_font_t *font_data = (const smartdisplay_assets_font_t *)data;
+    const smartdisplay_assets_cmap_t *cmaps_data = (const smartdisplay_assets_cmap_t *)(data + font_data->cmaps_offset);
+    // Only the character maps contain pointers and are created in RAM. Glyph descriptions and bitmaps are used from the bundle
+    lv_font_fmt_txt_cmap_t *cmaps = lv_malloc_zeroed(font_data->cmap_num * sizeof(lv_font_fmt_txt_cmap_t));
+    for (uint16_t c = 0; c < font_data->cmap_num; c++)
+    {
+      cmaps[c].range_start = cmaps_data[c].range_start;
+      cmaps[c].range_length = cmaps_data[c].range_length;
+      cmaps[c].glyph_id_start = cmaps_data[c].glyph_id_start;
+      cmaps[c].list_length = cmaps_data[c].list_length;
+      cmaps[c].type = cmaps_data[c].type;
+      cmaps[c].unicode_list = cmaps_data[c].unicode_list_offset ? (const uint16_t *)(data + cmaps_data[c].unicode_list_offset) : NULL;
+      cmaps[c].glyph_id_ofs_list = cmaps_data[c].glyph_id_ofs_list_offset ? data + cmaps_data[c].glyph_id_ofs_list_offset : NULL;
+    }
+
+    lv_font_fmt_txt_dsc_t *dsc = lv_malloc_zeroed(sizeof(lv_font_fmt_txt_dsc_t));
+    dsc->glyph_bitmap = data + font_data->glyph_bitmap_offset;
+    dsc->glyph_dsc = (const lv_font_fmt_txt_glyph_dsc_t *)(data + font_data->glyph_dsc_offset);
+    dsc->cmaps = cmaps;
+    dsc->cmap_num = font_data->cmap_num;
+    dsc->bpp = font_data->bpp;
+    dsc->bitmap_format = LV_FONT_FMT_TXT_PLAIN;
+
+    lv_font_t *font = lv_malloc_zeroed(sizeof(lv_font_t));
+    font->get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+    font->get_glyph_bitmap = lv_font_get_bitmap_fmt_txt;
+    font->line_height = font_data->line_height;
+    font->base_line = font_data->base_line;
+    font->subpx = font_data->subpx;
+    font->underline_position = font_data->underline_position;
+    font->underline_thickness = font_data->underline_thickness;
+    font->dsc = dsc;
+    assets_sources[i] = font;
+  }
+
+  return assets_sources[i];
+}
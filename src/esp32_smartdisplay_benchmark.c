@@ -0,0 +1,198 @@
+#include <esp32_smartdisplay.h>
+#include <esp_timer.h>
+
+// Lines of text in the scroll and text scenes
+#define BENCHMARK_LINES 40
+#define BENCHMARK_ARCS 3
+// Duration of one cycle of the scene animations [ms]
+#define BENCHMARK_ANIM_TIME 1000
+
+extern lv_display_t *display;
+
+const char *const benchmark_scene_names[SMARTDISPLAY_BENCHMARK_SCENES] = {"scroll", "arcs", "fade", "text"};
+
+// Measurements of the running benchmark
+uint32_t benchmark_frames;
+uint32_t benchmark_scaled_frames;
+uint64_t benchmark_pixels;
+int64_t benchmark_render_start, benchmark_render_time;
+int64_t benchmark_flush_start, benchmark_flush_time;
+int64_t benchmark_wait_start, benchmark_wait_time;
+
+void benchmark_display_event(lv_event_t *event)
+{
+  const int64_t now = esp_timer_get_time();
+  switch (lv_event_get_code(event))
+  {
+  case LV_EVENT_RENDER_START:
+    benchmark_render_start = now;
+    break;
+  case LV_EVENT_RENDER_READY:
+  {
+    benchmark_render_time += now - benchmark_render_start;
+    benchmark_frames++;
+    // Screen drawn at half size by the dynamic resolution scaling
+    smartdisplay_drs_stats_t drs_stats;
+    smartdisplay_drs_get_stats(&drs_stats);
+    if (drs_stats.scaled)
+      benchmark_scaled_frames++;
+    break;
+  }
+  case LV_EVENT_FLUSH_START:
+    benchmark_pixels += lv_area_get_size(lv_event_get_param(event));
+    benchmark_flush_start = now;
+    break;
+  case LV_EVENT_FLUSH_FINISH:
+    benchmark_flush_time += now - benchmark_flush_start;
+    break;
+  case LV_EVENT_FLUSH_WAIT_START:
+    benchmark_wait_start = now;
+    break;
+  case LV_EVENT_FLUSH_WAIT_FINISH:
+    benchmark_wait_time += now - benchmark_wait_start;
+    break;
+  default:
+    break;
+  }
+}
+
+void benchmark_scroll_anim(void *obj, int32_t value)
+{
+  lv_obj_scroll_to_y(obj, value, LV_ANIM_OFF);
+}
+
+void benchmark_arc_anim(void *obj, int32_t value)
+{
+  lv_arc_set_value(obj, value);
+}
+
+void benchmark_fade_anim(void *obj, int32_t value)
+{
+  lv_obj_set_style_bg_opa(obj, value, LV_PART_MAIN);
+}
+
+void benchmark_text_anim(void *obj, int32_t value)
+{
+  for (uint32_t i = 0; i < lv_obj_get_child_count(obj); i++)
+    lv_label_set_text_fmt(lv_obj_get_child(obj, i), "Line %u: %d %d %d", i, value, value * 7 % 1000, value * 13 % 10000);
+}
+
+void benchmark_start_anim(void *obj, lv_anim_exec_xcb_t exec, int32_t start, int32_t end)
+{
+  lv_anim_t anim;
+  lv_anim_init(&anim);
+  lv_anim_set_var(&anim, obj);
+  lv_anim_set_exec_cb(&anim, exec);
+  lv_anim_set_values(&anim, start, end);
+  lv_anim_set_duration(&anim, BENCHMARK_ANIM_TIME);
+  lv_anim_set_playback_duration(&anim, BENCHMARK_ANIM_TIME);
+  lv_anim_set_repeat_count(&anim, LV_ANIM_REPEAT_INFINITE);
+  lv_anim_start(&anim);
+}
+
+lv_obj_t *benchmark_create_lines(lv_obj_t *screen)
+{
+  lv_obj_t *container = lv_obj_create(screen);
+  lv_obj_set_size(container, LV_PCT(100), LV_PCT(100));
+  lv_obj_set_flex_flow(container, LV_FLEX_FLOW_COLUMN);
+  for (uint32_t i = 0; i < BENCHMARK_LINES; i++)
+    lv_label_set_text_fmt(lv_label_create(container), "Line %u: The quick brown fox jumps over the lazy dog", i);
+
+  return container;
+}
+
+void benchmark_create_scene(lv_obj_t *screen, smartdisplay_benchmark_scene_t scene)
+{
+  switch (scene)
+  {
+  case SMARTDISPLAY_BENCHMARK_SCROLL:
+  {
+    lv_obj_t *container = benchmark_create_lines(screen);
+    lv_obj_update_layout(container);
+    benchmark_start_anim(container, benchmark_scroll_anim, 0, lv_obj_get_scroll_bottom(container));
+    break;
+  }
+  case SMARTDISPLAY_BENCHMARK_ARCS:
+  {
+    const int32_t size = LV_MIN(lv_display_get_horizontal_resolution(display), lv_display_get_vertical_resolution(display));
+    for (uint8_t i = 0; i < BENCHMARK_ARCS; i++)
+    {
+      lv_obj_t *arc = lv_arc_create(screen);
+      lv_obj_set_size(arc, size * (BENCHMARK_ARCS - i) / BENCHMARK_ARCS, size * (BENCHMARK_ARCS - i) / BENCHMARK_ARCS);
+      lv_obj_center(arc);
+      lv_obj_remove_flag(arc, LV_OBJ_FLAG_CLICKABLE);
+      benchmark_start_anim(arc, benchmark_arc_anim, 0, 100);
+    }
+    break;
+  }
+  case SMARTDISPLAY_BENCHMARK_FADE:
+  {
+    lv_obj_t *panel = lv_obj_create(screen);
+    lv_obj_set_size(panel, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_bg_color(panel, lv_palette_main(LV_PALETTE_BLUE), LV_PART_MAIN);
+    benchmark_start_anim(panel, benchmark_fade_anim, LV_OPA_TRANSP, LV_OPA_COVER);
+    break;
+  }
+  case SMARTDISPLAY_BENCHMARK_TEXT:
+    benchmark_start_anim(benchmark_create_lines(screen), benchmark_text_anim, 0, 1000);
+    break;
+  default:
+    break;
+  }
+}
+
+void smartdisplay_benchmark_run(smartdisplay_benchmark_scene_t scene, uint32_t duration, smartdisplay_benchmark_result_t *result)
+{
+  log_v("scene:%d, duration:%u, result:0x%08x", scene, duration, result);
+
+  lv_obj_t *previous_screen = lv_screen_active();
+  lv_obj_t *screen = lv_obj_create(NULL);
+  benchmark_create_scene(screen, scene);
+  lv_screen_load(screen);
+  // Render the first frame before measuring
+  lv_refr_now(display);
+
+  benchmark_frames = benchmark_scaled_frames = 0;
+  benchmark_pixels = 0;
+  benchmark_render_time = benchmark_flush_time = benchmark_wait_time = 0;
+  lv_display_add_event_cb(display, benchmark_display_event, LV_EVENT_ALL, NULL);
+  // Render as fast as possible
+  const uint32_t refr_period = display->refr_timer->period;
+  lv_timer_set_period(display->refr_timer, 1);
+
+  const int64_t start = esp_timer_get_time();
+  uint32_t last_tick = millis();
+  while (esp_timer_get_time() - start < (int64_t)duration * 1000)
+  {
+    const uint32_t now = millis();
+    lv_tick_inc(now - last_tick);
+    last_tick = now;
+    lv_timer_handler();
+  }
+
+  const float elapsed_ms = (esp_timer_get_time() - start) / 1000.0f;
+  lv_timer_set_period(display->refr_timer, refr_period);
+  lv_display_remove_event_cb_with_user_data(display, benchmark_display_event, NULL);
+  lv_screen_load(previous_screen);
+  // Deletes the animations of the scene
+  lv_obj_delete(screen);
+
+  const uint32_t frames = LV_MAX(benchmark_frames, 1);
+  *result = (smartdisplay_benchmark_result_t){
+      .scene = scene,
+      .frames = benchmark_frames,
+      .fps = benchmark_frames * 1000.0f / elapsed_ms,
+      // Render time without flushing and waiting for the transfer
+      .render_ms = (benchmark_render_time - benchmark_flush_time - benchmark_wait_time) / 1000.0f / frames,
+      .flush_ms = benchmark_flush_time / 1000.0f / frames,
+      .wait_ms = benchmark_wait_time / 1000.0f / frames,
+      .bus_pct = (benchmark_flush_time + benchmark_wait_time) / 10.0f / elapsed_ms,
+      .pixels_per_frame = benchmark_pixels / frames,
+      .scaled_pct = benchmark_scaled_frames * 100.0f / frames};
+}
+
+void smartdisplay_benchmark_print(const smartdisplay_benchmark_result_t *result)
+{
+  // CSV format for tools/smartdisplay_benchmark.py: scene,fps,render_ms,bus_pct,flush_ms,wait_ms,pixels_per_frame,scaled_pct
+  log_printf("benchmark,%s,%.1f,%.2f,%.1f,%.2f,%.2f,%u,%.1f\n", benchmark_scene_names[result->scene], result->fps, result->render_ms, result->bus_pct, result->flush_ms, result->wait_ms, result->pixels_per_frame, result->scaled_pct);
+}
@@ -0,0 +1,199 @@
+#include <esp32_smartdisplay.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <nvs.h>
+
+#define DRAW_BUFFER_NVS_NAMESPACE "smartdisplay"
+#define DRAW_BUFFER_NVS_KEY "draw_buffer"
+// Internal memory to leave available for WiFi, tasks etc.
+#define DRAW_BUFFER_INTERNAL_RESERVE (48 * 1024)
+// Maximum time for flushing the whole screen with one candidate
+#define DRAW_BUFFER_FLUSH_TIMEOUT_US 1000000
+// Throughput difference [%] to the fastest candidate that is considered to be equal. The smallest of these buffers is used
+#define DRAW_BUFFER_THROUGHPUT_MARGIN 3
+
+#ifndef SMARTDISPLAY_BUFFER_TUNE_BUDGET
+// Maximum size of the draw buffer [bytes]
+#define SMARTDISPLAY_BUFFER_TUNE_BUDGET (DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(lv_color_t) / 4)
+#endif
+
+typedef struct
+{
+  uint32_t height;
+  uint32_t caps;
+  uint32_t throughput;
+} draw_buffer_candidate_t;
+
+typedef struct
+{
+  uint32_t signature;
+  uint32_t pixels;
+  uint32_t caps;
+  uint32_t throughput;
+} draw_buffer_nvs_t;
+
+// Candidate stripe heights as fraction (1/n) of the display height
+const uint8_t draw_buffer_height_divisors[] = {20, 10, 8, 5, 4, 3, 2};
+const uint32_t draw_buffer_caps[] = {MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA, MALLOC_CAP_SPIRAM};
+
+smartdisplay_draw_buffer_info_t draw_buffer_info;
+
+// Changes in the board or budget invalidate the stored result
+uint32_t draw_buffer_signature()
+{
+  return (DISPLAY_WIDTH << 20) ^ (DISPLAY_HEIGHT << 8) ^ SMARTDISPLAY_BUFFER_TUNE_BUDGET;
+}
+
+// Flush the whole screen in stripes and return the throughput in pixels/s. 0 on timeout
+uint32_t draw_buffer_measure(lv_display_t *display, uint8_t *buffer, uint32_t stripe_height)
+{
+  const int32_t width = lv_display_get_horizontal_resolution(display);
+  const int32_t height = lv_display_get_vertical_resolution(display);
+  const int64_t start = esp_timer_get_time();
+  for (int32_t y = 0; y < height; y += stripe_height)
+  {
+    const lv_area_t area = {.x1 = 0, .y1 = y, .x2 = width - 1, .y2 = LV_MIN(y + stripe_height, height) - 1};
+    display->flushing = 1;
+    display->flush_cb(display, &area, buffer);
+    // Wait until the flush ready callback of the driver
+    while (display->flushing)
+    {
+      if (esp_timer_get_time() - start > DRAW_BUFFER_FLUSH_TIMEOUT_US)
+      {
+        log_w("Flush timeout");
+        display->flushing = 0;
+        return 0;
+      }
+
+      taskYIELD();
+    }
+  }
+
+  return (uint64_t)width * height * 1000000 / (esp_timer_get_time() - start);
+}
+
+bool draw_buffer_load(lv_display_t *display, uint32_t px_size)
+{
+  nvs_handle_t handle;
+  if (nvs_open(DRAW_BUFFER_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    return false;
+
+  draw_buffer_nvs_t stored;
+  size_t length = sizeof(stored);
+  const esp_err_t res = nvs_get_blob(handle, DRAW_BUFFER_NVS_KEY, &stored, &length);
+  nvs_close(handle);
+  if (res != ESP_OK || length != sizeof(stored) || stored.signature != draw_buffer_signature())
+    return false;
+
+  void *buffer = heap_caps_malloc(stored.pixels * px_size, stored.caps);
+  if (buffer == NULL)
+  {
+    log_w("Unable to allocate stored draw buffer: pixels:%u, caps:0x%08x", stored.pixels, stored.caps);
+    return false;
+  }
+
+  heap_caps_free(display->buf_1->data);
+  lv_display_set_buffers(display, buffer, NULL, stored.pixels * px_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+  draw_buffer_info = (smartdisplay_draw_buffer_info_t){.pixels = stored.pixels, .caps = stored.caps, .throughput = stored.throughput, .from_nvs = true};
+  return true;
+}
+
+void draw_buffer_store()
+{
+  nvs_handle_t handle;
+  if (nvs_open(DRAW_BUFFER_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+  {
+    log_w("Unable to open NVS");
+    return;
+  }
+
+  const draw_buffer_nvs_t stored = {.signature = draw_buffer_signature(), .pixels = draw_buffer_info.pixels, .caps = draw_buffer_info.caps, .throughput = draw_buffer_info.throughput};
+  if (nvs_set_blob(handle, DRAW_BUFFER_NVS_KEY, &stored, sizeof(stored)) != ESP_OK || nvs_commit(handle) != ESP_OK)
+    log_w("Unable to store the draw buffer settings");
+
+  nvs_close(handle);
+}
+
+void lvgl_draw_buffer_tune(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(display));
+  if (draw_buffer_load(display, px_size))
+  {
+    log_i("Draw buffer from NVS: pixels:%u, caps:0x%08x, throughput:%u px/s", draw_buffer_info.pixels, draw_buffer_info.caps, draw_buffer_info.throughput);
+    return;
+  }
+
+  // Release the default buffer so it does not count against the available memory. No rendering is done until the new buffer is set
+  heap_caps_free(display->buf_1->data);
+
+  const int32_t width = lv_display_get_horizontal_resolution(display);
+  const int32_t height = lv_display_get_vertical_resolution(display);
+  draw_buffer_candidate_t candidates[sizeof(draw_buffer_caps) / sizeof(draw_buffer_caps[0]) * sizeof(draw_buffer_height_divisors)];
+  uint8_t candidate_count = 0;
+  uint32_t max_throughput = 0;
+  for (uint8_t c = 0; c < sizeof(draw_buffer_caps) / sizeof(draw_buffer_caps[0]); c++)
+  {
+    const uint32_t caps = draw_buffer_caps[c];
+    for (uint8_t d = 0; d < sizeof(draw_buffer_height_divisors) / sizeof(draw_buffer_height_divisors[0]); d++)
+    {
+      const uint32_t stripe_height = LV_MAX(height / draw_buffer_height_divisors[d], 1);
+      const uint32_t size = width * stripe_height * px_size;
+      if (size > SMARTDISPLAY_BUFFER_TUNE_BUDGET)
+        break;
+
+      if ((caps & MALLOC_CAP_INTERNAL) && heap_caps_get_largest_free_block(caps) < size + DRAW_BUFFER_INTERNAL_RESERVE)
+        break;
+
+      uint8_t *buffer = heap_caps_malloc(size, caps);
+      if (buffer == NULL)
+        break;
+
+      memset(buffer, 0, size);
+      const uint32_t throughput = draw_buffer_measure(display, buffer, stripe_height);
+      heap_caps_free(buffer);
+      log_d("Draw buffer: lines:%u, bytes:%u, caps:0x%08x, throughput:%u px/s", stripe_height, size, caps, throughput);
+      if (throughput == 0)
+        continue;
+
+      candidates[candidate_count++] = (draw_buffer_candidate_t){.height = stripe_height, .caps = caps, .throughput = throughput};
+      max_throughput = LV_MAX(max_throughput, throughput);
+    }
+  }
+
+  // Smallest buffer within the margin of the fastest. Internal memory is preferred for equal sizes
+  const draw_buffer_candidate_t *best = NULL;
+  for (uint8_t i = 0; i < candidate_count; i++)
+    if ((uint64_t)candidates[i].throughput * (100 + DRAW_BUFFER_THROUGHPUT_MARGIN) >= (uint64_t)max_throughput * 100 && (best == NULL || candidates[i].height < best->height))
+      best = &candidates[i];
+
+  void *buffer = NULL;
+  if (best != NULL)
+  {
+    draw_buffer_info = (smartdisplay_draw_buffer_info_t){.pixels = width * best->height, .caps = best->caps, .throughput = best->throughput, .from_nvs = false};
+    buffer = heap_caps_malloc(draw_buffer_info.pixels * px_size, best->caps);
+    if (buffer == NULL)
+      log_w("Unable to allocate the tuned draw buffer: pixels:%u, caps:0x%08x", draw_buffer_info.pixels, draw_buffer_info.caps);
+  }
+
+  if (buffer == NULL)
+  {
+    // Fall back to the board default
+    log_w("Draw buffer tuning failed, using the default");
+    draw_buffer_info = (smartdisplay_draw_buffer_info_t){.pixels = LVGL_BUFFER_PIXELS, .caps = LVGL_BUFFER_MALLOC_FLAGS};
+    buffer = heap_caps_malloc(LVGL_BUFFER_PIXELS * px_size, LVGL_BUFFER_MALLOC_FLAGS);
+    assert(buffer != NULL);
+    lv_display_set_buffers(display, buffer, NULL, LVGL_BUFFER_PIXELS * px_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    return;
+  }
+
+  lv_display_set_buffers(display, buffer, NULL, draw_buffer_info.pixels * px_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+  log_i("Draw buffer tuned: pixels:%u, caps:0x%08x, throughput:%u px/s", draw_buffer_info.pixels, draw_buffer_info.caps, draw_buffer_info.throughput);
+  draw_buffer_store();
+}
+
+void smartdisplay_draw_buffer_get_info(smartdisplay_draw_buffer_info_t *info)
+{
+  *info = draw_buffer_info;
+}
@@ -0,0 +1,233 @@
+#include <esp32_smartdisplay.h>
+#include <esp_heap_caps.h>
+#include <core/lv_global.h>
+#include <misc/cache/lv_cache_private.h>
+
+// Share of the cache budget for the decoded images. The remainder is used for glyph bitmaps
+#define CACHE_IMAGE_SHARE 0.75f
+// Number of image headers to cache
+#define CACHE_IMAGE_HEADER_COUNT 32
+#define CACHE_GLYPH_BUCKETS 256
+
+typedef struct cache_glyph_t
+{
+  const lv_font_t *font;
+  uint32_t index;
+  struct cache_glyph_t *bucket_next;
+  // Least recently used list
+  struct cache_glyph_t *lru_prev;
+  struct cache_glyph_t *lru_next;
+  lv_draw_buf_t draw_buf;
+  // Followed by the bitmap
+} cache_glyph_t;
+
+smartdisplay_cache_stats_t cache_image_stats;
+smartdisplay_cache_stats_t cache_glyph_stats;
+
+// Class of the LVGL image cache with counting callbacks
+lv_cache_class_t cache_image_class;
+const lv_cache_class_t *cache_image_original_class;
+
+cache_glyph_t *cache_glyph_buckets[CACHE_GLYPH_BUCKETS];
+cache_glyph_t *cache_glyph_lru_head;
+cache_glyph_t *cache_glyph_lru_tail;
+
+void *cache_image_buf_malloc(size_t size, lv_color_format_t color_format)
+{
+  // Space for the alignment by the draw buffer
+  return heap_caps_malloc(size + LV_DRAW_BUF_ALIGN - 1, MALLOC_CAP_SPIRAM);
+}
+
+void cache_image_buf_free(void *buf)
+{
+  heap_caps_free(buf);
+}
+
+lv_cache_entry_t *cache_image_get(lv_cache_t *cache, const void *key, void *user_data)
+{
+  lv_cache_entry_t *entry = cache_image_original_class->get_cb(cache, key, user_data);
+  if (entry != NULL)
+    cache_image_stats.hits++;
+  else
+    cache_image_stats.misses++;
+
+  return entry;
+}
+
+lv_cache_entry_t *cache_image_get_victim(lv_cache_t *cache, void *user_data)
+{
+  lv_cache_entry_t *entry = cache_image_original_class->get_victim_cb(cache, user_data);
+  if (entry != NULL)
+    cache_image_stats.evictions++;
+
+  return entry;
+}
+
+void cache_image_init(uint32_t size)
+{
+  lv_cache_t *cache = LV_GLOBAL_DEFAULT()->img_cache;
+  if (cache == NULL)
+  {
+    log_e("LVGL image cache not initialized");
+    return;
+  }
+
+  // Decoded images are allocated in PSRAM
+  lv_draw_buf_handlers_t *handlers = lv_draw_buf_get_image_handlers();
+  handlers->buf_malloc_cb = cache_image_buf_malloc;
+  handlers->buf_free_cb = cache_image_buf_free;
+
+  // Count hits, misses and evictions
+  cache_image_original_class = cache->clz;
+  cache_image_class = *cache->clz;
+  cache_image_class.get_cb = cache_image_get;
+  cache_image_class.get_victim_cb = cache_image_get_victim;
+  cache->clz = &cache_image_class;
+
+  lv_image_cache_resize(size, false);
+  lv_image_header_cache_resize(CACHE_IMAGE_HEADER_COUNT, false);
+  cache_image_stats.max_size = size;
+}
+
+uint32_t cache_glyph_bucket(const lv_font_t *font, uint32_t index)
+{
+  return ((uintptr_t)font >> 2 ^ index * 31) % CACHE_GLYPH_BUCKETS;
+}
+
+void cache_glyph_lru_remove(cache_glyph_t *glyph)
+{
+  if (glyph->lru_prev != NULL)
+    glyph->lru_prev->lru_next = glyph->lru_next;
+  else
+    cache_glyph_lru_head = glyph->lru_next;
+
+  if (glyph->lru_next != NULL)
+    glyph->lru_next->lru_prev = glyph->lru_prev;
+  else
+    cache_glyph_lru_tail = glyph->lru_prev;
+}
+
+void cache_glyph_lru_add(cache_glyph_t *glyph)
+{
+  glyph->lru_prev = NULL;
+  glyph->lru_next = cache_glyph_lru_head;
+  if (cache_glyph_lru_head != NULL)
+    cache_glyph_lru_head->lru_prev = glyph;
+  else
+    cache_glyph_lru_tail = glyph;
+
+  cache_glyph_lru_head = glyph;
+}
+
+void cache_glyph_evict()
+{
+  cache_glyph_t *glyph = cache_glyph_lru_tail;
+  cache_glyph_lru_remove(glyph);
+  cache_glyph_t **link = &cache_glyph_buckets[cache_glyph_bucket(glyph->font, glyph->index)];
+  while (*link != glyph)
+    link = &(*link)->bucket_next;
+
+  *link = glyph->bucket_next;
+  cache_glyph_stats.size -= glyph->draw_buf.data_size;
+  cache_glyph_stats.evictions++;
+  heap_caps_free(glyph);
+}
+
+const void *cache_glyph_get_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+  const lv_font_t *font = g_dsc->resolved_font;
+  const lv_font_t *original = font->user_data;
+  // Only the alpha bitmaps rendered in the draw buffer are cached
+  if (g_dsc->format < LV_FONT_GLYPH_FORMAT_A1 || g_dsc->format > LV_FONT_GLYPH_FORMAT_A8 || draw_buf == NULL)
+    return original->get_glyph_bitmap(g_dsc, draw_buf);
+
+  const uint32_t bucket = cache_glyph_bucket(font, g_dsc->gid.index);
+  for (cache_glyph_t *glyph = cache_glyph_buckets[bucket]; glyph != NULL; glyph = glyph->bucket_next)
+  {
+    if (glyph->font == font && glyph->index == g_dsc->gid.index)
+    {
+      cache_glyph_stats.hits++;
+      cache_glyph_lru_remove(glyph);
+      cache_glyph_lru_add(glyph);
+      return &glyph->draw_buf;
+    }
+  }
+
+  cache_glyph_stats.misses++;
+  const void *bitmap = original->get_glyph_bitmap(g_dsc, draw_buf);
+  // The data size of the draw buffer is its capacity, only the rendered glyph is stored
+  const uint32_t size = draw_buf->header.stride * draw_buf->header.h;
+  if (bitmap != draw_buf || size > cache_glyph_stats.max_size)
+    return bitmap;
+
+  while (cache_glyph_lru_tail != NULL && cache_glyph_stats.size + size > cache_glyph_stats.max_size)
+    cache_glyph_evict();
+
+  cache_glyph_t *glyph = heap_caps_malloc(sizeof(cache_glyph_t) + size, MALLOC_CAP_SPIRAM);
+  if (glyph == NULL)
+  {
+    log_w("Unable to allocate %u bytes for the glyph", size);
+    return bitmap;
+  }
+
+  glyph->font = font;
+  glyph->index = g_dsc->gid.index;
+  lv_draw_buf_init(&glyph->draw_buf, draw_buf->header.w, draw_buf->header.h, draw_buf->header.cf, draw_buf->header.stride, glyph + 1, size);
+  memcpy(glyph + 1, draw_buf->data, size);
+  glyph->bucket_next = cache_glyph_buckets[bucket];
+  cache_glyph_buckets[bucket] = glyph;
+  cache_glyph_lru_add(glyph);
+  cache_glyph_stats.size += size;
+  return bitmap;
+}
+
+const lv_font_t *smartdisplay_cache_font(const lv_font_t *font)
+{
+  log_v("font:0x%08x", font);
+
+  if (cache_glyph_stats.max_size == 0)
+    return font;
+
+  // Fonts are usually const, use a copy with the caching callback
+  lv_font_t *cached_font = heap_caps_malloc(sizeof(lv_font_t), MALLOC_CAP_INTERNAL);
+  if (cached_font == NULL)
+  {
+    log_w("Unable to allocate the cached font, glyphs are not cached");
+    return font;
+  }
+
+  *cached_font = *font;
+  cached_font->get_glyph_bitmap = cache_glyph_get_bitmap;
+  cached_font->user_data = (void *)font;
+  return cached_font;
+}
+
+#ifdef SMARTDISPLAY_PSRAM_CACHE
+void lvgl_cache_init()
+{
+  const uint32_t size = heap_caps_get_free_size(MALLOC_CAP_SPIRAM) * SMARTDISPLAY_PSRAM_CACHE / 100;
+  log_v("size:%u", size);
+  if (size == 0)
+  {
+    log_w("No PSRAM available for the cache");
+    return;
+  }
+
+  cache_image_init(size * CACHE_IMAGE_SHARE);
+  cache_glyph_stats.max_size = size - cache_image_stats.max_size;
+  log_d("Image cache: %u bytes, glyph cache: %u bytes", cache_image_stats.max_size, cache_glyph_stats.max_size);
+}
+#endif
+
+void smartdisplay_cache_get_stats(smartdisplay_cache_stats_t *image, smartdisplay_cache_stats_t *glyph)
+{
+  if (image != NULL)
+  {
+    *image = cache_image_stats;
+    const lv_cache_t *cache = LV_GLOBAL_DEFAULT()->img_cache;
+    image->size = cache != NULL ? cache->size : 0;
+  }
+
+  if (glyph != NULL)
+    *glyph = cache_glyph_stats;
+}
@@ -0,0 +1,108 @@
+#include <esp32_smartdisplay_chunks.h>
+#include <assert.h>
+#include <esp_attr.h>
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_ops.h>
+
+bool smartdisplay_chunks_init(smartdisplay_chunks_t *chunks, smartdisplay_chunk_fill_cb_t fill, const void *user_data, uint32_t buffer_pixels)
+{
+  *chunks = (smartdisplay_chunks_t){.fill = fill, .user_data = user_data, .buffer_pixels = buffer_pixels};
+  if (buffer_pixels == 0)
+    return true;
+
+  for (uint8_t i = 0; i < SMARTDISPLAY_CHUNK_BUFFERS; i++)
+  {
+    chunks->buffers[i] = heap_caps_malloc(buffer_pixels * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (chunks->buffers[i] == NULL)
+    {
+      for (uint8_t j = 0; j < i; j++)
+        heap_caps_free(chunks->buffers[j]);
+
+      *chunks = (smartdisplay_chunks_t){.fill = fill, .user_data = user_data};
+      return false;
+    }
+  }
+
+  chunks->semaphore = xSemaphoreCreateBinary();
+  assert(chunks->semaphore != NULL);
+  return true;
+}
+
+void smartdisplay_chunks_send(smartdisplay_chunks_t *chunks, esp_lcd_panel_handle_t panel_handle, const lv_area_t *area, uint8_t *px_map, uint32_t stride, int32_t chunk_rows)
+{
+  const int32_t width = lv_area_get_width(area);
+  const uint32_t count = (lv_area_get_height(area) + chunk_rows - 1) / chunk_rows;
+  const bool in_place = chunks->buffers[0] == NULL;
+
+  chunks->remaining = count;
+  if (!in_place)
+    xSemaphoreTake(chunks->semaphore, 0);
+
+  for (uint32_t chunk = 0; chunk < count; chunk++)
+  {
+    const int32_t y1 = area->y1 + chunk * chunk_rows;
+    const int32_t y2 = LV_MIN(y1 + chunk_rows - 1, area->y2);
+    uint8_t *src = px_map + (y1 - area->y1) * stride;
+    uint16_t *dest = (uint16_t *)src;
+    if (!in_place)
+    {
+      // Wait until the chunk sent from this buffer is complete
+      while (count - chunks->remaining + SMARTDISPLAY_CHUNK_BUFFERS <= chunk)
+        xSemaphoreTake(chunks->semaphore, portMAX_DELAY);
+
+      dest = chunks->buffers[chunk % SMARTDISPLAY_CHUNK_BUFFERS];
+    }
+
+    chunks->fill(dest, src, width, y2 - y1 + 1, stride, chunks->user_data);
+    // Waits until the previous chunk is sent before setting the window
+    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, y1, area->x2 + 1, y2 + 1, dest));
+  }
+}
+
+bool IRAM_ATTR smartdisplay_chunks_trans_done(smartdisplay_chunks_t *chunks)
+{
+  if (chunks->remaining == 0)
+    return true;
+
+  const bool last = --chunks->remaining == 0;
+  if (chunks->buffers[0] == NULL)
+    return last;
+
+  // The buffer can be reused
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  xSemaphoreGiveFromISR(chunks->semaphore, &higher_priority_task_woken);
+  if (higher_priority_task_woken)
+    portYIELD_FROM_ISR();
+
+  return last;
+}
+
+void smartdisplay_chunk_swap(uint16_t *dest, const uint8_t *src, int32_t width, int32_t rows, uint32_t stride, const void *user_data)
+{
+  // The rows of RGB565 are contiguous
+  const uint32_t pixels = width * rows;
+  const uint16_t *src16 = (const uint16_t *)src;
+  uint32_t i = 0;
+  if (((uintptr_t)dest & 3) == 0 && ((uintptr_t)src & 3) == 0)
+  {
+    const uint32_t *src32 = (const uint32_t *)src;
+    uint32_t *dest32 = (uint32_t *)dest;
+    for (; i + 1 < pixels; i += 2)
+    {
+      const uint32_t w = *src32++;
+      *dest32++ = ((w & 0x00ff00ff) << 8) | ((w >> 8) & 0x00ff00ff);
+    }
+  }
+
+  for (; i < pixels; i++)
+    dest[i] = (uint16_t)((src16[i] >> 8) | (src16[i] << 8));
+}
+
+void smartdisplay_chunk_expand_l8(uint16_t *dest, const uint8_t *src, int32_t width, int32_t rows, uint32_t stride, const void *user_data)
+{
+  const uint16_t *lut = user_data;
+  for (int32_t y = 0; y < rows; y++, src += stride)
+    for (int32_t x = 0; x < width; x++)
+      *dest++ = lut[src[x]];
+}
@@ -0,0 +1,238 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_upscale.h>
+
+#ifdef SMARTDISPLAY_DRS
+
+#if !defined(DISPLAY_ST7701_PAR) && !defined(DISPLAY_ST7262_PAR)
+#error "SMARTDISPLAY_DRS is only supported for RGB panels"
+#endif
+
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR < 5
+#error "SMARTDISPLAY_DRS requires ESP-IDF 5 (Arduino 3)"
+#endif
+
+#if defined(SMARTDISPLAY_RGB_VSYNC) || defined(SMARTDISPLAY_RGB_DMA_COPY) || defined(SMARTDISPLAY_RENDER_L8)
+#error "SMARTDISPLAY_DRS can not be combined with SMARTDISPLAY_RGB_VSYNC, SMARTDISPLAY_RGB_DMA_COPY or SMARTDISPLAY_RENDER_L8"
+#endif
+
+#if DISPLAY_WIDTH % 2 != 0 || DISPLAY_HEIGHT % 2 != 0
+#error "SMARTDISPLAY_DRS requires an even display width and height"
+#endif
+
+#include <esp_lcd_panel_rgb.h>
+#include <esp32s3/rom/cache.h>
+
+// Invalidated part of the screen [%] per governor interval while animating to render at half resolution
+#ifndef SMARTDISPLAY_DRS_THRESHOLD
+#define SMARTDISPLAY_DRS_THRESHOLD 50
+#endif
+
+// Time below the threshold before rendering at full resolution again [ms]
+#ifndef SMARTDISPLAY_DRS_HOLD
+#define SMARTDISPLAY_DRS_HOLD 200
+#endif
+
+// Interval of the governor [ms]
+#define DRS_GOVERNOR_PERIOD 50
+
+extern lv_display_t *display;
+extern esp_lcd_panel_handle_t rgb_panel_handle;
+
+uint16_t *drs_frame_buffer;
+#ifdef SMARTDISPLAY_DRS_BILINEAR
+smartdisplay_upscale_t drs_upscale;
+#endif
+// Enabled by the application
+bool drs_enabled;
+// Set while changing the scale, the invalidation of the scaled areas is not counted
+bool drs_switching;
+uint32_t drs_invalidated_area;
+uint32_t drs_last_busy;
+// Screen drawn at half size and the part of the display flushed at half size, rendered again at full resolution
+lv_obj_t *drs_screen;
+bool drs_scaled_valid;
+lv_area_t drs_scaled_area;
+
+#endif
+
+smartdisplay_drs_stats_t drs_stats;
+
+#ifdef SMARTDISPLAY_DRS
+
+void drs_invalidate_area_callback(lv_event_t *event)
+{
+  if (drs_switching)
+    return;
+
+  const lv_area_t *area = lv_event_get_param(event);
+  // In pixels of the panel
+  drs_invalidated_area += lv_area_get_size(area) * (drs_stats.scaled ? 4 : 1);
+}
+
+void drs_screen_delete_event(lv_event_t *event)
+{
+  drs_screen = NULL;
+}
+
+// Drawn through a transformed layer around the top left corner (default pivot), the layout is not changed
+void drs_set_scale(lv_obj_t *obj, bool scaled)
+{
+  if (scaled)
+  {
+    lv_obj_set_style_transform_scale(obj, LV_SCALE_NONE / 2, LV_PART_MAIN);
+    return;
+  }
+
+  lv_obj_remove_local_style_prop(obj, LV_STYLE_TRANSFORM_SCALE_X, LV_PART_MAIN);
+  lv_obj_remove_local_style_prop(obj, LV_STYLE_TRANSFORM_SCALE_Y, LV_PART_MAIN);
+}
+
+void drs_set_scaled(bool scaled)
+{
+  if (scaled == drs_stats.scaled)
+    return;
+
+  log_d("scaled: %d", scaled);
+  // The frame buffer keeps the picture, only the changes are rendered at the new scale
+  lv_display_enable_invalidation(display, false);
+  if (scaled)
+  {
+    drs_screen = lv_display_get_screen_active(display);
+    lv_obj_add_event_cb(drs_screen, drs_screen_delete_event, LV_EVENT_DELETE, NULL);
+    drs_set_scale(drs_screen, true);
+  }
+  else if (drs_screen != NULL)
+  {
+    lv_obj_remove_event_cb(drs_screen, drs_screen_delete_event);
+    drs_set_scale(drs_screen, false);
+    drs_screen = NULL;
+  }
+
+  drs_set_scale(lv_display_get_layer_bottom(display), scaled);
+  drs_set_scale(lv_display_get_layer_top(display), scaled);
+  drs_set_scale(lv_display_get_layer_sys(display), scaled);
+  lv_display_enable_invalidation(display, true);
+
+  // The areas upscaled into the frame buffer
+  if (!scaled && drs_scaled_valid)
+  {
+    lv_area_t area = {.x1 = 2 * drs_scaled_area.x1, .y1 = 2 * drs_scaled_area.y1, .x2 = 2 * drs_scaled_area.x2 + 1, .y2 = 2 * drs_scaled_area.y2 + 1};
+    drs_switching = true;
+    lv_inv_area(display, &area);
+    drs_switching = false;
+  }
+
+  drs_scaled_valid = false;
+#ifdef SMARTDISPLAY_DRS_BILINEAR
+  smartdisplay_upscale_reset(&drs_upscale);
+#endif
+  drs_stats.scaled = scaled;
+  drs_stats.switches++;
+}
+
+void drs_refresh_start(lv_event_t *event)
+{
+  // A loaded screen is rendered at full resolution
+  if (drs_stats.scaled && lv_display_get_screen_active(display) != drs_screen)
+    drs_set_scaled(false);
+}
+
+void drs_governor(lv_timer_t *timer)
+{
+  drs_stats.invalidated_pct = (uint64_t)drs_invalidated_area * 100 / (DISPLAY_WIDTH * DISPLAY_HEIGHT);
+  drs_invalidated_area = 0;
+
+  // Full resolution when rotated or while loading a screen
+  if (!drs_enabled || display->rotation != LV_DISPLAY_ROTATION_0 || display->prev_scr != NULL)
+  {
+    drs_set_scaled(false);
+    return;
+  }
+
+  const uint32_t now = lv_tick_get();
+  if (lv_anim_count_running() > 0 && drs_stats.invalidated_pct >= SMARTDISPLAY_DRS_THRESHOLD)
+  {
+    drs_last_busy = now;
+    drs_set_scaled(true);
+  }
+  else if (lv_tick_diff(now, drs_last_busy) >= SMARTDISPLAY_DRS_HOLD)
+    drs_set_scaled(false);
+}
+
+void lvgl_drs_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  ESP_ERROR_CHECK(esp_lcd_rgb_panel_get_frame_buffer(rgb_panel_handle, 1, (void **)&drs_frame_buffer));
+#ifdef SMARTDISPLAY_DRS_BILINEAR
+  const bool allocated = smartdisplay_upscale_init(&drs_upscale, DISPLAY_WIDTH / 2);
+  assert(allocated);
+#endif
+
+  lv_display_add_event_cb(display, drs_invalidate_area_callback, LV_EVENT_INVALIDATE_AREA, NULL);
+  lv_display_add_event_cb(display, drs_refresh_start, LV_EVENT_REFR_START, NULL);
+  lv_timer_create(drs_governor, DRS_GOVERNOR_PERIOD, NULL);
+}
+
+// Called by the RGB flush when not rotated. Returns true if the area is upscaled into the frame buffer
+bool lvgl_drs_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  // The scaled screen covers the top left quarter of the display
+  if (!drs_stats.scaled || area->x2 >= DISPLAY_WIDTH / 2 || area->y2 >= DISPLAY_HEIGHT / 2)
+    return false;
+
+  if (drs_scaled_valid)
+    drs_scaled_area = (lv_area_t){.x1 = LV_MIN(drs_scaled_area.x1, area->x1), .y1 = LV_MIN(drs_scaled_area.y1, area->y1), .x2 = LV_MAX(drs_scaled_area.x2, area->x2), .y2 = LV_MAX(drs_scaled_area.y2, area->y2)};
+  else
+    drs_scaled_area = *area;
+
+  drs_scaled_valid = true;
+
+  const int32_t width = lv_area_get_width(area);
+  const uint32_t stride = lv_draw_buf_width_to_stride(width, LV_COLOR_FORMAT_RGB565) / sizeof(uint16_t);
+#ifdef SMARTDISPLAY_DRS_BILINEAR
+  // Includes the last odd row of the area above when interpolated with this area
+  const int32_t first_row = smartdisplay_upscale_bilinear(&drs_upscale, drs_frame_buffer, DISPLAY_WIDTH, area, (const uint16_t *)px_map, stride);
+#else
+  smartdisplay_upscale_nearest(drs_frame_buffer, DISPLAY_WIDTH, area, (const uint16_t *)px_map, stride);
+  const int32_t first_row = 2 * area->y1;
+#endif
+
+  // Scanned out by the GDMA, bypassing the cache
+  const uint16_t *start = drs_frame_buffer + first_row * DISPLAY_WIDTH + 2 * area->x1;
+  Cache_WriteBack_Addr((uint32_t)start, ((2 * area->y2 + 1 - first_row) * DISPLAY_WIDTH + 2 * width) * sizeof(uint16_t));
+
+  if (lv_display_flush_is_last(display))
+    drs_stats.frames++;
+
+  lv_display_flush_ready(display);
+  return true;
+}
+
+// Called by the touch read. Scales the point to the screen drawn at half size, LVGL transforms it back to the screen
+void lvgl_drs_touch(lv_indev_data_t *data)
+{
+  if (!drs_stats.scaled)
+    return;
+
+  data->point.x /= 2;
+  data->point.y /= 2;
+}
+
+#endif
+
+void smartdisplay_drs_enable(bool enable)
+{
+  log_v("enable:%d", enable);
+#ifdef SMARTDISPLAY_DRS
+  drs_enabled = enable;
+  if (!enable)
+    drs_set_scaled(false);
+#endif
+}
+
+void smartdisplay_drs_get_stats(smartdisplay_drs_stats_t *stats)
+{
+  *stats = drs_stats;
+}
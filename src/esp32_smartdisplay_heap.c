@@ -0,0 +1,113 @@
+#include <esp32_smartdisplay.h>
+#include <esp_heap_caps.h>
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+#include <stdlib/builtin/lv_tlsf.h>
+#endif
+
+// Interval for sampling the pool usage (high-water marks) [ms]
+#define HEAP_MONITOR_PERIOD 250
+
+smartdisplay_heap_stats_t heap_stats;
+lv_mem_pool_t heap_pools[SMARTDISPLAY_HEAP_MAX_POOLS];
+lv_timer_t *heap_monitor_timer;
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+void heap_pool_walker(void *ptr, size_t size, int used, void *user)
+{
+  smartdisplay_heap_pool_stats_t *pool_stats = user;
+  if (used)
+    pool_stats->used += size;
+  else if (size > pool_stats->free_biggest)
+    pool_stats->free_biggest = size;
+}
+
+void heap_update_stats()
+{
+  for (uint8_t i = 0; i < heap_stats.pool_count; i++)
+  {
+    smartdisplay_heap_pool_stats_t *pool_stats = &heap_stats.pools[i];
+    pool_stats->used = pool_stats->free_biggest = 0;
+    lv_tlsf_walk_pool(heap_pools[i], heap_pool_walker, pool_stats);
+    if (pool_stats->used > pool_stats->max_used)
+      pool_stats->max_used = pool_stats->used;
+
+    const uint32_t free = pool_stats->size - pool_stats->used;
+    pool_stats->frag_pct = free > 0 ? 100 - (uint64_t)pool_stats->free_biggest * 100 / free : 0;
+  }
+
+  // Totals of all pools, including the LV_MEM_SIZE pool
+  lv_mem_monitor_t monitor;
+  lv_mem_monitor(&monitor);
+  heap_stats.total_size = monitor.total_size;
+  heap_stats.used = monitor.total_size - monitor.free_size;
+  heap_stats.max_used = monitor.max_used;
+  heap_stats.frag_pct = monitor.frag_pct;
+}
+
+void heap_monitor(lv_timer_t *timer)
+{
+  heap_update_stats();
+}
+#endif
+
+bool smartdisplay_heap_add_pool(uint32_t size, uint32_t caps)
+{
+  log_v("size:%u, caps:0x%08x", size, caps);
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+  if (heap_stats.pool_count == SMARTDISPLAY_HEAP_MAX_POOLS)
+  {
+    log_e("Maximum number of pools reached");
+    return false;
+  }
+
+  void *memory = heap_caps_malloc(size, caps);
+  if (memory == NULL)
+  {
+    log_e("Unable to allocate %u bytes for the LVGL heap (caps:0x%08x)", size, caps);
+    return false;
+  }
+
+  const lv_mem_pool_t pool = lv_mem_add_pool(memory, size);
+  if (pool == NULL)
+  {
+    log_e("Unable to add the pool to the LVGL heap");
+    heap_caps_free(memory);
+    return false;
+  }
+
+  heap_pools[heap_stats.pool_count] = pool;
+  heap_stats.pools[heap_stats.pool_count] = (smartdisplay_heap_pool_stats_t){.caps = caps, .size = size};
+  heap_stats.pool_count++;
+  if (heap_monitor_timer == NULL)
+    heap_monitor_timer = lv_timer_create(heap_monitor, HEAP_MONITOR_PERIOD, NULL);
+
+  log_d("LVGL heap pool added: size:%u, caps:0x%08x", size, caps);
+  return true;
+#else
+  log_e("LVGL heap pools require LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN");
+  return false;
+#endif
+}
+
+void lvgl_heap_init()
+{
+  log_v("");
+
+  // Called after the display initialization, so the draw buffer has the internal DMA memory
+#ifdef SMARTDISPLAY_LVGL_HEAP_INTERNAL
+  smartdisplay_heap_add_pool(SMARTDISPLAY_LVGL_HEAP_INTERNAL, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+#ifdef SMARTDISPLAY_LVGL_HEAP_PSRAM
+  smartdisplay_heap_add_pool(SMARTDISPLAY_LVGL_HEAP_PSRAM, MALLOC_CAP_SPIRAM);
+#endif
+}
+
+void smartdisplay_heap_get_stats(smartdisplay_heap_stats_t *stats)
+{
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+  heap_update_stats();
+#endif
+  *stats = heap_stats;
+}
@@ -0,0 +1,211 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_heatmap_tiles.h>
+
+#ifdef SMARTDISPLAY_HEATMAP
+
+#include <esp_heap_caps.h>
+
+// Size of the (square) tiles in pixels
+#ifndef SMARTDISPLAY_HEATMAP_TILE
+#define SMARTDISPLAY_HEATMAP_TILE 16
+#endif
+
+// Tiles for the largest resolution, in any rotation
+#define HEATMAP_TILES_MAX (((LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT) + SMARTDISPLAY_HEATMAP_TILE - 1) / SMARTDISPLAY_HEATMAP_TILE) * ((LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT) + SMARTDISPLAY_HEATMAP_TILE - 1) / SMARTDISPLAY_HEATMAP_TILE))
+
+extern lv_display_t *display;
+
+smartdisplay_heatmap_tile_t *heatmap_tiles;
+// Copy of the pixels shown by the panel (before byte swapping), NULL if it could not be allocated
+uint8_t *heatmap_copy;
+uint32_t heatmap_px_size;
+// The copy holds the complete screen after the first frame
+bool heatmap_copy_valid;
+// Counting is paused while the overlay is shown, and resumed after the frame that removes it
+bool heatmap_paused;
+bool heatmap_resume_pending;
+lv_obj_t *heatmap_overlay;
+
+#endif
+
+smartdisplay_heatmap_stats_t heatmap_stats;
+
+#ifdef SMARTDISPLAY_HEATMAP
+
+void heatmap_clear()
+{
+  const int32_t width = lv_display_get_horizontal_resolution(display);
+  const int32_t height = lv_display_get_vertical_resolution(display);
+  memset(heatmap_tiles, 0, HEATMAP_TILES_MAX * sizeof(smartdisplay_heatmap_tile_t));
+  heatmap_stats = (smartdisplay_heatmap_stats_t){
+      .tile_size = SMARTDISPLAY_HEATMAP_TILE,
+      .tiles_x = (width + SMARTDISPLAY_HEATMAP_TILE - 1) / SMARTDISPLAY_HEATMAP_TILE,
+      .tiles_y = (height + SMARTDISPLAY_HEATMAP_TILE - 1) / SMARTDISPLAY_HEATMAP_TILE};
+}
+
+// Compare the area with the copy and update the copy. Returns true if no pixel changed
+bool heatmap_update_copy(const lv_area_t *area)
+{
+  const lv_draw_buf_t *draw_buf = display->buf_act;
+  const uint8_t *src = draw_buf->data;
+  // Only the partial mode renders the area at the start of the buffer
+  if (display->render_mode != LV_DISPLAY_RENDER_MODE_PARTIAL)
+    src += area->y1 * draw_buf->header.stride + area->x1 * heatmap_px_size;
+
+  return smartdisplay_heatmap_copy_update(heatmap_copy, lv_display_get_horizontal_resolution(display), area, src, draw_buf->header.stride, heatmap_px_size);
+}
+
+void heatmap_flush_start(lv_event_t *event)
+{
+  const lv_area_t *area = lv_event_get_param(event);
+  const bool redundant = heatmap_copy != NULL && heatmap_update_copy(area) && heatmap_copy_valid;
+  const bool last = lv_display_flush_is_last(display);
+  if (last && heatmap_copy != NULL)
+    heatmap_copy_valid = true;
+
+  if (heatmap_paused)
+  {
+    if (last && heatmap_resume_pending)
+    {
+      heatmap_paused = false;
+      heatmap_resume_pending = false;
+    }
+
+    return;
+  }
+
+  const uint32_t bytes = lv_area_get_size(area) * heatmap_px_size;
+  heatmap_stats.flushes++;
+  heatmap_stats.bytes += bytes;
+  if (redundant)
+  {
+    // Points to an object that invalidates without changing its content
+    log_d("Redundant flush: x1:%d, y1:%d, x2:%d, y2:%d", area->x1, area->y1, area->x2, area->y2);
+    heatmap_stats.redundant++;
+    heatmap_stats.redundant_bytes += bytes;
+  }
+
+  smartdisplay_heatmap_tiles_add(heatmap_tiles, SMARTDISPLAY_HEATMAP_TILE, heatmap_stats.tiles_x, area, heatmap_px_size, redundant);
+}
+
+void heatmap_resolution_changed(lv_event_t *event)
+{
+  // The tiles and the copy are no longer at the same position
+  heatmap_copy_valid = false;
+  heatmap_clear();
+}
+
+// Tiles colored from blue (few bytes) to red (most bytes), tiles with redundant flushes are outlined
+void heatmap_overlay_draw(lv_event_t *event)
+{
+  lv_layer_t *layer = lv_event_get_layer(event);
+  uint32_t max_bytes = 1;
+  for (uint32_t i = 0; i < heatmap_stats.tiles_x * heatmap_stats.tiles_y; i++)
+    max_bytes = LV_MAX(max_bytes, heatmap_tiles[i].bytes);
+
+  lv_draw_rect_dsc_t rect_dsc;
+  lv_draw_rect_dsc_init(&rect_dsc);
+  rect_dsc.bg_opa = LV_OPA_60;
+  rect_dsc.border_color = lv_color_white();
+  rect_dsc.border_width = 1;
+  for (uint16_t ty = 0; ty < heatmap_stats.tiles_y; ty++)
+    for (uint16_t tx = 0; tx < heatmap_stats.tiles_x; tx++)
+    {
+      const smartdisplay_heatmap_tile_t *tile = &heatmap_tiles[ty * heatmap_stats.tiles_x + tx];
+      if (tile->flushes == 0)
+        continue;
+
+      const lv_area_t area = {.x1 = tx * SMARTDISPLAY_HEATMAP_TILE, .y1 = ty * SMARTDISPLAY_HEATMAP_TILE, .x2 = (tx + 1) * SMARTDISPLAY_HEATMAP_TILE - 1, .y2 = (ty + 1) * SMARTDISPLAY_HEATMAP_TILE - 1};
+      rect_dsc.bg_color = lv_color_hsv_to_rgb(240 - (uint64_t)240 * tile->bytes / max_bytes, 100, 100);
+      rect_dsc.border_opa = tile->redundant > 0 ? LV_OPA_COVER : LV_OPA_TRANSP;
+      lv_draw_rect(layer, &rect_dsc, &area);
+    }
+}
+
+void lvgl_heatmap_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  heatmap_tiles = heap_caps_malloc(HEATMAP_TILES_MAX * sizeof(smartdisplay_heatmap_tile_t), MALLOC_CAP_DEFAULT);
+  assert(heatmap_tiles != NULL);
+  heatmap_clear();
+
+  heatmap_px_size = lv_color_format_get_size(lv_display_get_color_format(display));
+  const uint32_t copy_size = DISPLAY_WIDTH * DISPLAY_HEIGHT * heatmap_px_size;
+  heatmap_copy = heap_caps_malloc(copy_size, MALLOC_CAP_SPIRAM);
+  if (heatmap_copy == NULL)
+    heatmap_copy = heap_caps_malloc(copy_size, MALLOC_CAP_DEFAULT);
+  if (heatmap_copy == NULL)
+    log_w("Unable to allocate the copy of the screen (%u bytes), redundant flushes are not detected", copy_size);
+
+  lv_display_add_event_cb(display, heatmap_flush_start, LV_EVENT_FLUSH_START, NULL);
+  lv_display_add_event_cb(display, heatmap_resolution_changed, LV_EVENT_RESOLUTION_CHANGED, NULL);
+}
+
+#endif
+
+void smartdisplay_heatmap_get_stats(smartdisplay_heatmap_stats_t *stats)
+{
+  *stats = heatmap_stats;
+}
+
+void smartdisplay_heatmap_reset()
+{
+#ifdef SMARTDISPLAY_HEATMAP
+  heatmap_clear();
+  if (heatmap_overlay != NULL)
+    lv_obj_invalidate(heatmap_overlay);
+#endif
+}
+
+void smartdisplay_heatmap_show(bool show)
+{
+  log_v("show:%d", show);
+#ifdef SMARTDISPLAY_HEATMAP
+  if (show == (heatmap_overlay != NULL))
+    return;
+
+  if (show)
+  {
+    // The redraws of the overlay are not counted
+    heatmap_paused = true;
+    heatmap_resume_pending = false;
+    heatmap_overlay = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(heatmap_overlay);
+    lv_obj_set_size(heatmap_overlay, LV_PCT(100), LV_PCT(100));
+    lv_obj_remove_flag(heatmap_overlay, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(heatmap_overlay, heatmap_overlay_draw, LV_EVENT_DRAW_MAIN, NULL);
+    return;
+  }
+
+  lv_obj_delete(heatmap_overlay);
+  heatmap_overlay = NULL;
+  // Resume after the frame that removes the overlay
+  heatmap_resume_pending = true;
+#endif
+}
+
+void smartdisplay_heatmap_dump()
+{
+#ifdef SMARTDISPLAY_HEATMAP
+  log_printf("# heatmap begin\n");
+  log_printf("tile:%u, tiles:%ux%u, flushes:%u, bytes:%llu, redundant:%u, redundant bytes:%llu\n", heatmap_stats.tile_size, heatmap_stats.tiles_x, heatmap_stats.tiles_y, heatmap_stats.flushes, heatmap_stats.bytes, heatmap_stats.redundant, heatmap_stats.redundant_bytes);
+  const char *names[] = {"flushes", "bytes", "redundant"};
+  for (uint8_t field = 0; field < 3; field++)
+  {
+    log_printf("%s\n", names[field]);
+    for (uint16_t ty = 0; ty < heatmap_stats.tiles_y; ty++)
+    {
+      for (uint16_t tx = 0; tx < heatmap_stats.tiles_x; tx++)
+      {
+        const smartdisplay_heatmap_tile_t *tile = &heatmap_tiles[ty * heatmap_stats.tiles_x + tx];
+        log_printf("%s%u", tx > 0 ? "," : "", field == 0 ? tile->flushes : field == 1 ? tile->bytes : tile->redundant);
+      }
+
+      log_printf("\n");
+    }
+  }
+
+  log_printf("# heatmap end\n");
+#endif
+}
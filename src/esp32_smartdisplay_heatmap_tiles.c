@@ -0,0 +1,38 @@
+#include <esp32_smartdisplay_heatmap_tiles.h>
+#include <string.h>
+
+void smartdisplay_heatmap_tiles_add(smartdisplay_heatmap_tile_t *tiles, int32_t tile_size, uint32_t tiles_x, const lv_area_t *area, uint32_t px_size, bool redundant)
+{
+  for (int32_t ty = area->y1 / tile_size; ty <= area->y2 / tile_size; ty++)
+    for (int32_t tx = area->x1 / tile_size; tx <= area->x2 / tile_size; tx++)
+    {
+      // Part of the area in the tile
+      const lv_area_t tile_area = {
+          .x1 = LV_MAX(area->x1, tx * tile_size),
+          .y1 = LV_MAX(area->y1, ty * tile_size),
+          .x2 = LV_MIN(area->x2, (tx + 1) * tile_size - 1),
+          .y2 = LV_MIN(area->y2, (ty + 1) * tile_size - 1)};
+      smartdisplay_heatmap_tile_t *tile = &tiles[ty * tiles_x + tx];
+      tile->flushes++;
+      tile->bytes += lv_area_get_size(&tile_area) * px_size;
+      if (redundant)
+        tile->redundant++;
+    }
+}
+
+bool smartdisplay_heatmap_copy_update(uint8_t *copy, int32_t hor_res, const lv_area_t *area, const uint8_t *src, uint32_t stride, uint32_t px_size)
+{
+  const uint32_t row_bytes = lv_area_get_width(area) * px_size;
+  bool unchanged = true;
+  for (int32_t y = area->y1; y <= area->y2; y++, src += stride)
+  {
+    uint8_t *dest = copy + (y * hor_res + area->x1) * px_size;
+    if (unchanged && memcmp(dest, src, row_bytes) == 0)
+      continue;
+
+    unchanged = false;
+    memcpy(dest, src, row_bytes);
+  }
+
+  return unchanged;
+}
@@ -0,0 +1,109 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_chunks.h>
+#include <esp_heap_caps.h>
+
+#ifdef SMARTDISPLAY_RENDER_L8
+
+#if defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR)
+// The frame buffer is 8 bit and expanded in the bounce buffers, see esp32_smartdisplay_rgb_l8.c
+#define L8_RGB_PANEL
+#elif !defined(DISPLAY_ILI9341_SPI) && !defined(DISPLAY_ST7796_SPI) && !defined(DISPLAY_GC9A01_SPI) && !defined(DISPLAY_ST7789_SPI)
+#error "SMARTDISPLAY_RENDER_L8 is only supported for SPI and RGB panels"
+#endif
+
+#if defined(SMARTDISPLAY_SHADOW_BUFFER) || defined(SMARTDISPLAY_ROUND_MASK) || defined(SMARTDISPLAY_BUFFER_TUNE)
+#error "SMARTDISPLAY_RENDER_L8 can not be combined with SMARTDISPLAY_SHADOW_BUFFER, SMARTDISPLAY_ROUND_MASK or SMARTDISPLAY_BUFFER_TUNE"
+#endif
+
+// Pixels expanded and sent per transaction. At least one line is sent per transaction
+#ifndef SMARTDISPLAY_L8_CHUNK_PIXELS
+#define SMARTDISPLAY_L8_CHUNK_PIXELS 1024
+#endif
+
+#ifdef SMARTDISPLAY_TE_GPIO
+extern void lvgl_te_wait(lv_display_t *display);
+#endif
+
+#ifdef L8_RGB_PANEL
+extern void lvgl_rgb_l8_init(lv_display_t *display);
+#endif
+
+// Luminance to RGB565 (byte swapped for the SPI panels)
+uint16_t l8_lut[256];
+
+#ifndef L8_RGB_PANEL
+smartdisplay_chunks_t l8_chunks;
+#endif
+
+void lvgl_l8_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  smartdisplay_l8_set_lut(NULL);
+
+#ifndef L8_RGB_PANEL
+  // Chunks of at least one line in any rotation, in DMA capable memory
+  const bool allocated = smartdisplay_chunks_init(&l8_chunks, smartdisplay_chunk_expand_l8, l8_lut, LV_MAX(SMARTDISPLAY_L8_CHUNK_PIXELS, LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT)));
+  assert(allocated);
+#endif
+
+  // Same memory as the RGB565 draw buffer: twice the lines or two buffers
+  const uint32_t size = LVGL_BUFFER_PIXELS * sizeof(uint16_t);
+  heap_caps_free(display->buf_1->data);
+  lv_display_set_color_format(display, LV_COLOR_FORMAT_L8);
+#ifdef SMARTDISPLAY_L8_DOUBLE_BUFFER
+  void *buffer_1 = heap_caps_malloc(size / 2, LVGL_BUFFER_MALLOC_FLAGS);
+  void *buffer_2 = heap_caps_malloc(size / 2, LVGL_BUFFER_MALLOC_FLAGS);
+  assert(buffer_1 != NULL && buffer_2 != NULL);
+  lv_display_set_buffers(display, buffer_1, buffer_2, size / 2, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#else
+  void *buffer = heap_caps_malloc(size, LVGL_BUFFER_MALLOC_FLAGS);
+  assert(buffer != NULL);
+  lv_display_set_buffers(display, buffer, NULL, size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#endif
+
+#ifdef L8_RGB_PANEL
+  // 8 bit frame buffer and the bounce buffer callback
+  lvgl_rgb_l8_init(display);
+#endif
+}
+
+#ifndef L8_RGB_PANEL
+// Called by the SPI flush instead of the byte swapping
+bool lvgl_l8_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  const int32_t width = lv_area_get_width(area);
+#ifdef SMARTDISPLAY_TE_GPIO
+  lvgl_te_wait(display);
+#endif
+
+  smartdisplay_chunks_send(&l8_chunks, display->user_data, area, px_map, lv_draw_buf_width_to_stride(width, LV_COLOR_FORMAT_L8), l8_chunks.buffer_pixels / width);
+  return true;
+}
+
+// Called from the color transfer done ISR. Returns true when the last chunk of the area is sent
+bool IRAM_ATTR lvgl_l8_color_trans_done()
+{
+  return smartdisplay_chunks_trans_done(&l8_chunks);
+}
+#endif
+
+#endif
+
+void smartdisplay_l8_set_lut(const lv_color_t *colors)
+{
+#ifdef SMARTDISPLAY_RENDER_L8
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    const lv_color_t color = colors != NULL ? colors[i] : lv_color_make(i, i, i);
+    const uint16_t rgb565 = lv_color_to_u16(color);
+#ifdef L8_RGB_PANEL
+    l8_lut[i] = rgb565;
+#else
+    l8_lut[i] = (uint16_t)((rgb565 >> 8) | (rgb565 << 8));
+#endif
+  }
+
+  lv_obj_invalidate(lv_screen_active());
+#endif
+}
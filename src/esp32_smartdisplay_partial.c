@@ -0,0 +1,155 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_partial_rows.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_commands.h>
+#include <esp_timer.h>
+
+#ifdef SMARTDISPLAY_PARTIAL
+
+#if !defined(DISPLAY_ILI9341_SPI) && !defined(DISPLAY_ST7796_SPI) && !defined(DISPLAY_GC9A01_SPI) && !defined(DISPLAY_ST7789_SPI)
+#error "SMARTDISPLAY_PARTIAL is only supported for the ILI9341, ST7796, GC9A01 and ST7789 SPI panels"
+#endif
+
+// Rows of the panel memory
+#if defined(DISPLAY_ST7796_SPI)
+#define PARTIAL_GRAM_ROWS 480
+#elif defined(DISPLAY_GC9A01_SPI)
+#define PARTIAL_GRAM_ROWS 240
+#else
+#define PARTIAL_GRAM_ROWS 320
+#endif
+
+#ifdef DISPLAY_GAP_Y
+#define PARTIAL_GAP_Y DISPLAY_GAP_Y
+#else
+#define PARTIAL_GAP_Y 0
+#endif
+
+extern lv_display_t *display;
+extern void lvgl_invalidate_area_drop(lv_display_t *display, lv_area_t *area);
+extern void lvgl_invalidate_area_keep(lv_display_t *display, const lv_area_t *area);
+
+int64_t partial_mode_enter_time;
+
+#endif
+
+smartdisplay_partial_stats_t partial_stats;
+
+#ifdef SMARTDISPLAY_PARTIAL
+
+void partial_set_mode(bool partial, bool idle)
+{
+  const int64_t now = esp_timer_get_time();
+  const smartdisplay_panel_mode_t mode = (partial ? SMARTDISPLAY_PANEL_MODE_PARTIAL : 0) | (idle ? SMARTDISPLAY_PANEL_MODE_IDLE : 0);
+  partial_stats.mode_time_us[partial_stats.mode] += now - partial_mode_enter_time;
+  partial_mode_enter_time = now;
+  partial_stats.mode = mode;
+}
+
+// Clip the invalidated areas to the partial area, the other rows are not displayed
+void partial_invalidate_area(lv_event_t *event)
+{
+  lv_area_t *area = lv_event_get_param(event);
+  if (partial_stats.mode & SMARTDISPLAY_PANEL_MODE_PARTIAL)
+  {
+    const smartdisplay_partial_clip_t clip = smartdisplay_partial_clip(area, partial_stats.y1, partial_stats.y2);
+    if (clip != SMARTDISPLAY_PARTIAL_INSIDE)
+      partial_stats.clipped++;
+
+    if (clip == SMARTDISPLAY_PARTIAL_OUTSIDE)
+    {
+      lvgl_invalidate_area_drop(display, area);
+      return;
+    }
+  }
+
+  lvgl_invalidate_area_keep(display, area);
+}
+
+void partial_flush_start(lv_event_t *event)
+{
+  partial_stats.mode_bytes[partial_stats.mode] += lv_area_get_size(lv_event_get_param(event)) * lv_color_format_get_size(lv_display_get_color_format(display));
+}
+
+void partial_resolution_changed(lv_event_t *event)
+{
+  // The rows of the partial area are no longer the same
+  smartdisplay_partial_set_area(0, -1);
+}
+
+void lvgl_partial_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  partial_mode_enter_time = esp_timer_get_time();
+  lv_display_add_event_cb(display, partial_invalidate_area, LV_EVENT_INVALIDATE_AREA, NULL);
+  lv_display_add_event_cb(display, partial_flush_start, LV_EVENT_FLUSH_START, NULL);
+  lv_display_add_event_cb(display, partial_resolution_changed, LV_EVENT_RESOLUTION_CHANGED, NULL);
+}
+
+#endif
+
+bool smartdisplay_partial_set_area(int32_t y1, int32_t y2)
+{
+  log_v("y1:%d, y2:%d", y1, y2);
+#ifdef SMARTDISPLAY_PARTIAL
+  const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+  const bool idle = partial_stats.mode & SMARTDISPLAY_PANEL_MODE_IDLE;
+  if (y2 < y1)
+  {
+    if (!(partial_stats.mode & SMARTDISPLAY_PANEL_MODE_PARTIAL))
+      return true;
+
+    ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_NORON, NULL, 0));
+    partial_set_mode(false, idle);
+    // The rows outside the partial area were not updated
+    lv_obj_invalidate(lv_screen_active());
+    return true;
+  }
+
+  // The partial area is a range of rows of the panel. See lvgl_display_resolution_changed_callback
+  const lv_display_rotation_t rotation = lv_display_get_rotation(display);
+#ifdef DISPLAY_SOFTWARE_ROTATION
+  if (rotation != LV_DISPLAY_ROTATION_0)
+    return false;
+#endif
+  const bool rotated = rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270;
+  if ((rotated ? !DISPLAY_SWAP_XY : DISPLAY_SWAP_XY) || y1 < 0 || y2 >= lv_display_get_vertical_resolution(display))
+    return false;
+
+  const bool mirror = rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_180 ? !DISPLAY_MIRROR_Y : DISPLAY_MIRROR_Y;
+  int32_t start, end;
+  smartdisplay_partial_rows(PARTIAL_GRAM_ROWS, PARTIAL_GAP_Y, mirror, y1, y2, &start, &end);
+  log_d("start: %d, end: %d", start, end);
+  ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_PTLAR, (uint8_t[]){start >> 8, start, end >> 8, end}, 4));
+  ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_PTLON, NULL, 0));
+  partial_stats.y1 = y1;
+  partial_stats.y2 = y2;
+  partial_set_mode(true, idle);
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool smartdisplay_partial_set_idle(bool idle)
+{
+  log_v("idle:%d", idle);
+#ifdef SMARTDISPLAY_PARTIAL
+  const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+  ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, idle ? LCD_CMD_IDMON : LCD_CMD_IDMOFF, NULL, 0));
+  partial_set_mode(partial_stats.mode & SMARTDISPLAY_PANEL_MODE_PARTIAL, idle);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void smartdisplay_partial_get_stats(smartdisplay_partial_stats_t *stats)
+{
+  *stats = partial_stats;
+#ifdef SMARTDISPLAY_PARTIAL
+  // Include the time in the current mode
+  stats->mode_time_us[partial_stats.mode] += esp_timer_get_time() - partial_mode_enter_time;
+#endif
+}
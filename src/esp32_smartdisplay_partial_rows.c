@@ -0,0 +1,20 @@
+#include <esp32_smartdisplay_partial_rows.h>
+
+smartdisplay_partial_clip_t smartdisplay_partial_clip(lv_area_t *area, int32_t y1, int32_t y2)
+{
+  if (area->y1 >= y1 && area->y2 <= y2)
+    return SMARTDISPLAY_PARTIAL_INSIDE;
+
+  if (area->y2 < y1 || area->y1 > y2)
+    return SMARTDISPLAY_PARTIAL_OUTSIDE;
+
+  area->y1 = LV_MAX(area->y1, y1);
+  area->y2 = LV_MIN(area->y2, y2);
+  return SMARTDISPLAY_PARTIAL_CLIPPED;
+}
+
+void smartdisplay_partial_rows(int32_t gram_rows, int32_t gap_y, bool mirror, int32_t y1, int32_t y2, int32_t *start, int32_t *end)
+{
+  *start = mirror ? gram_rows - 1 - gap_y - y2 : y1 + gap_y;
+  *end = *start + y2 - y1;
+}
@@ -0,0 +1,52 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_chunks.h>
+
+#ifdef SMARTDISPLAY_FLUSH_PIPELINE
+
+#if defined(DISPLAY_ILI9341_SPI)
+#define PIPELINE_TRANS_QUEUE_DEPTH ILI9341_SPI_CONFIG_TRANS_QUEUE_DEPTH
+#elif defined(DISPLAY_ST7796_SPI)
+#define PIPELINE_TRANS_QUEUE_DEPTH ST7796_SPI_CONFIG_TRANS_QUEUE_DEPTH
+#elif defined(DISPLAY_GC9A01_SPI)
+#define PIPELINE_TRANS_QUEUE_DEPTH GC9A01_SPI_CONFIG_TRANS_QUEUE_DEPTH
+#elif defined(DISPLAY_ST7789_SPI)
+#define PIPELINE_TRANS_QUEUE_DEPTH ST7789_SPI_CONFIG_TRANS_QUEUE_DEPTH
+#else
+#error "SMARTDISPLAY_FLUSH_PIPELINE is only supported for SPI panels"
+#endif
+
+#if defined(SMARTDISPLAY_SHADOW_BUFFER) || defined(SMARTDISPLAY_ROUND_MASK) || defined(SMARTDISPLAY_VSCROLL)
+#error "SMARTDISPLAY_FLUSH_PIPELINE can not be combined with SMARTDISPLAY_SHADOW_BUFFER, SMARTDISPLAY_ROUND_MASK or SMARTDISPLAY_VSCROLL"
+#endif
+
+// Chunks per area, by default the depth of the SPI transaction queue. At least one line is sent per chunk
+#ifndef SMARTDISPLAY_FLUSH_CHUNKS
+#define SMARTDISPLAY_FLUSH_CHUNKS PIPELINE_TRANS_QUEUE_DEPTH
+#endif
+
+#ifdef SMARTDISPLAY_TE_GPIO
+extern void lvgl_te_wait(lv_display_t *display);
+#endif
+
+// Swapped in place in the draw buffer
+smartdisplay_chunks_t pipeline_chunks = {.fill = smartdisplay_chunk_swap};
+
+// Called by the SPI flush instead of the byte swapping. The next chunk is swapped in place while the previous one is sent
+bool lvgl_pipeline_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  const int32_t height = lv_area_get_height(area);
+  const int32_t chunk_rows = (height + SMARTDISPLAY_FLUSH_CHUNKS - 1) / SMARTDISPLAY_FLUSH_CHUNKS;
+#ifdef SMARTDISPLAY_TE_GPIO
+  lvgl_te_wait(display);
+#endif
+  smartdisplay_chunks_send(&pipeline_chunks, display->user_data, area, px_map, lv_draw_buf_width_to_stride(lv_area_get_width(area), LV_COLOR_FORMAT_RGB565), chunk_rows);
+  return true;
+}
+
+// Called from the color transfer done ISR. Returns true when the last chunk of the area is sent
+bool IRAM_ATTR lvgl_pipeline_color_trans_done()
+{
+  return smartdisplay_chunks_trans_done(&pipeline_chunks);
+}
+
+#endif
@@ -0,0 +1,264 @@
+#include <esp32_smartdisplay.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_commands.h>
+#include <esp_timer.h>
+
+#ifdef BOARD_HAS_TOUCH
+#include <esp_lcd_touch.h>
+#endif
+
+// Period of the governor timer when active/dimmed and when sleeping (check for wake up)
+#define POWER_GOVERNOR_PERIOD 100
+#define POWER_GOVERNOR_SLEEP_PERIOD 10
+// Touch polling period when sleeping and no touch interrupt is available
+#define POWER_SLEEP_TOUCH_POLL_PERIOD 100
+// Time for the supply voltages and clock circuits to stabilize after SLPOUT [ms]
+#define POWER_SLEEP_OUT_DELAY 5
+
+extern lv_display_t *display;
+#ifdef BOARD_HAS_TOUCH
+extern lv_indev_t *indev;
+#endif
+extern lv_timer_t *update_brightness_timer;
+extern float backlight_duty;
+
+smartdisplay_power_config_t power_config;
+smartdisplay_power_stats_t power_stats;
+lv_timer_t *power_governor_timer;
+
+// Values to restore when returning to active
+float power_active_backlight_duty;
+uint32_t power_active_refr_period;
+uint32_t power_active_touch_period;
+// Set by the touch interrupt when sleeping
+volatile bool power_wake_requested;
+volatile int64_t power_wake_request_time;
+int64_t power_state_enter_time;
+// One shot timer to finish the wake up after SLPOUT
+lv_timer_t *power_wake_timer;
+int64_t power_wake_start_time;
+
+#ifdef BOARD_HAS_TOUCH
+void IRAM_ATTR power_touch_interrupt(esp_lcd_touch_handle_t touch_handle)
+{
+  if (!power_wake_requested)
+  {
+    power_wake_request_time = esp_timer_get_time();
+    power_wake_requested = true;
+  }
+}
+
+bool power_touch_has_interrupt()
+{
+  const esp_lcd_touch_handle_t touch_handle = indev->user_data;
+  return touch_handle->config.int_gpio_num != GPIO_NUM_NC;
+}
+#endif
+
+void power_set_state(smartdisplay_power_state_t state)
+{
+  const int64_t now = esp_timer_get_time();
+  power_stats.state_time_us[power_stats.state] += now - power_state_enter_time;
+  power_state_enter_time = now;
+  power_stats.state = state;
+}
+
+void power_panel_sleep()
+{
+  const esp_lcd_panel_handle_t panel_handle = display->user_data;
+  const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+  ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_panel_disp_on_off(panel_handle, false));
+  // Direct RGB panels have no command interface
+  if (io_handle != NULL)
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_SLPIN, NULL, 0));
+}
+
+void power_dim()
+{
+  log_d("Dimming display");
+  power_active_backlight_duty = backlight_duty;
+  power_active_refr_period = display->refr_timer->period;
+  if (update_brightness_timer != NULL)
+    lv_timer_pause(update_brightness_timer);
+
+  smartdisplay_lcd_set_backlight(power_active_backlight_duty * power_config.dim_brightness);
+  lv_timer_set_period(display->refr_timer, power_config.dim_refr_period);
+  power_set_state(SMARTDISPLAY_POWER_DIMMED);
+}
+
+void power_sleep()
+{
+  log_d("Display to sleep");
+  if (power_stats.state == SMARTDISPLAY_POWER_ACTIVE)
+    power_dim();
+
+  smartdisplay_lcd_set_backlight(0.0f);
+  lv_timer_pause(display->refr_timer);
+  power_panel_sleep();
+
+#ifdef BOARD_HAS_TOUCH
+  power_active_touch_period = indev->read_timer->period;
+  if (power_config.touch_sleep)
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_touch_enter_sleep(indev->user_data));
+
+  if (power_touch_has_interrupt())
+  {
+    // Stop polling, wait for the interrupt
+    lv_timer_pause(indev->read_timer);
+    power_wake_requested = false;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_touch_register_interrupt_callback(indev->user_data, power_touch_interrupt));
+  }
+  else
+    lv_timer_set_period(indev->read_timer, POWER_SLEEP_TOUCH_POLL_PERIOD);
+#endif
+
+  lv_timer_set_period(power_governor_timer, POWER_GOVERNOR_SLEEP_PERIOD);
+  power_set_state(SMARTDISPLAY_POWER_SLEEP);
+}
+
+// Second part of the wake up, after the panel left the sleep mode
+void power_wake_finish(lv_timer_t *timer)
+{
+  power_wake_timer = NULL;
+  if (power_stats.state == SMARTDISPLAY_POWER_SLEEP)
+  {
+    const esp_lcd_panel_handle_t panel_handle = display->user_data;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_panel_disp_on_off(panel_handle, true));
+    lv_timer_resume(display->refr_timer);
+    if (power_governor_timer != NULL)
+      lv_timer_set_period(power_governor_timer, POWER_GOVERNOR_PERIOD);
+  }
+
+  lv_timer_set_period(display->refr_timer, power_active_refr_period);
+  // Panel RAM is retained during sleep, render the pending changes in the next lv_timer_handler
+  lv_timer_ready(display->refr_timer);
+  smartdisplay_lcd_set_backlight(power_active_backlight_duty);
+  if (update_brightness_timer != NULL)
+    lv_timer_resume(update_brightness_timer);
+
+  lv_display_trigger_activity(display);
+  power_set_state(SMARTDISPLAY_POWER_ACTIVE);
+
+  const uint32_t latency = esp_timer_get_time() - power_wake_start_time;
+  power_stats.last_wake_latency_us = latency;
+  if (latency > power_stats.max_wake_latency_us)
+    power_stats.max_wake_latency_us = latency;
+
+  power_stats.wakeups++;
+  log_d("Wake latency: %u us", latency);
+}
+
+void power_wake(int64_t request_time)
+{
+  log_d("Waking display");
+  // Already waking up
+  if (power_wake_timer != NULL)
+    return;
+
+  power_wake_start_time = request_time;
+  if (power_stats.state == SMARTDISPLAY_POWER_SLEEP)
+  {
+#ifdef BOARD_HAS_TOUCH
+    if (power_touch_has_interrupt())
+    {
+      ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_touch_register_interrupt_callback(indev->user_data, NULL));
+      lv_timer_resume(indev->read_timer);
+    }
+
+    if (power_config.touch_sleep)
+      ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_touch_exit_sleep(indev->user_data));
+
+    lv_timer_set_period(indev->read_timer, power_active_touch_period);
+#endif
+    const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+    if (io_handle != NULL)
+    {
+      ESP_ERROR_CHECK_WITHOUT_ABORT(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_SLPOUT, NULL, 0));
+      // Wait for the supply voltages and clock circuits to stabilize without blocking the LVGL task
+      power_wake_timer = lv_timer_create(power_wake_finish, POWER_SLEEP_OUT_DELAY, NULL);
+      lv_timer_set_repeat_count(power_wake_timer, 1);
+      return;
+    }
+  }
+
+  power_wake_finish(NULL);
+}
+
+void power_governor(lv_timer_t *timer)
+{
+  // Waiting for the panel to leave the sleep mode
+  if (power_wake_timer != NULL)
+    return;
+
+  if (power_stats.state != SMARTDISPLAY_POWER_ACTIVE)
+  {
+    if (power_wake_requested)
+    {
+      power_wake_requested = false;
+      power_wake(power_wake_request_time);
+      return;
+    }
+
+    // Activity from polled touch input
+    if (lv_display_get_inactive_time(display) < (power_config.dim_timeout ? power_config.dim_timeout : power_config.sleep_timeout))
+    {
+      power_wake(esp_timer_get_time());
+      return;
+    }
+  }
+
+  const uint32_t inactive = lv_display_get_inactive_time(display);
+  if (power_config.sleep_timeout > 0 && inactive >= power_config.sleep_timeout)
+  {
+    if (power_stats.state != SMARTDISPLAY_POWER_SLEEP)
+      power_sleep();
+  }
+  else if (power_config.dim_timeout > 0 && inactive >= power_config.dim_timeout)
+  {
+    if (power_stats.state == SMARTDISPLAY_POWER_ACTIVE)
+      power_dim();
+  }
+}
+
+void smartdisplay_power_set_config(const smartdisplay_power_config_t *config)
+{
+  log_v("config:0x%08x", config);
+
+  if (power_stats.state != SMARTDISPLAY_POWER_ACTIVE)
+    power_wake(esp_timer_get_time());
+
+  if (config == NULL || (config->dim_timeout == 0 && config->sleep_timeout == 0))
+  {
+    if (power_governor_timer != NULL)
+    {
+      lv_timer_delete(power_governor_timer);
+      power_governor_timer = NULL;
+    }
+
+    return;
+  }
+
+  log_d("dim_timeout:%u, sleep_timeout:%u, dim_brightness:%.2f, dim_refr_period:%u, touch_sleep:%d", config->dim_timeout, config->sleep_timeout, config->dim_brightness, config->dim_refr_period, config->touch_sleep);
+  power_config = *config;
+  if (power_governor_timer == NULL)
+  {
+    power_state_enter_time = esp_timer_get_time();
+    power_governor_timer = lv_timer_create(power_governor, POWER_GOVERNOR_PERIOD, NULL);
+  }
+}
+
+void smartdisplay_power_wake()
+{
+  if (power_stats.state != SMARTDISPLAY_POWER_ACTIVE)
+    power_wake(esp_timer_get_time());
+  else
+    lv_display_trigger_activity(display);
+}
+
+void smartdisplay_power_get_stats(smartdisplay_power_stats_t *stats)
+{
+  *stats = power_stats;
+  // Include the time in the current state
+  stats->state_time_us[power_stats.state] += esp_timer_get_time() - power_state_enter_time;
+}
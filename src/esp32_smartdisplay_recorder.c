@@ -0,0 +1,172 @@
+#include <esp32_smartdisplay.h>
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_io_interface.h>
+#include <esp_rom_crc.h>
+
+#ifdef SMARTDISPLAY_IO_RECORDER
+
+#ifndef SMARTDISPLAY_IO_RECORDER_ENTRIES
+#define SMARTDISPLAY_IO_RECORDER_ENTRIES 1024
+#endif
+
+typedef enum
+{
+  RECORDER_RX_PARAM,
+  RECORDER_TX_PARAM,
+  RECORDER_TX_COLOR
+} recorder_op_t;
+
+const char *const recorder_op_names[] = {"rx_param", "tx_param", "tx_color"};
+
+typedef struct
+{
+  uint8_t io;
+  uint8_t op;
+  int32_t cmd;
+  uint32_t size;
+  uint32_t crc; // CRC32 of the data (0 for rx_param)
+} recorder_entry_t;
+
+// Panel IO that records and forwards to the wrapped IO
+typedef struct
+{
+  esp_lcd_panel_io_t base;
+  esp_lcd_panel_io_handle_t io;
+  uint8_t id;
+} recorder_io_t;
+
+smartdisplay_io_recorder_stats_t recorder_stats;
+recorder_entry_t *recorder_entries;
+uint32_t recorder_count;
+bool recorder_running = true;
+portMUX_TYPE recorder_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void recorder_add(const recorder_io_t *recorder, recorder_op_t op, int cmd, const void *data, size_t size)
+{
+  if (!recorder_running)
+    return;
+
+  const uint32_t crc = data != NULL ? esp_rom_crc32_le(0, data, size) : 0;
+  portENTER_CRITICAL(&recorder_mux);
+  smartdisplay_io_recorder_io_stats_t *io_stats = &recorder_stats.io[recorder->id];
+  io_stats->transactions[op]++;
+  io_stats->bytes[op] += size;
+  if (recorder_entries != NULL && recorder_count < SMARTDISPLAY_IO_RECORDER_ENTRIES)
+    recorder_entries[recorder_count++] = (recorder_entry_t){.io = recorder->id, .op = op, .cmd = cmd, .size = size, .crc = crc};
+  else
+    recorder_stats.overflows++;
+
+  portEXIT_CRITICAL(&recorder_mux);
+}
+
+esp_err_t recorder_rx_param(esp_lcd_panel_io_t *io, int lcd_cmd, void *param, size_t param_size)
+{
+  const recorder_io_t *recorder = __containerof(io, recorder_io_t, base);
+  recorder_add(recorder, RECORDER_RX_PARAM, lcd_cmd, NULL, param_size);
+  return recorder->io->rx_param(recorder->io, lcd_cmd, param, param_size);
+}
+
+esp_err_t recorder_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const void *param, size_t param_size)
+{
+  const recorder_io_t *recorder = __containerof(io, recorder_io_t, base);
+  recorder_add(recorder, RECORDER_TX_PARAM, lcd_cmd, param, param_size);
+  return recorder->io->tx_param(recorder->io, lcd_cmd, param, param_size);
+}
+
+esp_err_t recorder_tx_color(esp_lcd_panel_io_t *io, int lcd_cmd, const void *color, size_t color_size)
+{
+  const recorder_io_t *recorder = __containerof(io, recorder_io_t, base);
+  recorder_add(recorder, RECORDER_TX_COLOR, lcd_cmd, color, color_size);
+  return recorder->io->tx_color(recorder->io, lcd_cmd, color, color_size);
+}
+
+esp_err_t recorder_del(esp_lcd_panel_io_t *io)
+{
+  recorder_io_t *recorder = __containerof(io, recorder_io_t, base);
+  const esp_err_t res = recorder->io->del(recorder->io);
+  free(recorder);
+  return res;
+}
+
+esp_err_t recorder_register_event_callbacks(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+  const recorder_io_t *recorder = __containerof(io, recorder_io_t, base);
+  return recorder->io->register_event_callbacks(recorder->io, cbs, user_ctx);
+}
+
+// Called by the drivers after creating the panel IO
+esp_lcd_panel_io_handle_t lvgl_io_recorder_wrap(esp_lcd_panel_io_handle_t io, const char *name)
+{
+  log_v("io:0x%08x, name:%s", io, name);
+
+  if (recorder_stats.io_count == SMARTDISPLAY_IO_RECORDER_MAX_IO)
+  {
+    log_w("Unable to record %s, too many IOs", name);
+    return io;
+  }
+
+  if (recorder_entries == NULL)
+    recorder_entries = heap_caps_malloc(SMARTDISPLAY_IO_RECORDER_ENTRIES * sizeof(recorder_entry_t), psramFound() ? MALLOC_CAP_SPIRAM : MALLOC_CAP_DEFAULT);
+
+  recorder_io_t *recorder = calloc(1, sizeof(recorder_io_t));
+  recorder->io = io;
+  recorder->id = recorder_stats.io_count;
+  recorder->base.rx_param = recorder_rx_param;
+  recorder->base.tx_param = recorder_tx_param;
+  recorder->base.tx_color = recorder_tx_color;
+  recorder->base.del = recorder_del;
+  recorder->base.register_event_callbacks = recorder_register_event_callbacks;
+  recorder_stats.io[recorder->id].name = name;
+  recorder_stats.io_count++;
+  return &recorder->base;
+}
+
+#endif
+
+void smartdisplay_io_recorder_start()
+{
+#ifdef SMARTDISPLAY_IO_RECORDER
+  portENTER_CRITICAL(&recorder_mux);
+  recorder_count = 0;
+  recorder_stats.overflows = 0;
+  for (uint8_t i = 0; i < recorder_stats.io_count; i++)
+  {
+    memset(recorder_stats.io[i].transactions, 0, sizeof(recorder_stats.io[i].transactions));
+    memset(recorder_stats.io[i].bytes, 0, sizeof(recorder_stats.io[i].bytes));
+  }
+
+  recorder_running = true;
+  portEXIT_CRITICAL(&recorder_mux);
+#endif
+}
+
+void smartdisplay_io_recorder_stop()
+{
+#ifdef SMARTDISPLAY_IO_RECORDER
+  recorder_running = false;
+#endif
+}
+
+void smartdisplay_io_recorder_dump()
+{
+#ifdef SMARTDISPLAY_IO_RECORDER
+  // Text format for tools/smartdisplay_io_diff.py
+  log_printf("# io_recorder entries:%u overflows:%u\n", recorder_count, recorder_stats.overflows);
+  for (uint32_t i = 0; i < recorder_count; i++)
+  {
+    const recorder_entry_t *entry = &recorder_entries[i];
+    log_printf("%s %s 0x%02x %u 0x%08x\n", recorder_stats.io[entry->io].name, recorder_op_names[entry->op], entry->cmd, entry->size, entry->crc);
+  }
+
+  log_printf("# end\n");
+#endif
+}
+
+void smartdisplay_io_recorder_get_stats(smartdisplay_io_recorder_stats_t *stats)
+{
+#ifdef SMARTDISPLAY_IO_RECORDER
+  *stats = recorder_stats;
+#else
+  memset(stats, 0, sizeof(smartdisplay_io_recorder_stats_t));
+#endif
+}
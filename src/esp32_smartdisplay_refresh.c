@@ -0,0 +1,97 @@
+#include <esp32_smartdisplay.h>
+
+// Interval of the governor [ms]
+#define REFRESH_GOVERNOR_PERIOD 50
+// Keep the fast refresh after the last input [ms] (covers scroll throw after release)
+#define REFRESH_INTERACTION_HOLD 1000
+// Invalidated screen fraction per governor interval that requires the fastest refresh
+#define REFRESH_FULL_LOAD_FRACTION 0.25f
+
+extern lv_display_t *display;
+extern smartdisplay_power_stats_t power_stats;
+
+smartdisplay_refresh_stats_t refresh_stats;
+lv_timer_t *refresh_governor_timer;
+uint32_t refresh_invalidated_area;
+// Period of the refresh timer before the governor was enabled
+uint32_t refresh_saved_period;
+
+void refresh_invalidate_area_callback(lv_event_t *event)
+{
+  const lv_area_t *area = lv_event_get_param(event);
+  refresh_invalidated_area += lv_area_get_size(area);
+}
+
+void refresh_set_period(uint32_t period)
+{
+  if (period == refresh_stats.period)
+    return;
+
+  log_v("period:%u", period);
+  lv_timer_set_period(display->refr_timer, period);
+  refresh_stats.period = period;
+  refresh_stats.changes++;
+}
+
+void refresh_governor(lv_timer_t *timer)
+{
+  refresh_stats.invalidated_area = refresh_invalidated_area;
+  refresh_invalidated_area = 0;
+  refresh_stats.animating = lv_anim_count_running() > 0;
+
+  // The power governor owns the refresh period when not active
+  if (power_stats.state != SMARTDISPLAY_POWER_ACTIVE)
+    return;
+
+  uint32_t target;
+  if (refresh_stats.animating || lv_display_get_inactive_time(display) < REFRESH_INTERACTION_HOLD)
+    target = refresh_stats.min_period;
+  else
+  {
+    // Scale between the slowest and fastest refresh with the invalidated area
+    const float load = (float)refresh_stats.invalidated_area / (lv_display_get_horizontal_resolution(display) * lv_display_get_vertical_resolution(display) * REFRESH_FULL_LOAD_FRACTION);
+    target = load >= 1.0f ? refresh_stats.min_period : refresh_stats.max_period - load * (refresh_stats.max_period - refresh_stats.min_period);
+  }
+
+  // Speed up immediately, slow down gradually to prevent oscillating
+  if (target > refresh_stats.period)
+    target = refresh_stats.period + (target - refresh_stats.period + 3) / 4;
+
+  refresh_set_period(target);
+}
+
+void smartdisplay_refresh_set_bounds(uint32_t min_period, uint32_t max_period)
+{
+  log_v("min_period:%u, max_period:%u", min_period, max_period);
+
+  const bool enable = min_period > 0 && max_period >= min_period;
+  if (refresh_governor_timer != NULL)
+  {
+    lv_timer_delete(refresh_governor_timer);
+    refresh_governor_timer = NULL;
+    lv_display_remove_event_cb_with_user_data(display, refresh_invalidate_area_callback, NULL);
+    if (!enable)
+    {
+      // Restore the period from before the governor
+      lv_timer_set_period(display->refr_timer, refresh_saved_period);
+      refresh_stats.period = refresh_saved_period;
+    }
+  }
+  else if (enable)
+    refresh_saved_period = display->refr_timer->period;
+
+  if (!enable)
+    return;
+
+  refresh_stats.min_period = min_period;
+  refresh_stats.max_period = max_period;
+  refresh_stats.period = display->refr_timer->period;
+  refresh_invalidated_area = 0;
+  lv_display_add_event_cb(display, refresh_invalidate_area_callback, LV_EVENT_INVALIDATE_AREA, NULL);
+  refresh_governor_timer = lv_timer_create(refresh_governor, REFRESH_GOVERNOR_PERIOD, NULL);
+}
+
+void smartdisplay_refresh_get_stats(smartdisplay_refresh_stats_t *stats)
+{
+  *stats = refresh_stats;
+}
@@ -0,0 +1,163 @@
+#include <esp32_smartdisplay.h>
+
+#if defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR)
+
+#include <esp_idf_version.h>
+#include <esp_timer.h>
+#include <esp_lcd_panel_rgb.h>
+
+#ifdef DISPLAY_ST7701_PAR
+#define RGB_PCLK_HZ ST7701_PANEL_CONFIG_TIMINGS_PCLK_HZ
+#define RGB_H_TOTAL (ST7701_PANEL_CONFIG_TIMINGS_H_RES + ST7701_PANEL_CONFIG_TIMINGS_HSYNC_PULSE_WIDTH + ST7701_PANEL_CONFIG_TIMINGS_HSYNC_BACK_PORCH + ST7701_PANEL_CONFIG_TIMINGS_HSYNC_FRONT_PORCH)
+#define RGB_V_TOTAL (ST7701_PANEL_CONFIG_TIMINGS_V_RES + ST7701_PANEL_CONFIG_TIMINGS_VSYNC_PULSE_WIDTH + ST7701_PANEL_CONFIG_TIMINGS_VSYNC_BACK_PORCH + ST7701_PANEL_CONFIG_TIMINGS_VSYNC_FRONT_PORCH)
+#ifdef ST7701_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+#define RGB_BOUNCE_BUFFER_SIZE_PX ST7701_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+#endif
+#else
+#define RGB_PCLK_HZ ST7262_PANEL_CONFIG_TIMINGS_PCLK_HZ
+#define RGB_H_TOTAL (ST7262_PANEL_CONFIG_TIMINGS_H_RES + ST7262_PANEL_CONFIG_TIMINGS_HSYNC_PULSE_WIDTH + ST7262_PANEL_CONFIG_TIMINGS_HSYNC_BACK_PORCH + ST7262_PANEL_CONFIG_TIMINGS_HSYNC_FRONT_PORCH)
+#define RGB_V_TOTAL (ST7262_PANEL_CONFIG_TIMINGS_V_RES + ST7262_PANEL_CONFIG_TIMINGS_VSYNC_PULSE_WIDTH + ST7262_PANEL_CONFIG_TIMINGS_VSYNC_BACK_PORCH + ST7262_PANEL_CONFIG_TIMINGS_VSYNC_FRONT_PORCH)
+#ifdef ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+#define RGB_BOUNCE_BUFFER_SIZE_PX ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+#endif
+#endif
+
+#ifndef RGB_BOUNCE_BUFFER_SIZE_PX
+#define RGB_BOUNCE_BUFFER_SIZE_PX 0
+#endif
+
+#if RGB_BOUNCE_BUFFER_SIZE_PX > 0 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+#error "The bounce buffer (PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX) requires ESP-IDF 5.1 (Arduino 3)"
+#endif
+
+// Time of one frame at the pixel clock [us], also used by the vsync flip
+uint32_t rgb_frame_period_us;
+
+#if RGB_BOUNCE_BUFFER_SIZE_PX > 0
+// Interval for restarting the transmission after an underrun [ms]
+#define RGB_RESTART_CHECK_PERIOD 100
+
+extern lv_display_t *display;
+extern esp_lcd_panel_handle_t rgb_panel_handle;
+
+// Time of sending one bounce buffer [us]. A refill that is later by this time sends stale pixels
+uint32_t rgb_late_us;
+// Written by the vsync and bounce buffer interrupts of the RGB panel, these do not interrupt each other
+int64_t rgb_vsync_us;
+// Shortest time from the vsync to the refill of the last bounce buffer of the frame: the refill in time [us]
+uint32_t rgb_refill_us;
+uint32_t rgb_restarted_underruns;
+#endif
+
+#endif
+
+smartdisplay_rgb_stats_t rgb_stats;
+
+#if defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR)
+
+void rgb_set_timing(uint32_t pclk_hz)
+{
+  rgb_stats.pclk_hz = pclk_hz;
+  rgb_frame_period_us = (uint64_t)RGB_H_TOTAL * RGB_V_TOTAL * 1000000 / pclk_hz;
+  log_d("pclk_hz: %u, frame_period_us: %u", pclk_hz, rgb_frame_period_us);
+#if RGB_BOUNCE_BUFFER_SIZE_PX > 0
+  rgb_late_us = (uint64_t)RGB_BOUNCE_BUFFER_SIZE_PX * 1000000 / pclk_hz;
+  rgb_vsync_us = 0;
+  rgb_refill_us = UINT32_MAX;
+  log_d("late_us: %u", rgb_late_us);
+#endif
+}
+
+#if RGB_BOUNCE_BUFFER_SIZE_PX > 0
+
+void rgb_restart_timer_cb(lv_timer_t *timer)
+{
+  // The refill position of the bounce buffers is not synchronized with the GDMA, a late refill shifts the image until restarted
+  if (rgb_stats.underruns == rgb_restarted_underruns)
+    return;
+
+  rgb_restarted_underruns = rgb_stats.underruns;
+  if (esp_lcd_rgb_panel_restart(rgb_panel_handle) == ESP_OK)
+    rgb_stats.restarts++;
+}
+
+// Called by the RGB drivers when the last bounce buffer of the frame is refilled (ISR)
+bool IRAM_ATTR lvgl_rgb_bounce_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+  if (rgb_vsync_us == 0)
+    return false;
+
+  // The refill has a fixed phase to the vsync, later than one bounce buffer the GDMA has sent stale pixels
+  const uint32_t refill_us = (esp_timer_get_time() - rgb_vsync_us) % rgb_frame_period_us;
+  if (refill_us < rgb_refill_us)
+    rgb_refill_us = refill_us;
+  else if (refill_us > rgb_refill_us + rgb_late_us)
+    rgb_stats.underruns++;
+
+  return false;
+}
+#endif
+
+void lvgl_rgb_bounce_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  rgb_stats.bounce_buffer_size_px = RGB_BOUNCE_BUFFER_SIZE_PX;
+  rgb_set_timing(RGB_PCLK_HZ);
+#if RGB_BOUNCE_BUFFER_SIZE_PX > 0
+  lv_timer_create(rgb_restart_timer_cb, RGB_RESTART_CHECK_PERIOD, NULL);
+#endif
+}
+
+// Called by the RGB drivers for every frame (ISR)
+void IRAM_ATTR lvgl_rgb_bounce_frame_done()
+{
+#if RGB_BOUNCE_BUFFER_SIZE_PX > 0
+  rgb_vsync_us = esp_timer_get_time();
+#endif
+  rgb_stats.frames++;
+}
+
+#endif
+
+void smartdisplay_rgb_get_stats(smartdisplay_rgb_stats_t *stats)
+{
+  *stats = rgb_stats;
+}
+
+uint32_t smartdisplay_rgb_find_pclk(uint32_t min_hz, uint32_t max_hz, uint32_t step_hz, uint32_t duration)
+{
+  log_v("min_hz:%u, max_hz:%u, step_hz:%u, duration:%u", min_hz, max_hz, step_hz, duration);
+
+#if (defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR)) && RGB_BOUNCE_BUFFER_SIZE_PX > 0
+  smartdisplay_benchmark_result_t result;
+  uint32_t pclk_hz = max_hz;
+  for (;;)
+  {
+    ESP_ERROR_CHECK(esp_lcd_rgb_panel_set_pclk(rgb_panel_handle, pclk_hz));
+    rgb_set_timing(pclk_hz);
+    // The new clock is used from the next frame, the phase of the refill is measured in the frames after
+    vTaskDelay(pdMS_TO_TICKS(4 * rgb_frame_period_us / 1000 + 1));
+    const uint32_t underruns = rgb_stats.underruns;
+    // Full screen updates, the most PSRAM traffic next to the scan out
+    smartdisplay_benchmark_run(SMARTDISPLAY_BENCHMARK_SCROLL, duration, &result);
+    log_i("pclk_hz: %u, underruns: %u, fps: %.1f", pclk_hz, rgb_stats.underruns - underruns, result.fps);
+    if (rgb_stats.underruns == underruns)
+      return pclk_hz;
+
+    if (step_hz == 0 || pclk_hz < min_hz + step_hz)
+      break;
+
+    pclk_hz -= step_hz;
+  }
+
+  log_w("No stable pixel clock found, using %u Hz", min_hz);
+  ESP_ERROR_CHECK(esp_lcd_rgb_panel_set_pclk(rgb_panel_handle, min_hz));
+  rgb_set_timing(min_hz);
+  return min_hz;
+#else
+  // Underruns are only detected with a bounce buffer
+  log_w("Requires an RGB panel with a bounce buffer");
+  return 0;
+#endif
+}
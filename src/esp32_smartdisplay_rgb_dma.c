@@ -0,0 +1,177 @@
+#include <esp32_smartdisplay.h>
+
+#ifdef SMARTDISPLAY_RGB_DMA_COPY
+
+#if !defined(DISPLAY_ST7701_PAR) && !defined(DISPLAY_ST7262_PAR)
+#error "SMARTDISPLAY_RGB_DMA_COPY is only supported for RGB panels"
+#endif
+
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR < 5
+#error "SMARTDISPLAY_RGB_DMA_COPY requires ESP-IDF 5 (Arduino 3)"
+#endif
+
+#include <esp_async_memcpy.h>
+#include <esp_lcd_panel_rgb.h>
+#include <esp_memory_utils.h>
+#include <esp32s3/rom/cache.h>
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+typedef async_memcpy_handle_t rgb_dma_handle_t;
+#else
+typedef async_memcpy_t rgb_dma_handle_t;
+#endif
+
+// Number of copies (rows) queued at the same time, the next row is queued from the copy done ISR
+#ifndef SMARTDISPLAY_RGB_DMA_BACKLOG
+#define SMARTDISPLAY_RGB_DMA_BACKLOG 8
+#endif
+
+// Alignment [bytes] of the GDMA writes into PSRAM. The areas are rounded to this alignment
+#ifndef SMARTDISPLAY_RGB_DMA_ALIGN
+#define SMARTDISPLAY_RGB_DMA_ALIGN 64
+#endif
+
+#define RGB_DMA_ALIGN_PIXELS (SMARTDISPLAY_RGB_DMA_ALIGN / sizeof(uint16_t))
+
+extern lv_display_t *display;
+extern esp_lcd_panel_handle_t rgb_panel_handle;
+
+rgb_dma_handle_t rgb_dma_handle;
+uint16_t *rgb_dma_frame_buffer;
+// Copies of the area being flushed, shared with the copy done ISR
+portMUX_TYPE rgb_dma_lock = portMUX_INITIALIZER_UNLOCKED;
+uint16_t *rgb_dma_dest;
+const uint8_t *rgb_dma_src;
+size_t rgb_dma_copy_bytes;
+size_t rgb_dma_dest_stride;
+uint32_t rgb_dma_copies;
+uint32_t rgb_dma_queued;
+uint32_t rgb_dma_completed;
+// Copies that could not be queued (reported at the next flush)
+volatile uint32_t rgb_dma_errors;
+
+bool rgb_dma_copy_done(rgb_dma_handle_t handle, async_memcpy_event_t *event, void *user_ctx);
+
+void IRAM_ATTR rgb_dma_complete()
+{
+  portENTER_CRITICAL_SAFE(&rgb_dma_lock);
+  const bool ready = ++rgb_dma_completed == rgb_dma_copies;
+  portEXIT_CRITICAL_SAFE(&rgb_dma_lock);
+  if (ready)
+    lv_display_flush_ready(display);
+}
+
+// Queue the next copy of the area, from the flush or the copy done ISR
+void IRAM_ATTR rgb_dma_queue_next()
+{
+  portENTER_CRITICAL_SAFE(&rgb_dma_lock);
+  const uint32_t copy = rgb_dma_queued;
+  if (copy < rgb_dma_copies)
+    rgb_dma_queued++;
+  portEXIT_CRITICAL_SAFE(&rgb_dma_lock);
+  if (copy >= rgb_dma_copies)
+    return;
+
+  // The backlog has a free slot for every queued copy, so this only fails on invalid arguments. The row is then skipped
+  if (esp_async_memcpy(rgb_dma_handle, rgb_dma_dest + copy * rgb_dma_dest_stride, (void *)(rgb_dma_src + copy * rgb_dma_copy_bytes), rgb_dma_copy_bytes, rgb_dma_copy_done, NULL) != ESP_OK)
+  {
+    rgb_dma_errors++;
+    rgb_dma_complete();
+  }
+}
+
+bool IRAM_ATTR rgb_dma_copy_done(rgb_dma_handle_t handle, async_memcpy_event_t *event, void *user_ctx)
+{
+  rgb_dma_queue_next();
+  rgb_dma_complete();
+  return false;
+}
+
+// Round the invalidated areas so the rows in the frame buffer are aligned for the GDMA
+void rgb_dma_round_area(lv_event_t *event)
+{
+  if (display->rotation != LV_DISPLAY_ROTATION_0)
+    return;
+
+  lv_area_t *area = lv_event_get_param(event);
+  area->x1 &= ~(RGB_DMA_ALIGN_PIXELS - 1);
+  area->x2 = LV_MIN(area->x2 | (RGB_DMA_ALIGN_PIXELS - 1), lv_display_get_horizontal_resolution(display) - 1);
+}
+
+void lvgl_rgb_dma_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  ESP_ERROR_CHECK(esp_lcd_rgb_panel_get_frame_buffer(rgb_panel_handle, 1, (void **)&rgb_dma_frame_buffer));
+
+  async_memcpy_config_t async_memcpy_config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+  // One extra slot for the copy queued from the copy done ISR before its own slot is released
+  async_memcpy_config.backlog = SMARTDISPLAY_RGB_DMA_BACKLOG + 1;
+  async_memcpy_config.sram_trans_align = sizeof(uint32_t);
+  async_memcpy_config.psram_trans_align = SMARTDISPLAY_RGB_DMA_ALIGN;
+  log_d("async_memcpy_config: backlog:%d, sram_trans_align:%d, psram_trans_align:%d, flags:0x%08x", async_memcpy_config.backlog, async_memcpy_config.sram_trans_align, async_memcpy_config.psram_trans_align, async_memcpy_config.flags);
+  if (esp_async_memcpy_install(&async_memcpy_config, &rgb_dma_handle) != ESP_OK)
+  {
+    log_e("Unable to install the async memcpy, using the CPU to copy");
+    rgb_dma_handle = NULL;
+    return;
+  }
+
+  lv_display_add_event_cb(display, rgb_dma_round_area, LV_EVENT_INVALIDATE_AREA, NULL);
+}
+
+// Called by the RGB flush when not rotated. Returns false if the area must be copied by the CPU
+bool lvgl_rgb_dma_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  if (rgb_dma_handle == NULL || !esp_ptr_dma_capable(px_map))
+    return false;
+
+  const int32_t hor_res = lv_display_get_horizontal_resolution(display);
+  const int32_t width = lv_area_get_width(area);
+  const int32_t rows = lv_area_get_height(area);
+  const size_t row_bytes = width * sizeof(uint16_t);
+  // Areas invalidated before the rounding or rotating
+  if ((area->x1 * sizeof(uint16_t)) % SMARTDISPLAY_RGB_DMA_ALIGN != 0 || row_bytes % SMARTDISPLAY_RGB_DMA_ALIGN != 0)
+    return false;
+
+  if (rgb_dma_errors > 0)
+  {
+    log_w("%d rows could not be copied by the GDMA", rgb_dma_errors);
+    rgb_dma_errors = 0;
+  }
+
+  uint16_t *dest = rgb_dma_frame_buffer + area->y1 * hor_res + area->x1;
+  // Write back the lines written by the CPU (rotated flush) before the GDMA overwrites them and drop them so the CPU
+  // reads the copied pixels
+  const uint32_t dest_bytes = ((rows - 1) * hor_res + width) * sizeof(uint16_t);
+  Cache_WriteBack_Addr((uint32_t)dest, dest_bytes);
+  Cache_Invalidate_Addr((uint32_t)dest, dest_bytes);
+
+  // One copy if the area is contiguous (full width), otherwise one per row
+  portENTER_CRITICAL(&rgb_dma_lock);
+  rgb_dma_dest = dest;
+  rgb_dma_src = px_map;
+  rgb_dma_copy_bytes = width == hor_res ? rows * row_bytes : row_bytes;
+  rgb_dma_dest_stride = hor_res;
+  rgb_dma_copies = width == hor_res ? 1 : rows;
+  rgb_dma_queued = rgb_dma_completed = 0;
+  portEXIT_CRITICAL(&rgb_dma_lock);
+
+  // Fill the backlog, the copy done ISR queues the remaining rows
+  for (uint32_t i = 0; i < SMARTDISPLAY_RGB_DMA_BACKLOG; i++)
+    rgb_dma_queue_next();
+
+  return true;
+}
+
+// Called from the frame done ISR. The flush is ready when the copy is complete
+bool IRAM_ATTR lvgl_rgb_dma_pending()
+{
+  portENTER_CRITICAL_ISR(&rgb_dma_lock);
+  const bool pending = rgb_dma_completed < rgb_dma_copies;
+  portEXIT_CRITICAL_ISR(&rgb_dma_lock);
+  return pending;
+}
+
+#endif
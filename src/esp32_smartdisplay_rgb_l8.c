@@ -0,0 +1,109 @@
+#include <esp32_smartdisplay.h>
+
+#if defined(SMARTDISPLAY_RENDER_L8) && (defined(DISPLAY_ST7701_PAR) || defined(DISPLAY_ST7262_PAR))
+
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+#error "SMARTDISPLAY_RENDER_L8 on RGB panels requires ESP-IDF 5.1 (Arduino 3)"
+#endif
+
+#if defined(SMARTDISPLAY_RGB_DMA_COPY) || defined(SMARTDISPLAY_RGB_VSYNC)
+#error "SMARTDISPLAY_RENDER_L8 on RGB panels can not be combined with SMARTDISPLAY_RGB_DMA_COPY or SMARTDISPLAY_RGB_VSYNC"
+#endif
+
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_rgb.h>
+
+#ifdef DISPLAY_ST7701_PAR
+#define RGB_L8_BOUNCE_BUFFER_SIZE_PX ST7701_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+#else
+#define RGB_L8_BOUNCE_BUFFER_SIZE_PX ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+#endif
+
+#if !defined(ST7701_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX) && !defined(ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX)
+#error "SMARTDISPLAY_RENDER_L8 on RGB panels requires a bounce buffer (PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX)"
+#endif
+
+#if RGB_L8_BOUNCE_BUFFER_SIZE_PX % 4 != 0
+#error "The bounce buffer size (PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX) must be a multiple of 4 pixels"
+#endif
+
+extern uint16_t l8_lut[256];
+
+// Frame buffer with one byte per pixel, the panel has no frame buffer
+uint8_t *rgb_l8_frame_buffer;
+
+// Registered by the RGB drivers. Fill the bounce buffer from the 8 bit frame buffer (ISR)
+bool IRAM_ATTR lvgl_rgb_l8_bounce_empty(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx)
+{
+  // Scanned out before the frame buffer is allocated
+  if (rgb_l8_frame_buffer == NULL)
+  {
+    memset(bounce_buf, 0, len_bytes);
+    return false;
+  }
+
+  // 4 pixels per 32 bit read from PSRAM and 2 x 32 bit writes
+  const uint32_t *src = (const uint32_t *)(rgb_l8_frame_buffer + pos_px);
+  uint32_t *dest = bounce_buf;
+  for (int32_t i = len_bytes / (4 * sizeof(uint16_t)); i > 0; i--)
+  {
+    const uint32_t pixels = *src++;
+    *dest++ = l8_lut[pixels & 0xff] | (uint32_t)l8_lut[(pixels >> 8) & 0xff] << 16;
+    *dest++ = l8_lut[(pixels >> 16) & 0xff] | (uint32_t)l8_lut[pixels >> 24] << 16;
+  }
+
+  return false;
+}
+
+void lvgl_rgb_l8_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  rgb_l8_frame_buffer = heap_caps_calloc(DISPLAY_WIDTH * DISPLAY_HEIGHT, sizeof(uint8_t), MALLOC_CAP_SPIRAM);
+  assert(rgb_l8_frame_buffer != NULL);
+}
+
+// Called by the RGB flush. Copies the area into the 8 bit frame buffer
+void lvgl_rgb_l8_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  const int32_t width = lv_area_get_width(area);
+  const uint32_t stride = lv_draw_buf_width_to_stride(width, LV_COLOR_FORMAT_L8);
+  const lv_display_rotation_t rotation = lv_display_get_rotation(display);
+  if (rotation == LV_DISPLAY_ROTATION_0)
+  {
+    for (int32_t y = area->y1; y <= area->y2; y++)
+      memcpy(rgb_l8_frame_buffer + y * DISPLAY_WIDTH + area->x1, px_map + (y - area->y1) * stride, width);
+
+    return;
+  }
+
+  // Rotated, one byte per pixel
+  for (int32_t y = area->y1; y <= area->y2; y++)
+  {
+    const uint8_t *src = px_map + (y - area->y1) * stride;
+    for (int32_t x = area->x1; x <= area->x2; x++)
+    {
+      int32_t panel_x, panel_y;
+      switch (rotation)
+      {
+      case LV_DISPLAY_ROTATION_90:
+        panel_x = y;
+        panel_y = DISPLAY_HEIGHT - 1 - x;
+        break;
+      case LV_DISPLAY_ROTATION_180:
+        panel_x = DISPLAY_WIDTH - 1 - x;
+        panel_y = DISPLAY_HEIGHT - 1 - y;
+        break;
+      default:
+        panel_x = DISPLAY_WIDTH - 1 - y;
+        panel_y = x;
+        break;
+      }
+
+      rgb_l8_frame_buffer[panel_y * DISPLAY_WIDTH + panel_x] = src[x - area->x1];
+    }
+  }
+}
+
+#endif
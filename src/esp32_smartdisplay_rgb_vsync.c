@@ -0,0 +1,145 @@
+#include <esp32_smartdisplay.h>
+
+#ifdef SMARTDISPLAY_RGB_VSYNC
+
+#if !defined(DISPLAY_ST7701_PAR) && !defined(DISPLAY_ST7262_PAR)
+#error "SMARTDISPLAY_RGB_VSYNC is only supported for RGB panels"
+#endif
+
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+#error "SMARTDISPLAY_RGB_VSYNC requires ESP-IDF 5.1 (Arduino 3)"
+#endif
+
+#if defined(SMARTDISPLAY_RGB_DMA_COPY) || defined(SMARTDISPLAY_BUFFER_TUNE)
+#error "SMARTDISPLAY_RGB_VSYNC renders in the frame buffers and can not be combined with SMARTDISPLAY_RGB_DMA_COPY or SMARTDISPLAY_BUFFER_TUNE"
+#endif
+
+#include <esp_timer.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_rgb.h>
+
+// Interval for locking the refresh timer to the panel refresh [ms]
+#define VSYNC_LOCK_PERIOD 1000
+
+extern lv_display_t *display;
+extern smartdisplay_power_stats_t power_stats;
+extern uint32_t rgb_frame_period_us;
+extern esp_lcd_panel_handle_t rgb_panel_handle;
+
+SemaphoreHandle_t vsync_semaphore;
+// Set when a frame buffer is handed to the panel, cleared by the vsync that starts scanning it out
+volatile bool vsync_present_pending;
+int64_t vsync_refresh_start_us;
+// Start of the refresh and the flush of the frame waiting for the vsync
+volatile int64_t vsync_frame_refresh_start_us;
+volatile int64_t vsync_frame_present_us;
+
+#endif
+
+smartdisplay_vsync_stats_t vsync_stats;
+
+#ifdef SMARTDISPLAY_RGB_VSYNC
+
+void vsync_refresh_start(lv_event_t *event)
+{
+  vsync_refresh_start_us = esp_timer_get_time();
+}
+
+// The frame buffers are presented as a whole, a rotated flush would get the full frame buffer as the area
+void vsync_resolution_changed(lv_event_t *event)
+{
+  if (display->rotation == LV_DISPLAY_ROTATION_0)
+    return;
+
+  log_e("SMARTDISPLAY_RGB_VSYNC does not support rotation");
+  lv_display_set_rotation(display, LV_DISPLAY_ROTATION_0);
+}
+
+void vsync_lock_timer_cb(lv_timer_t *timer)
+{
+  vsync_stats.period_us = rgb_frame_period_us;
+  // The power governor owns the refresh period when not active
+  if (rgb_frame_period_us == 0 || power_stats.state != SMARTDISPLAY_POWER_ACTIVE)
+    return;
+
+  // Slightly faster than the panel, so a refresh is ready for (almost) every vsync
+  lv_timer_set_period(display->refr_timer, LV_MAX(1, rgb_frame_period_us / 1000));
+}
+
+void lvgl_rgb_vsync_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  // Render directly in the two frame buffers of the panel
+  void *frame_buffers[2];
+  ESP_ERROR_CHECK(esp_lcd_rgb_panel_get_frame_buffer(rgb_panel_handle, 2, &frame_buffers[0], &frame_buffers[1]));
+  heap_caps_free(display->buf_1->data);
+  const lv_color_format_t cf = lv_display_get_color_format(display);
+  lv_display_set_buffers(display, frame_buffers[0], frame_buffers[1], DISPLAY_WIDTH * DISPLAY_HEIGHT * lv_color_format_get_size(cf), LV_DISPLAY_RENDER_MODE_DIRECT);
+
+  vsync_semaphore = xSemaphoreCreateBinary();
+  assert(vsync_semaphore != NULL);
+
+  lv_display_add_event_cb(display, vsync_refresh_start, LV_EVENT_REFR_START, NULL);
+  lv_display_add_event_cb(display, vsync_resolution_changed, LV_EVENT_RESOLUTION_CHANGED, NULL);
+  lv_timer_create(vsync_lock_timer_cb, VSYNC_LOCK_PERIOD, NULL);
+}
+
+// Called by the RGB flush. Returns true if the area is handled
+bool lvgl_rgb_vsync_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  // The areas are rendered in the frame buffer, LVGL copies them to the other buffer
+  if (!lv_display_flush_is_last(display))
+  {
+    lv_display_flush_ready(display);
+    return true;
+  }
+
+  // Scan out this frame buffer from the next vsync, the flush is ready when the other one is released
+  vsync_frame_refresh_start_us = vsync_refresh_start_us;
+  vsync_frame_present_us = esp_timer_get_time();
+  vsync_present_pending = true;
+  const esp_lcd_panel_handle_t panel_handle = display->user_data;
+  ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, px_map));
+  return true;
+}
+
+// Called from the frame done (vsync) ISR. Returns true when the presented frame buffer is scanned out
+bool IRAM_ATTR lvgl_rgb_vsync_frame_done()
+{
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  xSemaphoreGiveFromISR(vsync_semaphore, &higher_priority_task_woken);
+  if (higher_priority_task_woken)
+    portYIELD_FROM_ISR();
+
+  if (!vsync_present_pending)
+    return false;
+
+  vsync_present_pending = false;
+  const int64_t now = esp_timer_get_time();
+  const uint32_t latency = now - vsync_frame_refresh_start_us;
+  vsync_stats.latency_us = latency;
+  vsync_stats.latency_max_us = LV_MAX(vsync_stats.latency_max_us, latency);
+  vsync_stats.present_wait_us = now - vsync_frame_present_us;
+  vsync_stats.presented++;
+  return true;
+}
+
+#endif
+
+bool smartdisplay_rgb_wait_vsync(uint32_t timeout)
+{
+#ifdef SMARTDISPLAY_RGB_VSYNC
+  // Discard a vsync before the call
+  xSemaphoreTake(vsync_semaphore, 0);
+  return xSemaphoreTake(vsync_semaphore, pdMS_TO_TICKS(timeout)) == pdTRUE;
+#else
+  return false;
+#endif
+}
+
+void smartdisplay_vsync_get_stats(smartdisplay_vsync_stats_t *stats)
+{
+  *stats = vsync_stats;
+}
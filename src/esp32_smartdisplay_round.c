@@ -0,0 +1,114 @@
+#include <esp32_smartdisplay.h>
+
+#ifdef SMARTDISPLAY_ROUND_MASK
+
+#ifndef DISPLAY_GC9A01_SPI
+#error "SMARTDISPLAY_ROUND_MASK is only supported for the GC9A01 round panel"
+#endif
+
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+#error "SMARTDISPLAY_ROUND_MASK and SMARTDISPLAY_SHADOW_BUFFER can not be combined"
+#endif
+
+#ifndef SMARTDISPLAY_ROUND_WINDOW_COST
+#define SMARTDISPLAY_ROUND_WINDOW_COST 96
+#endif
+
+#ifdef SMARTDISPLAY_ROUND_MASK_RENDER
+extern void lvgl_invalidate_area_drop(lv_display_t *display, lv_area_t *area);
+extern void lvgl_invalidate_area_keep(lv_display_t *display, const lv_area_t *area);
+#endif
+
+// Visible pixels of every row (x2 < x1 if none). The panel is square, so the circle is the same for every rotation
+int16_t round_row_x1[DISPLAY_HEIGHT];
+int16_t round_row_x2[DISPLAY_HEIGHT];
+
+smartdisplay_window_t round_windows[DISPLAY_HEIGHT];
+
+#endif
+
+smartdisplay_window_list_t round_list;
+
+#ifdef SMARTDISPLAY_ROUND_MASK
+
+#ifdef SMARTDISPLAY_ROUND_MASK_RENDER
+// Shrink the invalidated areas to the part inside the circle, so LVGL does not render the corners
+void round_invalidate_area(lv_event_t *event)
+{
+  lv_display_t *display = lv_event_get_current_target(event);
+  lv_area_t *area = lv_event_get_param(event);
+  lv_area_t visible = {.x1 = LV_COORD_MAX, .y1 = -1, .x2 = -1, .y2 = -1};
+  for (int32_t y = area->y1; y <= area->y2; y++)
+  {
+    const int32_t x1 = LV_MAX(area->x1, round_row_x1[y]);
+    const int32_t x2 = LV_MIN(area->x2, round_row_x2[y]);
+    if (x1 > x2)
+      continue;
+
+    if (visible.y1 < 0)
+      visible.y1 = y;
+    visible.y2 = y;
+    visible.x1 = LV_MIN(visible.x1, x1);
+    visible.x2 = LV_MAX(visible.x2, x2);
+  }
+
+  if (visible.y1 < 0)
+  {
+    // Completely outside the circle
+    lvgl_invalidate_area_drop(display, area);
+    return;
+  }
+
+  *area = visible;
+  lvgl_invalidate_area_keep(display, area);
+}
+#endif
+
+void lvgl_round_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  round_list.windows = round_windows;
+  round_list.max_windows = DISPLAY_HEIGHT;
+  round_list.window_cost = SMARTDISPLAY_ROUND_WINDOW_COST;
+  smartdisplay_window_circle(DISPLAY_WIDTH, DISPLAY_HEIGHT, round_row_x1, round_row_x2);
+
+#ifdef SMARTDISPLAY_ROUND_MASK_RENDER
+  lv_display_add_event_cb(display, round_invalidate_area, LV_EVENT_INVALIDATE_AREA, NULL);
+#endif
+}
+
+// Called by the SPI flush after byte swapping. Returns false if the area must be sent as usual
+bool lvgl_round_flush(lv_display_t *display, const lv_area_t *area, uint16_t *pixels)
+{
+  // Rows clipped to the circle
+  smartdisplay_window_begin(&round_list, area);
+  for (int32_t y = area->y1; y <= area->y2; y++)
+  {
+    const int32_t x1 = LV_MAX(area->x1, round_row_x1[y]) - area->x1;
+    const int32_t x2 = LV_MIN(area->x2, round_row_x2[y]) - area->x1;
+    if (x1 <= x2)
+      smartdisplay_window_add(&round_list, y, x1, x2);
+  }
+
+  smartdisplay_window_end(&round_list, lv_display_flush_is_last(display));
+  if (smartdisplay_window_send(&round_list, display->user_data, pixels))
+    return true;
+
+  // Completely outside the circle
+  lv_display_flush_ready(display);
+  return true;
+}
+
+// Called from the color transfer done ISR. Returns true when the last window of the area is sent
+bool IRAM_ATTR lvgl_round_color_trans_done()
+{
+  return smartdisplay_window_trans_done(&round_list);
+}
+
+#endif
+
+void smartdisplay_round_get_stats(smartdisplay_round_stats_t *stats)
+{
+  *stats = round_list.stats;
+}
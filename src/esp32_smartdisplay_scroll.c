@@ -0,0 +1,88 @@
+#include <esp32_smartdisplay_scroll.h>
+
+int32_t smartdisplay_scroll_top_fixed_area(const smartdisplay_scroll_area_t *scroll)
+{
+  return scroll->mirror ? scroll->gram_rows - scroll->gap_y - scroll->y1 - scroll->height : scroll->y1 + scroll->gap_y;
+}
+
+int32_t smartdisplay_scroll_start(const smartdisplay_scroll_area_t *scroll, int32_t offset)
+{
+  // Without scroll area the image is not moved
+  if (scroll->height == 0)
+    return 0;
+
+  return smartdisplay_scroll_top_fixed_area(scroll) + (scroll->mirror ? (scroll->height - offset) % scroll->height : offset);
+}
+
+int32_t smartdisplay_scroll_offset(const smartdisplay_scroll_area_t *scroll, int32_t offset, int32_t dy)
+{
+  return ((offset + dy) % scroll->height + scroll->height) % scroll->height;
+}
+
+bool smartdisplay_scroll_move_areas(const smartdisplay_scroll_area_t *scroll, int32_t width, int32_t dy, lv_area_t *areas, uint32_t count, lv_area_t *exposed)
+{
+  // Changes in the scroll area that can not be moved with the content
+  const int32_t y2 = scroll->y1 + scroll->height - 1;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const lv_area_t *area = &areas[i];
+    if (area->y2 >= scroll->y1 && area->y1 <= y2 && (area->y1 < scroll->y1 || area->y2 > y2))
+      return false;
+  }
+
+  *exposed = dy > 0 ? (lv_area_t){.x1 = 0, .y1 = y2 - dy + 1, .x2 = width - 1, .y2 = y2} : (lv_area_t){.x1 = 0, .y1 = scroll->y1, .x2 = width - 1, .y2 = scroll->y1 - dy - 1};
+  for (uint32_t i = 0; i < count; i++)
+  {
+    lv_area_t *area = &areas[i];
+    if (area->y2 < scroll->y1 || area->y1 > y2)
+      continue;
+
+    area->y1 = LV_MAX(area->y1 - dy, scroll->y1);
+    area->y2 = LV_MIN(area->y2 - dy, y2);
+    // Scrolled out
+    if (area->y2 < area->y1)
+      *area = *exposed;
+  }
+
+  return true;
+}
+
+bool smartdisplay_scroll_crop(const smartdisplay_scroll_area_t *scroll, int32_t width, const lv_area_t *exposed, lv_area_t *area)
+{
+  if (area->x1 > 0 || area->x2 < width - 1 || area->y1 > scroll->y1 || area->y2 < scroll->y1 + scroll->height - 1)
+    return false;
+
+  *area = *exposed;
+  return true;
+}
+
+uint32_t smartdisplay_scroll_bytes(const smartdisplay_scroll_area_t *scroll, const lv_area_t *area, uint32_t px_size)
+{
+  const int32_t rows = LV_MIN(area->y2, scroll->y1 + scroll->height - 1) - LV_MAX(area->y1, scroll->y1) + 1;
+  return rows > 0 ? rows * lv_area_get_width(area) * px_size : 0;
+}
+
+uint32_t smartdisplay_scroll_windows(const smartdisplay_scroll_area_t *scroll, int32_t offset, const lv_area_t *area, smartdisplay_scroll_window_t *windows)
+{
+  // Rows above and below the scroll area are not moved, the rows in the scroll area wrap around
+  const int32_t y2 = scroll->y1 + scroll->height - 1;
+  uint32_t count = 0;
+  if (area->y1 < scroll->y1)
+    windows[count++] = (smartdisplay_scroll_window_t){.y1 = area->y1, .y2 = LV_MIN(area->y2, scroll->y1 - 1), .dest_y = area->y1};
+
+  const int32_t first = LV_MAX(area->y1, scroll->y1);
+  const int32_t last = LV_MIN(area->y2, y2);
+  if (first <= last)
+  {
+    const int32_t row = (first - scroll->y1 + offset) % scroll->height;
+    const int32_t wrap = first + scroll->height - row;
+    windows[count++] = (smartdisplay_scroll_window_t){.y1 = first, .y2 = LV_MIN(last, wrap - 1), .dest_y = scroll->y1 + row};
+    if (last >= wrap)
+      windows[count++] = (smartdisplay_scroll_window_t){.y1 = wrap, .y2 = last, .dest_y = scroll->y1};
+  }
+
+  if (area->y2 > y2)
+    windows[count++] = (smartdisplay_scroll_window_t){.y1 = LV_MAX(area->y1, y2 + 1), .y2 = area->y2, .dest_y = LV_MAX(area->y1, y2 + 1)};
+
+  return count;
+}
@@ -0,0 +1,108 @@
+#include <esp32_smartdisplay.h>
+#include <esp_heap_caps.h>
+
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+
+#if !defined(DISPLAY_ILI9341_SPI) && !defined(DISPLAY_ST7796_SPI) && !defined(DISPLAY_GC9A01_SPI) && !defined(DISPLAY_ST7789_SPI)
+#error "SMARTDISPLAY_SHADOW_BUFFER is only supported for SPI panels"
+#endif
+
+#ifndef SMARTDISPLAY_SHADOW_WINDOW_COST
+#define SMARTDISPLAY_SHADOW_WINDOW_COST 96
+#endif
+
+// Maximum number of windows for one area. More changes are sent as one window
+#define SHADOW_MAX_WINDOWS 128
+
+// Copy of the panel GRAM (byte swapped, in logical coordinates)
+uint16_t *shadow_buffer;
+// Rows of the shadow buffer that match the GRAM
+bool *shadow_row_valid;
+lv_display_rotation_t shadow_rotation;
+
+smartdisplay_window_t shadow_windows[SHADOW_MAX_WINDOWS];
+
+#endif
+
+smartdisplay_window_list_t shadow_list;
+
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+
+void lvgl_shadow_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  shadow_list.windows = shadow_windows;
+  shadow_list.max_windows = SHADOW_MAX_WINDOWS;
+  shadow_list.window_cost = SMARTDISPLAY_SHADOW_WINDOW_COST;
+
+  const uint32_t rows = LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+  shadow_buffer = heap_caps_malloc(DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+  shadow_row_valid = heap_caps_calloc(rows, sizeof(bool), MALLOC_CAP_INTERNAL);
+  if (shadow_buffer == NULL || shadow_row_valid == NULL)
+  {
+    log_e("Unable to allocate the shadow buffer");
+    heap_caps_free(shadow_buffer);
+    heap_caps_free(shadow_row_valid);
+    shadow_buffer = NULL;
+    shadow_row_valid = NULL;
+    return;
+  }
+
+  shadow_rotation = lv_display_get_rotation(display);
+}
+
+// Called by the SPI flush after byte swapping. Returns false if the area must be sent as usual
+bool lvgl_shadow_flush(lv_display_t *display, const lv_area_t *area, uint16_t *pixels)
+{
+  if (shadow_buffer == NULL)
+    return false;
+
+  // After rotating the shadow does not match the GRAM
+  if (display->rotation != shadow_rotation)
+  {
+    memset(shadow_row_valid, 0, LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT) * sizeof(bool));
+    shadow_rotation = display->rotation;
+  }
+
+  const int32_t stride = lv_display_get_horizontal_resolution(display);
+  const int32_t width = lv_area_get_width(area);
+  smartdisplay_window_begin(&shadow_list, area);
+  for (int32_t y = area->y1; y <= area->y2; y++)
+  {
+    const uint16_t *src = pixels + (y - area->y1) * width;
+    uint16_t *shadow = shadow_buffer + y * stride + area->x1;
+    if (!shadow_row_valid[y])
+    {
+      // Unknown GRAM content, send the complete row
+      smartdisplay_window_add(&shadow_list, y, 0, width - 1);
+      if (area->x1 == 0 && width == stride)
+        shadow_row_valid[y] = true;
+    }
+    else
+      smartdisplay_window_add_changes(&shadow_list, y, src, shadow);
+
+    memcpy(shadow, src, width * sizeof(uint16_t));
+  }
+
+  smartdisplay_window_end(&shadow_list, lv_display_flush_is_last(display));
+  if (smartdisplay_window_send(&shadow_list, display->user_data, pixels))
+    return true;
+
+  // Nothing changed
+  lv_display_flush_ready(display);
+  return true;
+}
+
+// Called from the color transfer done ISR. Returns true when the last window of the area is sent
+bool IRAM_ATTR lvgl_shadow_color_trans_done()
+{
+  return smartdisplay_window_trans_done(&shadow_list);
+}
+
+#endif
+
+void smartdisplay_shadow_get_stats(smartdisplay_shadow_stats_t *stats)
+{
+  *stats = shadow_list.stats;
+}
@@ -0,0 +1,72 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_chunks.h>
+
+// Areas rendered in PSRAM are copied to internal DMA buffers for the SPI panels
+#ifdef SMARTDISPLAY_SPI_BOUNCE
+
+#if !defined(DISPLAY_ILI9341_SPI) && !defined(DISPLAY_ST7796_SPI) && !defined(DISPLAY_GC9A01_SPI) && !defined(DISPLAY_ST7789_SPI)
+#error "SMARTDISPLAY_SPI_BOUNCE is only supported for SPI panels"
+#endif
+
+// The swapped area is needed in the draw buffer
+#if defined(SMARTDISPLAY_SHADOW_BUFFER) || defined(SMARTDISPLAY_ROUND_MASK) || defined(SMARTDISPLAY_VSCROLL)
+#error "SMARTDISPLAY_SPI_BOUNCE can not be combined with SMARTDISPLAY_SHADOW_BUFFER, SMARTDISPLAY_ROUND_MASK or SMARTDISPLAY_VSCROLL"
+#endif
+
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+
+// Pixels copied and sent per transaction. At least two lines are sent per transaction
+#ifndef SMARTDISPLAY_SPI_BOUNCE_PIXELS
+#define SMARTDISPLAY_SPI_BOUNCE_PIXELS 2048
+#endif
+
+#ifdef SMARTDISPLAY_TE_GPIO
+extern void lvgl_te_wait(lv_display_t *display);
+#endif
+
+// Copied with the byte swap into the bounce buffers
+smartdisplay_chunks_t spi_bounce_chunks;
+
+void lvgl_spi_bounce_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  // Chunks of at least two lines in any rotation, so the chunks start 32 bit aligned in the draw buffer
+  const uint32_t pixels = LV_MAX(SMARTDISPLAY_SPI_BOUNCE_PIXELS, 2 * LV_MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT));
+  if (!smartdisplay_chunks_init(&spi_bounce_chunks, smartdisplay_chunk_swap, NULL, pixels))
+  {
+    log_e("Unable to allocate the bounce buffers");
+    return;
+  }
+
+  log_d("Bounce buffers: %u x %u pixels", SMARTDISPLAY_CHUNK_BUFFERS, pixels);
+}
+
+// Called by the SPI flush instead of the byte swapping. Returns false if the area is not in PSRAM
+bool lvgl_spi_bounce_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+  if (!esp_ptr_external_ram(px_map) || spi_bounce_chunks.buffers[0] == NULL)
+    return false;
+
+  const int32_t width = lv_area_get_width(area);
+  // An even number of rows if the width is odd
+  const int32_t chunk_rows = (spi_bounce_chunks.buffer_pixels / width) & (width & 1 ? ~1 : ~0);
+#ifdef SMARTDISPLAY_TE_GPIO
+  lvgl_te_wait(display);
+#endif
+  smartdisplay_chunks_send(&spi_bounce_chunks, display->user_data, area, px_map, lv_draw_buf_width_to_stride(width, LV_COLOR_FORMAT_RGB565), chunk_rows);
+  return true;
+}
+
+// Called from the color transfer done ISR. Returns true when the last chunk of the area is sent
+bool IRAM_ATTR lvgl_spi_bounce_color_trans_done()
+{
+  return smartdisplay_chunks_trans_done(&spi_bounce_chunks);
+}
+
+#endif
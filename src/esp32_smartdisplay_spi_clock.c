@@ -0,0 +1,387 @@
+#include <esp32_smartdisplay.h>
+#include <nvs.h>
+
+#define SPI_CLOCK_NVS_NAMESPACE "smartdisplay"
+#define SPI_CLOCK_NVS_KEY "spi_clock"
+
+#ifdef SMARTDISPLAY_SPI_CLOCK_TUNE
+
+#if defined(DISPLAY_ILI9341_SPI)
+#define SPI_CLOCK_HOST ILI9341_SPI_HOST
+#define SPI_CLOCK_MISO ILI9341_SPI_BUS_MISO
+#define SPI_CLOCK_CS ILI9341_SPI_CONFIG_CS
+#define SPI_CLOCK_DC ILI9341_SPI_CONFIG_DC
+#define SPI_CLOCK_SPI_MODE ILI9341_SPI_CONFIG_SPI_MODE
+#define SPI_CLOCK_PCLK_HZ ILI9341_SPI_CONFIG_PCLK_HZ
+#define SPI_CLOCK_RESET ILI9341_DEV_CONFIG_RESET
+#elif defined(DISPLAY_ST7796_SPI)
+#define SPI_CLOCK_HOST ST7796_SPI_HOST
+#define SPI_CLOCK_MISO ST7796_SPI_BUS_MISO
+#define SPI_CLOCK_CS ST7796_SPI_CONFIG_CS
+#define SPI_CLOCK_DC ST7796_SPI_CONFIG_DC
+#define SPI_CLOCK_SPI_MODE ST7796_SPI_CONFIG_SPI_MODE
+#define SPI_CLOCK_PCLK_HZ ST7796_SPI_CONFIG_PCLK_HZ
+#define SPI_CLOCK_RESET ST7796_DEV_CONFIG_RESET
+#elif defined(DISPLAY_GC9A01_SPI)
+#define SPI_CLOCK_HOST GC9A01_SPI_HOST
+#define SPI_CLOCK_MISO GC9A01_SPI_BUS_MISO
+#define SPI_CLOCK_CS GC9A01_SPI_CONFIG_CS
+#define SPI_CLOCK_DC GC9A01_SPI_CONFIG_DC
+#define SPI_CLOCK_SPI_MODE GC9A01_SPI_CONFIG_SPI_MODE
+#define SPI_CLOCK_PCLK_HZ GC9A01_SPI_CONFIG_PCLK_HZ
+#define SPI_CLOCK_RESET GC9A01_DEV_CONFIG_RESET
+#elif defined(DISPLAY_ST7789_SPI)
+#define SPI_CLOCK_HOST ST7789_SPI_HOST
+#define SPI_CLOCK_MISO ST7789_SPI_BUS_MISO
+#define SPI_CLOCK_CS ST7789_SPI_CONFIG_CS
+#define SPI_CLOCK_DC ST7789_SPI_CONFIG_DC
+#define SPI_CLOCK_SPI_MODE ST7789_SPI_CONFIG_SPI_MODE
+#define SPI_CLOCK_PCLK_HZ ST7789_SPI_CONFIG_PCLK_HZ
+#define SPI_CLOCK_RESET ST7789_DEV_CONFIG_RESET
+#else
+#error "SMARTDISPLAY_SPI_CLOCK_TUNE is only supported for SPI panels"
+#endif
+
+#include <driver/gpio.h>
+#include <driver/spi_master.h>
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_commands.h>
+#include <soc/soc.h>
+
+// Highest pixel clock to try [Hz]
+#ifndef SMARTDISPLAY_SPI_CLOCK_MAX_HZ
+#define SMARTDISPLAY_SPI_CLOCK_MAX_HZ 80000000
+#endif
+
+// The used clock is at least this percentage below the highest clock that passed
+#ifndef SMARTDISPLAY_SPI_CLOCK_MARGIN
+#define SMARTDISPLAY_SPI_CLOCK_MARGIN 10
+#endif
+
+// Clock to read back the panel memory [Hz]. The read cycle of the panels is much slower than the write cycle
+#ifndef SMARTDISPLAY_SPI_CLOCK_READ_HZ
+#define SMARTDISPLAY_SPI_CLOCK_READ_HZ 4000000
+#endif
+
+// Window written and read back, fits in any panel
+#define SPI_CLOCK_COLUMNS 64
+#define SPI_CLOCK_ROWS 4
+#define SPI_CLOCK_PIXELS (SPI_CLOCK_COLUMNS * SPI_CLOCK_ROWS)
+// Test patterns written and read back at every clock
+#define SPI_CLOCK_PATTERNS 4
+// Read data: dummy bits (up to 2 bytes) and up to 3 bytes per pixel
+#define SPI_CLOCK_READ_BYTES (2 + 3 * SPI_CLOCK_PIXELS + 1)
+
+typedef struct
+{
+  uint32_t signature;
+  uint32_t pclk_hz;
+  uint32_t max_pass_hz;
+} spi_clock_nvs_t;
+
+uint8_t *spi_clock_pattern;
+uint8_t *spi_clock_read;
+// Framing of the read data, determined at the board clock
+uint8_t spi_clock_read_skip_bits;
+uint8_t spi_clock_read_pixel_bytes;
+
+#endif
+
+smartdisplay_spi_clock_info_t spi_clock_info;
+
+#ifdef SMARTDISPLAY_SPI_CLOCK_TUNE
+
+// Changes in the board or options invalidate the stored result
+uint32_t spi_clock_signature()
+{
+  return SPI_CLOCK_PCLK_HZ ^ (SMARTDISPLAY_SPI_CLOCK_MAX_HZ >> 4) ^ (SMARTDISPLAY_SPI_CLOCK_MARGIN << 24);
+}
+
+bool spi_clock_load()
+{
+  nvs_handle_t handle;
+  if (nvs_open(SPI_CLOCK_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    return false;
+
+  spi_clock_nvs_t stored;
+  size_t length = sizeof(stored);
+  const esp_err_t res = nvs_get_blob(handle, SPI_CLOCK_NVS_KEY, &stored, &length);
+  nvs_close(handle);
+  if (res != ESP_OK || length != sizeof(stored) || stored.signature != spi_clock_signature())
+    return false;
+
+  spi_clock_info.pclk_hz = stored.pclk_hz;
+  spi_clock_info.max_pass_hz = stored.max_pass_hz;
+  spi_clock_info.from_nvs = true;
+  return true;
+}
+
+void spi_clock_store()
+{
+  nvs_handle_t handle;
+  if (nvs_open(SPI_CLOCK_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+  {
+    log_w("Unable to open NVS");
+    return;
+  }
+
+  const spi_clock_nvs_t stored = {.signature = spi_clock_signature(), .pclk_hz = spi_clock_info.pclk_hz, .max_pass_hz = spi_clock_info.max_pass_hz};
+  if (nvs_set_blob(handle, SPI_CLOCK_NVS_KEY, &stored, sizeof(stored)) != ESP_OK || nvs_commit(handle) != ESP_OK)
+    log_w("Unable to store the SPI clock");
+
+  nvs_close(handle);
+}
+
+spi_device_handle_t spi_clock_add_device(uint32_t hz)
+{
+  const spi_device_interface_config_t device_config = {
+      .mode = SPI_CLOCK_SPI_MODE,
+      .clock_speed_hz = hz,
+      .spics_io_num = SPI_CLOCK_CS,
+      .flags = SPI_DEVICE_HALFDUPLEX,
+      .queue_size = 1};
+  spi_device_handle_t device;
+  if (spi_bus_add_device(SPI_CLOCK_HOST, &device_config, &device) != ESP_OK)
+    return NULL;
+
+  return device;
+}
+
+// Command (DC low) followed by the parameters or pixels (DC high). The bus must be acquired
+void spi_clock_tx(spi_device_handle_t device, uint8_t cmd, const void *data, size_t length)
+{
+  spi_transaction_t transaction = {.flags = SPI_TRANS_USE_TXDATA | (length > 0 ? SPI_TRANS_CS_KEEP_ACTIVE : 0), .length = 8, .tx_data = {cmd}};
+  gpio_set_level(SPI_CLOCK_DC, 0);
+  ESP_ERROR_CHECK(spi_device_polling_transmit(device, &transaction));
+  if (length == 0)
+    return;
+
+  transaction = (spi_transaction_t){.length = length * 8, .tx_buffer = data};
+  gpio_set_level(SPI_CLOCK_DC, 1);
+  ESP_ERROR_CHECK(spi_device_polling_transmit(device, &transaction));
+}
+
+void spi_clock_set_window(spi_device_handle_t device)
+{
+  spi_clock_tx(device, LCD_CMD_CASET, (uint8_t[]){0, 0, 0, SPI_CLOCK_COLUMNS - 1}, 4);
+  spi_clock_tx(device, LCD_CMD_RASET, (uint8_t[]){0, 0, 0, SPI_CLOCK_ROWS - 1}, 4);
+}
+
+// Bring the panel in a known state: reset, awake and 16 bits per pixel. The panel is initialized again by the driver
+void spi_clock_init_panel()
+{
+  gpio_set_direction(SPI_CLOCK_DC, GPIO_MODE_OUTPUT);
+  spi_device_handle_t device = spi_clock_add_device(SMARTDISPLAY_SPI_CLOCK_READ_HZ);
+  assert(device != NULL);
+  spi_device_acquire_bus(device, portMAX_DELAY);
+  if (SPI_CLOCK_RESET >= 0)
+  {
+    gpio_set_direction(SPI_CLOCK_RESET, GPIO_MODE_OUTPUT);
+    gpio_set_level(SPI_CLOCK_RESET, 0);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    gpio_set_level(SPI_CLOCK_RESET, 1);
+  }
+  else
+    spi_clock_tx(device, LCD_CMD_SWRESET, NULL, 0);
+
+  vTaskDelay(pdMS_TO_TICKS(120));
+  spi_clock_tx(device, LCD_CMD_SLPOUT, NULL, 0);
+  vTaskDelay(pdMS_TO_TICKS(120));
+  spi_clock_tx(device, LCD_CMD_COLMOD, (uint8_t[]){0x55}, 1);
+  spi_device_release_bus(device);
+  spi_bus_remove_device(device);
+}
+
+// Alternating bits, alternating pixels and pseudo random pixels, different for every clock
+void spi_clock_fill_pattern(uint8_t pattern, uint32_t seed)
+{
+  uint32_t random = seed | 1;
+  for (uint32_t i = 0; i < SPI_CLOCK_PIXELS; i++)
+  {
+    uint16_t pixel;
+    switch (pattern)
+    {
+    case 0:
+      pixel = i & 1 ? 0x5555 : 0xaaaa;
+      break;
+    case 1:
+      pixel = i & 1 ? 0x0000 : 0xffff;
+      break;
+    default:
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      pixel = random;
+    }
+
+    spi_clock_pattern[2 * i] = pixel >> 8;
+    spi_clock_pattern[2 * i + 1] = pixel;
+  }
+}
+
+void spi_clock_read_back()
+{
+  spi_device_handle_t device = spi_clock_add_device(SMARTDISPLAY_SPI_CLOCK_READ_HZ);
+  assert(device != NULL);
+  spi_device_acquire_bus(device, portMAX_DELAY);
+  spi_clock_set_window(device);
+  // Keep CS active for the read, the read ends when CS is released
+  spi_transaction_t transaction = {.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_CS_KEEP_ACTIVE, .length = 8, .tx_data = {LCD_CMD_RAMRD}};
+  gpio_set_level(SPI_CLOCK_DC, 0);
+  ESP_ERROR_CHECK(spi_device_polling_transmit(device, &transaction));
+  transaction = (spi_transaction_t){.rxlength = SPI_CLOCK_READ_BYTES * 8, .rx_buffer = spi_clock_read};
+  gpio_set_level(SPI_CLOCK_DC, 1);
+  ESP_ERROR_CHECK(spi_device_polling_transmit(device, &transaction));
+  spi_device_release_bus(device);
+  spi_bus_remove_device(device);
+}
+
+// Byte at any bit position of the read data
+static inline uint8_t spi_clock_read_byte(uint32_t bit)
+{
+  const uint32_t i = bit / 8, shift = bit % 8;
+  return shift == 0 ? spi_clock_read[i] : (uint8_t)(spi_clock_read[i] << shift | spi_clock_read[i + 1] >> (8 - shift));
+}
+
+// The panel stores 18 bits per pixel, only the bits written are compared
+bool spi_clock_compare(uint8_t skip_bits, uint8_t pixel_bytes)
+{
+  for (uint32_t i = 0; i < SPI_CLOCK_PIXELS; i++)
+  {
+    const uint16_t pixel = spi_clock_pattern[2 * i] << 8 | spi_clock_pattern[2 * i + 1];
+    const uint32_t bit = skip_bits + i * pixel_bytes * 8;
+    if (pixel_bytes == 2)
+    {
+      if ((spi_clock_read_byte(bit) << 8 | spi_clock_read_byte(bit + 8)) != pixel)
+        return false;
+    }
+    else if ((spi_clock_read_byte(bit) & 0xf8) != ((pixel >> 8) & 0xf8) || (spi_clock_read_byte(bit + 8) & 0xfc) != ((pixel >> 3) & 0xfc) || (spi_clock_read_byte(bit + 16) & 0xf8) != ((pixel << 3) & 0xf8))
+      return false;
+  }
+
+  return true;
+}
+
+// Write the patterns at the clock and read them back
+bool spi_clock_test(uint32_t hz)
+{
+  for (uint8_t pattern = 0; pattern < SPI_CLOCK_PATTERNS; pattern++)
+  {
+    spi_clock_fill_pattern(pattern, hz + pattern);
+    spi_device_handle_t device = spi_clock_add_device(hz);
+    if (device == NULL)
+      return false;
+
+    spi_device_acquire_bus(device, portMAX_DELAY);
+    spi_clock_set_window(device);
+    spi_clock_tx(device, LCD_CMD_RAMWR, spi_clock_pattern, SPI_CLOCK_PIXELS * sizeof(uint16_t));
+    spi_device_release_bus(device);
+    spi_bus_remove_device(device);
+
+    spi_clock_read_back();
+    if (!spi_clock_compare(spi_clock_read_skip_bits, spi_clock_read_pixel_bytes))
+      return false;
+  }
+
+  return true;
+}
+
+// The dummy clocks and pixel format of the read data differ per panel. Determined with a write at the board clock
+bool spi_clock_calibrate()
+{
+  spi_clock_fill_pattern(SPI_CLOCK_PATTERNS - 1, SPI_CLOCK_PCLK_HZ);
+  spi_device_handle_t device = spi_clock_add_device(SPI_CLOCK_PCLK_HZ);
+  assert(device != NULL);
+  spi_device_acquire_bus(device, portMAX_DELAY);
+  spi_clock_set_window(device);
+  spi_clock_tx(device, LCD_CMD_RAMWR, spi_clock_pattern, SPI_CLOCK_PIXELS * sizeof(uint16_t));
+  spi_device_release_bus(device);
+  spi_bus_remove_device(device);
+
+  spi_clock_read_back();
+  for (spi_clock_read_pixel_bytes = 3; spi_clock_read_pixel_bytes >= 2; spi_clock_read_pixel_bytes--)
+    for (spi_clock_read_skip_bits = 0; spi_clock_read_skip_bits <= 16; spi_clock_read_skip_bits++)
+      if (spi_clock_compare(spi_clock_read_skip_bits, spi_clock_read_pixel_bytes))
+      {
+        log_d("Read back: dummy bits:%u, bytes per pixel:%u", spi_clock_read_skip_bits, spi_clock_read_pixel_bytes);
+        return true;
+      }
+
+  return false;
+}
+
+// Called by the SPI panel before attaching the panel IO. Returns the pixel clock to use
+uint32_t lvgl_spi_clock_tune()
+{
+  spi_clock_info = (smartdisplay_spi_clock_info_t){.pclk_hz = SPI_CLOCK_PCLK_HZ, .configured_hz = SPI_CLOCK_PCLK_HZ};
+  if (SPI_CLOCK_MISO < 0)
+  {
+    log_w("No MISO connected, using the configured SPI clock: %u Hz", SPI_CLOCK_PCLK_HZ);
+    return spi_clock_info.pclk_hz;
+  }
+
+  spi_clock_info.readback = true;
+  if (spi_clock_load())
+  {
+    log_i("SPI clock from NVS: %u Hz, highest passed: %u Hz", spi_clock_info.pclk_hz, spi_clock_info.max_pass_hz);
+    return spi_clock_info.pclk_hz;
+  }
+
+  spi_clock_pattern = heap_caps_malloc(SPI_CLOCK_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  spi_clock_read = heap_caps_malloc(SPI_CLOCK_READ_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  assert(spi_clock_pattern != NULL && spi_clock_read != NULL);
+
+  spi_clock_init_panel();
+  if (!spi_clock_calibrate())
+  {
+    log_w("Unable to read back the panel memory, using the configured SPI clock: %u Hz", SPI_CLOCK_PCLK_HZ);
+    spi_clock_info.readback = false;
+  }
+  else
+  {
+    // The SPI clock is the APB clock divided by an integer
+    spi_clock_info.max_pass_hz = SPI_CLOCK_PCLK_HZ;
+    for (uint32_t divider = APB_CLK_FREQ / SPI_CLOCK_PCLK_HZ; divider >= 1 && APB_CLK_FREQ / divider <= SMARTDISPLAY_SPI_CLOCK_MAX_HZ; divider--)
+    {
+      const uint32_t hz = APB_CLK_FREQ / divider;
+      if (hz <= SPI_CLOCK_PCLK_HZ)
+        continue;
+
+      const bool pass = spi_clock_test(hz);
+      log_d("SPI clock: %u Hz, pass:%d", hz, pass);
+      if (!pass)
+        break;
+
+      spi_clock_info.max_pass_hz = hz;
+    }
+
+    // Highest divided clock within the margin
+    const uint32_t limit = (uint64_t)spi_clock_info.max_pass_hz * (100 - SMARTDISPLAY_SPI_CLOCK_MARGIN) / 100;
+    spi_clock_info.pclk_hz = LV_MAX(APB_CLK_FREQ / ((APB_CLK_FREQ + limit - 1) / limit), SPI_CLOCK_PCLK_HZ);
+    log_i("SPI clock tuned: %u Hz, highest passed: %u Hz, configured: %u Hz", spi_clock_info.pclk_hz, spi_clock_info.max_pass_hz, SPI_CLOCK_PCLK_HZ);
+    spi_clock_store();
+  }
+
+  heap_caps_free(spi_clock_pattern);
+  heap_caps_free(spi_clock_read);
+  return spi_clock_info.pclk_hz;
+}
+
+#endif
+
+void smartdisplay_spi_clock_get_info(smartdisplay_spi_clock_info_t *info)
+{
+  *info = spi_clock_info;
+}
+
+void smartdisplay_spi_clock_forget()
+{
+  nvs_handle_t handle;
+  if (nvs_open(SPI_CLOCK_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+    return;
+
+  if (nvs_erase_key(handle, SPI_CLOCK_NVS_KEY) == ESP_OK)
+    nvs_commit(handle);
+
+  nvs_close(handle);
+}
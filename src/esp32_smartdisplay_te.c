@@ -0,0 +1,176 @@
+#include <esp32_smartdisplay.h>
+
+#ifdef SMARTDISPLAY_TE_GPIO
+
+#if !defined(DISPLAY_ILI9341_SPI) && !defined(DISPLAY_ST7789_SPI) && !defined(DISPLAY_ST7796_SPI) && !defined(DISPLAY_GC9A01_SPI)
+#error "SMARTDISPLAY_TE_GPIO is only supported for the SPI panels"
+#endif
+
+#if defined(SMARTDISPLAY_REFR_PERIOD_MIN) || defined(SMARTDISPLAY_REFR_PERIOD_MAX)
+#error "SMARTDISPLAY_TE_GPIO sets the refresh period and can not be combined with SMARTDISPLAY_REFR_PERIOD_MIN/MAX"
+#endif
+
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_commands.h>
+
+// Maximum time to wait for the tearing effect pulse before sending anyway [ms]
+#ifndef SMARTDISPLAY_TE_TIMEOUT
+#define SMARTDISPLAY_TE_TIMEOUT 50
+#endif
+
+// Interval for locking the refresh timer to the panel refresh [ms]
+#define TE_LOCK_PERIOD 1000
+// Weight of a new period in the moving average (1/n)
+#define TE_PERIOD_AVERAGE 16
+
+extern lv_display_t *display;
+extern smartdisplay_power_stats_t power_stats;
+
+SemaphoreHandle_t te_semaphore;
+// The 64 bit times are shared between the task and the interrupts, accessed in a critical section
+portMUX_TYPE te_lock = portMUX_INITIALIZER_UNLOCKED;
+int64_t te_last_edge_us;
+// Panel refresh period [us], moving average
+volatile uint32_t te_period_us;
+// Set when the first area of the refresh has waited for the pulse
+bool te_frame_started;
+int64_t te_frame_start_us;
+uint32_t te_frame_edges;
+int64_t te_last_frame_start_us;
+
+#endif
+
+smartdisplay_te_stats_t te_stats;
+
+#ifdef SMARTDISPLAY_TE_GPIO
+
+// Start of the vertical blanking
+void IRAM_ATTR te_isr(void *arg)
+{
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL_ISR(&te_lock);
+  if (te_last_edge_us != 0)
+  {
+    const uint32_t period = now - te_last_edge_us;
+    te_period_us = te_period_us == 0 ? period : te_period_us + ((int32_t)period - (int32_t)te_period_us) / TE_PERIOD_AVERAGE;
+  }
+
+  te_last_edge_us = now;
+  te_stats.edges++;
+  portEXIT_CRITICAL_ISR(&te_lock);
+
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  xSemaphoreGiveFromISR(te_semaphore, &higher_priority_task_woken);
+  if (higher_priority_task_woken)
+    portYIELD_FROM_ISR();
+}
+
+void te_refresh_start(lv_event_t *event)
+{
+  te_frame_started = false;
+}
+
+void te_lock_timer_cb(lv_timer_t *timer)
+{
+  te_stats.period_us = te_period_us;
+  // The power governor owns the refresh period when not active
+  if (te_period_us == 0 || power_stats.state != SMARTDISPLAY_POWER_ACTIVE)
+    return;
+
+  // Slightly faster than the panel, the flush waits for the pulse
+  lv_timer_set_period(display->refr_timer, LV_MAX(1, te_period_us / 1000));
+}
+
+void lvgl_te_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  // Tearing effect output, V-blanking only
+  const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+  ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_TEON, (uint8_t[]){0}, 1));
+
+  te_semaphore = xSemaphoreCreateBinary();
+  assert(te_semaphore != NULL);
+
+  const gpio_config_t te_gpio_config = {
+      .pin_bit_mask = 1ULL << SMARTDISPLAY_TE_GPIO,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_DISABLE,
+      .pull_down_en = GPIO_PULLDOWN_ENABLE,
+      .intr_type = GPIO_INTR_POSEDGE};
+  ESP_ERROR_CHECK(gpio_config(&te_gpio_config));
+  // Already installed by other drivers or the application
+  const esp_err_t res = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+  if (res != ESP_ERR_INVALID_STATE)
+    ESP_ERROR_CHECK(res);
+
+  ESP_ERROR_CHECK(gpio_isr_handler_add(SMARTDISPLAY_TE_GPIO, te_isr, NULL));
+
+  lv_display_add_event_cb(display, te_refresh_start, LV_EVENT_REFR_START, NULL);
+  lv_timer_create(te_lock_timer_cb, TE_LOCK_PERIOD, NULL);
+}
+
+// Called by the SPI flush before sending. The first area of the refresh is sent right after the tearing effect pulse
+void lvgl_te_wait(lv_display_t *display)
+{
+  if (te_frame_started)
+    return;
+
+  te_frame_started = true;
+  // Discard a pulse given before the refresh
+  xSemaphoreTake(te_semaphore, 0);
+  if (xSemaphoreTake(te_semaphore, pdMS_TO_TICKS(SMARTDISPLAY_TE_TIMEOUT)) != pdTRUE)
+  {
+    te_stats.timeouts++;
+    return;
+  }
+
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&te_lock);
+  te_frame_start_us = now;
+  te_frame_edges = te_stats.edges;
+  const int64_t last_edge_us = te_last_edge_us;
+  portEXIT_CRITICAL(&te_lock);
+  te_stats.frames++;
+
+  // Delay of the start of the transfer after the pulse
+  const uint32_t latency = now - last_edge_us;
+  te_stats.latency_us = latency;
+  te_stats.latency_max_us = LV_MAX(te_stats.latency_max_us, latency);
+
+  // Deviation of the interval between frames from a whole number of panel refreshes
+  if (te_last_frame_start_us != 0 && te_period_us != 0)
+  {
+    const uint32_t interval = now - te_last_frame_start_us;
+    const uint32_t refreshes = (interval + te_period_us / 2) / te_period_us;
+    const uint32_t jitter = abs((int32_t)interval - (int32_t)(refreshes * te_period_us));
+    te_stats.jitter_us = jitter;
+    te_stats.jitter_max_us = LV_MAX(te_stats.jitter_max_us, jitter);
+  }
+
+  te_last_frame_start_us = now;
+}
+
+// Called by the SPI drivers when the transfer of an area is complete (ISR)
+void IRAM_ATTR lvgl_te_transfer_done()
+{
+  if (!display->flushing_last)
+    return;
+
+  portENTER_CRITICAL_ISR(&te_lock);
+  // The panel started scanning the next frame before the last pixel was written
+  if (te_frame_start_us != 0 && te_stats.edges != te_frame_edges)
+    te_stats.tears++;
+
+  te_frame_start_us = 0;
+  portEXIT_CRITICAL_ISR(&te_lock);
+}
+
+#endif
+
+void smartdisplay_te_get_stats(smartdisplay_te_stats_t *stats)
+{
+  *stats = te_stats;
+}
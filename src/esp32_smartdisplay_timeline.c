@@ -0,0 +1,192 @@
+#include <esp32_smartdisplay.h>
+
+#ifdef SMARTDISPLAY_TIMELINE
+
+#include <esp_idf_version.h>
+#include <esp_timer.h>
+#include <esp_ipc.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_cpu.h>
+#define timeline_cycles() esp_cpu_get_cycle_count()
+#else
+#include <soc/cpu.h>
+#define timeline_cycles() esp_cpu_get_ccount()
+#endif
+
+// Number of events recorded per core
+#ifndef SMARTDISPLAY_TIMELINE_EVENTS
+#define SMARTDISPLAY_TIMELINE_EVENTS 512
+#endif
+
+// Chrome trace phases: begin/end on the core and async begin/end for the transfers (ending in the ISR)
+#define TIMELINE_BEGIN 'B'
+#define TIMELINE_END 'E'
+#define TIMELINE_ASYNC_BEGIN 'b'
+#define TIMELINE_ASYNC_END 'e'
+
+typedef struct
+{
+  uint32_t cycles;
+  const char *name;
+  char phase;
+} timeline_event_t;
+
+extern lv_display_t *display;
+
+// Written by the core itself only, with the interrupts of that core masked
+DRAM_ATTR timeline_event_t timeline_events[portNUM_PROCESSORS][SMARTDISPLAY_TIMELINE_EVENTS];
+uint32_t timeline_counts[portNUM_PROCESSORS];
+uint32_t timeline_overflows[portNUM_PROCESSORS];
+// Time [us] and cycle count of each core at the start, the cycle counters of the cores are not synchronized
+int64_t timeline_anchor_us[portNUM_PROCESSORS];
+uint32_t timeline_anchor_cycles[portNUM_PROCESSORS];
+volatile bool timeline_running;
+
+void IRAM_ATTR timeline_record(const char *name, char phase)
+{
+  if (!timeline_running)
+    return;
+
+  const uint32_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+  const uint32_t core = xPortGetCoreID();
+  if (timeline_counts[core] < SMARTDISPLAY_TIMELINE_EVENTS)
+    timeline_events[core][timeline_counts[core]++] = (timeline_event_t){.cycles = timeline_cycles(), .name = name, .phase = phase};
+  else
+    timeline_overflows[core]++;
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+void timeline_anchor(void *arg)
+{
+  const uint32_t core = xPortGetCoreID();
+  timeline_anchor_us[core] = esp_timer_get_time();
+  timeline_anchor_cycles[core] = timeline_cycles();
+}
+
+void timeline_display_event(lv_event_t *event)
+{
+  switch (lv_event_get_code(event))
+  {
+  case LV_EVENT_REFR_START:
+    timeline_record("refresh", TIMELINE_BEGIN);
+    break;
+  case LV_EVENT_REFR_READY:
+    timeline_record("refresh", TIMELINE_END);
+    break;
+  case LV_EVENT_RENDER_START:
+    timeline_record("render", TIMELINE_BEGIN);
+    break;
+  case LV_EVENT_RENDER_READY:
+    timeline_record("render", TIMELINE_END);
+    break;
+  case LV_EVENT_FLUSH_START:
+    timeline_record("flush", TIMELINE_BEGIN);
+    break;
+  case LV_EVENT_FLUSH_FINISH:
+    timeline_record("flush", TIMELINE_END);
+    // The transfer continues after the flush callback returns
+    timeline_record("transfer", TIMELINE_ASYNC_BEGIN);
+    break;
+  case LV_EVENT_FLUSH_WAIT_START:
+    timeline_record("wait for transfer", TIMELINE_BEGIN);
+    break;
+  case LV_EVENT_FLUSH_WAIT_FINISH:
+    timeline_record("wait for transfer", TIMELINE_END);
+    break;
+  default:
+    break;
+  }
+}
+
+// Called by the drivers when the transfer is complete (ISR)
+void IRAM_ATTR lvgl_timeline_transfer_done()
+{
+  // The RGB panels call this for every frame
+  if (display->flushing)
+    timeline_record("transfer", TIMELINE_ASYNC_END);
+}
+
+#endif
+
+void smartdisplay_timeline_start()
+{
+#ifdef SMARTDISPLAY_TIMELINE
+  log_v("");
+
+  smartdisplay_timeline_stop();
+  for (uint8_t core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    timeline_counts[core] = timeline_overflows[core] = 0;
+    if (core == xPortGetCoreID())
+      timeline_anchor(NULL);
+#if portNUM_PROCESSORS > 1
+    else
+      esp_ipc_call_blocking(core, timeline_anchor, NULL);
+#endif
+  }
+
+  lv_display_add_event_cb(display, timeline_display_event, LV_EVENT_ALL, NULL);
+  timeline_running = true;
+#endif
+}
+
+void smartdisplay_timeline_stop()
+{
+#ifdef SMARTDISPLAY_TIMELINE
+  if (!timeline_running)
+    return;
+
+  timeline_running = false;
+  lv_display_remove_event_cb_with_user_data(display, timeline_display_event, NULL);
+#endif
+}
+
+void smartdisplay_timeline_begin(const char *name)
+{
+#ifdef SMARTDISPLAY_TIMELINE
+  timeline_record(name, TIMELINE_BEGIN);
+#endif
+}
+
+void smartdisplay_timeline_end(const char *name)
+{
+#ifdef SMARTDISPLAY_TIMELINE
+  timeline_record(name, TIMELINE_END);
+#endif
+}
+
+void smartdisplay_timeline_dump()
+{
+#ifdef SMARTDISPLAY_TIMELINE
+  smartdisplay_timeline_stop();
+
+  // Chrome trace JSON, open in chrome://tracing or https://ui.perfetto.dev
+  const uint32_t cpu_mhz = getCpuFrequencyMhz();
+  log_printf("# timeline begin\n{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  for (uint8_t core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    log_printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"core %u\"}},\n", core, core);
+    if (timeline_overflows[core] > 0)
+      log_w("Core %u: %u events not recorded", core, timeline_overflows[core]);
+
+    // Extend the 32 bit cycle counter, events are in order per core
+    uint32_t last_cycles = timeline_anchor_cycles[core];
+    uint64_t cycles = 0;
+    for (uint32_t i = 0; i < timeline_counts[core]; i++)
+    {
+      const timeline_event_t *event = &timeline_events[core][i];
+      cycles += (uint32_t)(event->cycles - last_cycles);
+      last_cycles = event->cycles;
+      const double ts = timeline_anchor_us[core] + (double)cycles / cpu_mhz;
+      if (event->phase == TIMELINE_ASYNC_BEGIN || event->phase == TIMELINE_ASYNC_END)
+        log_printf("{\"name\":\"%s\",\"cat\":\"transfer\",\"id\":1,\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u},\n", event->name, event->phase, ts, core);
+      else
+        log_printf("{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u},\n", event->name, event->phase, ts, core);
+    }
+  }
+
+  // Last element without a trailing comma
+  log_printf("{\"name\":\"dump\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lld,\"pid\":0,\"tid\":0}\n]}\n# timeline end\n", esp_timer_get_time());
+#endif
+}
@@ -0,0 +1,113 @@
+#include <esp32_smartdisplay.h>
+#include <esp_timer.h>
+
+smartdisplay_trace_stats_t trace_stats;
+
+#if SMARTDISPLAY_TRACE_LEVEL > ARDUHAL_LOG_LEVEL_NONE
+
+// Interval for draining the ring buffer [ms]
+#ifndef SMARTDISPLAY_TRACE_DRAIN_PERIOD
+#define SMARTDISPLAY_TRACE_DRAIN_PERIOD 100
+#endif
+
+#define TRACE_DRAIN_TASK_STACK_SIZE 3072
+#define TRACE_MESSAGE_LENGTH 96
+
+_Static_assert((SMARTDISPLAY_TRACE_ENTRIES & (SMARTDISPLAY_TRACE_ENTRIES - 1)) == 0, "SMARTDISPLAY_TRACE_ENTRIES must be a power of 2");
+
+#define SMARTDISPLAY_TRACE_EVENT_FORMAT(id, format) format,
+const char *const trace_formats[SMARTDISPLAY_TRACE_EVENT_COUNT] = {SMARTDISPLAY_TRACE_EVENTS(SMARTDISPLAY_TRACE_EVENT_FORMAT)};
+#undef SMARTDISPLAY_TRACE_EVENT_FORMAT
+
+// Indexed by the ARDUHAL_LOG_LEVEL
+const char trace_level_chars[] = "NEWIDV";
+
+DRAM_ATTR smartdisplay_trace_entry_t trace_ring[SMARTDISPLAY_TRACE_ENTRIES];
+// Next entry to be reserved by the producers and next entry to be drained by the (single) consumer
+uint32_t trace_head;
+uint32_t trace_tail;
+TaskHandle_t trace_drain_task_handle;
+
+void IRAM_ATTR smartdisplay_trace_record(uint8_t level, uint16_t event, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+  // Reserve an entry, the newest entries are dropped when the ring buffer is full
+  uint32_t head = __atomic_load_n(&trace_head, __ATOMIC_RELAXED);
+  do
+  {
+    if (head - __atomic_load_n(&trace_tail, __ATOMIC_ACQUIRE) >= SMARTDISPLAY_TRACE_ENTRIES)
+    {
+      __atomic_fetch_add(&trace_stats.dropped, 1, __ATOMIC_RELAXED);
+      return;
+    }
+  } while (!__atomic_compare_exchange_n(&trace_head, &head, head + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  smartdisplay_trace_entry_t *entry = &trace_ring[head & (SMARTDISPLAY_TRACE_ENTRIES - 1)];
+  entry->timestamp = esp_timer_get_time();
+  entry->event = event;
+  entry->core = xPortGetCoreID();
+  entry->level = level;
+  entry->args[0] = arg0;
+  entry->args[1] = arg1;
+  entry->args[2] = arg2;
+  entry->args[3] = arg3;
+  // Publish the entry to the consumer
+  __atomic_store_n(&entry->sequence, head + 1, __ATOMIC_RELEASE);
+  __atomic_fetch_add(&trace_stats.recorded, 1, __ATOMIC_RELAXED);
+}
+
+void trace_print(const smartdisplay_trace_entry_t *entry)
+{
+#ifdef SMARTDISPLAY_TRACE_BINARY
+  // Raw entry, decoded by tools/smartdisplay_trace_decode.py
+  log_printf("#T %08x %08x %04x %02x %02x %08x %08x %08x %08x\n", entry->sequence, entry->timestamp, entry->event, entry->core, entry->level, entry->args[0], entry->args[1], entry->args[2], entry->args[3]);
+#else
+  char message[TRACE_MESSAGE_LENGTH];
+  if (entry->event < SMARTDISPLAY_TRACE_EVENT_COUNT)
+    snprintf(message, sizeof(message), trace_formats[entry->event], entry->args[0], entry->args[1], entry->args[2], entry->args[3]);
+  else
+    snprintf(message, sizeof(message), "event %u: %u, %u, %u, %u", entry->event, entry->args[0], entry->args[1], entry->args[2], entry->args[3]);
+
+  log_printf("[%10u][%c][%u] %s\n", entry->timestamp, trace_level_chars[entry->level], entry->core, message);
+#endif
+}
+
+void trace_drain()
+{
+  uint32_t tail = trace_tail;
+  while (tail != __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE))
+  {
+    const smartdisplay_trace_entry_t *entry = &trace_ring[tail & (SMARTDISPLAY_TRACE_ENTRIES - 1)];
+    // Reserved but not yet written
+    if (__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE) != tail + 1)
+      break;
+
+    trace_print(entry);
+    // Release the entry to the producers
+    __atomic_store_n(&trace_tail, ++tail, __ATOMIC_RELEASE);
+  }
+}
+
+void trace_drain_task(void *param)
+{
+  for (;;)
+  {
+    trace_drain();
+    vTaskDelay(pdMS_TO_TICKS(SMARTDISPLAY_TRACE_DRAIN_PERIOD));
+  }
+}
+
+void lvgl_trace_init()
+{
+  log_v("");
+
+  // Low priority so formatting the traces does not delay the rendering or touch
+  if (xTaskCreate(trace_drain_task, "smartdisplay_trace", TRACE_DRAIN_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, &trace_drain_task_handle) != pdPASS)
+    log_e("Unable to create the trace drain task");
+}
+
+#endif
+
+void smartdisplay_trace_get_stats(smartdisplay_trace_stats_t *stats)
+{
+  *stats = trace_stats;
+}
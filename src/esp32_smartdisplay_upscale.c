@@ -0,0 +1,91 @@
+#include <esp32_smartdisplay_upscale.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+bool smartdisplay_upscale_init(smartdisplay_upscale_t *upscale, int32_t width)
+{
+  upscale->rows[0] = heap_caps_malloc(width * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  upscale->rows[1] = heap_caps_malloc(width * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  upscale->carry = heap_caps_malloc(width * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  smartdisplay_upscale_reset(upscale);
+  return upscale->rows[0] != NULL && upscale->rows[1] != NULL && upscale->carry != NULL;
+}
+
+void smartdisplay_upscale_reset(smartdisplay_upscale_t *upscale)
+{
+  upscale->carried = false;
+}
+
+void smartdisplay_upscale_nearest(uint16_t *frame_buffer, int32_t frame_buffer_width, const lv_area_t *area, const uint16_t *src, uint32_t stride)
+{
+  const int32_t width = lv_area_get_width(area);
+  const int32_t height = lv_area_get_height(area);
+  // Two pixels per word, the rows in the frame buffer are aligned on even pixels
+  uint32_t *dest = (uint32_t *)(frame_buffer + 2 * area->y1 * frame_buffer_width + 2 * area->x1);
+  for (int32_t y = 0; y < height; y++, src += stride, dest += frame_buffer_width)
+  {
+    for (int32_t x = 0; x < width; x++)
+      dest[x] = src[x] | (uint32_t)src[x] << 16;
+
+    memcpy(dest + frame_buffer_width / 2, dest, width * sizeof(uint32_t));
+  }
+}
+
+// Average of two RGB565 pixels in each half word
+static inline uint32_t upscale_average(uint32_t a, uint32_t b)
+{
+  return (a & b) + (((a ^ b) & 0xf7def7de) >> 1);
+}
+
+// Pixel and the average with the next pixel, the last one is repeated
+static void upscale_expand_row(uint32_t *dest, const uint16_t *src, int32_t width)
+{
+  for (int32_t x = 0; x < width - 1; x++)
+    *dest++ = src[x] | upscale_average(src[x], src[x + 1]) << 16;
+
+  *dest = src[width - 1] | (uint32_t)src[width - 1] << 16;
+}
+
+static void upscale_average_row(uint32_t *dest, const uint32_t *row, const uint32_t *next, int32_t width)
+{
+  for (int32_t x = 0; x < width; x++)
+    dest[x] = upscale_average(row[x], next[x]);
+}
+
+int32_t smartdisplay_upscale_bilinear(smartdisplay_upscale_t *upscale, uint16_t *frame_buffer, int32_t frame_buffer_width, const lv_area_t *area, const uint16_t *src, uint32_t stride)
+{
+  const int32_t width = lv_area_get_width(area);
+  const int32_t height = lv_area_get_height(area);
+  uint32_t *dest = (uint32_t *)(frame_buffer + 2 * area->y1 * frame_buffer_width + 2 * area->x1);
+  int32_t first_row = 2 * area->y1;
+
+  upscale_expand_row(upscale->rows[0], src, width);
+  // The odd row below the previous area repeated its last row, interpolate it with this row
+  if (upscale->carried && upscale->carry_y == area->y1 - 1 && upscale->carry_x1 == area->x1 && upscale->carry_x2 == area->x2)
+  {
+    upscale_average_row(dest - frame_buffer_width / 2, upscale->carry, upscale->rows[0], width);
+    first_row--;
+  }
+
+  for (int32_t y = 0; y < height; y++, dest += frame_buffer_width)
+  {
+    const uint32_t *row = upscale->rows[y & 1];
+    const uint32_t *next = row;
+    if (y + 1 < height)
+    {
+      upscale_expand_row(upscale->rows[(y + 1) & 1], src + (y + 1) * stride, width);
+      next = upscale->rows[(y + 1) & 1];
+    }
+
+    memcpy(dest, row, width * sizeof(uint32_t));
+    upscale_average_row(dest + frame_buffer_width / 2, row, next, width);
+  }
+
+  // Until the area below is flushed, the last row is repeated
+  memcpy(upscale->carry, upscale->rows[(height - 1) & 1], width * sizeof(uint32_t));
+  upscale->carried = true;
+  upscale->carry_x1 = area->x1;
+  upscale->carry_x2 = area->x2;
+  upscale->carry_y = area->y2;
+  return first_row;
+}
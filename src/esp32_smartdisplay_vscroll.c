@@ -0,0 +1,318 @@
+#include <esp32_smartdisplay.h>
+#include <esp32_smartdisplay_scroll.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_commands.h>
+
+#ifdef SMARTDISPLAY_VSCROLL
+
+#if !defined(DISPLAY_ILI9341_SPI) && !defined(DISPLAY_ST7796_SPI) && !defined(DISPLAY_ST7789_SPI)
+#error "SMARTDISPLAY_VSCROLL is only supported for the ILI9341, ST7796 and ST7789 SPI panels"
+#endif
+
+#if defined(SMARTDISPLAY_SHADOW_BUFFER) || defined(SMARTDISPLAY_RENDER_L8)
+#error "SMARTDISPLAY_VSCROLL can not be combined with SMARTDISPLAY_SHADOW_BUFFER or SMARTDISPLAY_RENDER_L8"
+#endif
+
+// Rows of the panel memory
+#ifdef DISPLAY_ST7796_SPI
+#define VSCROLL_GRAM_ROWS 480
+#else
+#define VSCROLL_GRAM_ROWS 320
+#endif
+
+#ifdef DISPLAY_GAP_Y
+#define VSCROLL_GAP_Y DISPLAY_GAP_Y
+#else
+#define VSCROLL_GAP_Y 0
+#endif
+
+extern lv_display_t *display;
+
+lv_obj_t *vscroll_obj;
+int32_t vscroll_scroll_y;
+// Scroll area in display coordinates, height 0 if not defined
+smartdisplay_scroll_area_t vscroll_area = {.gram_rows = VSCROLL_GRAM_ROWS, .gap_y = VSCROLL_GAP_Y};
+lv_display_rotation_t vscroll_rotation;
+// Rows the content moved in the scroll area (modulo the height). The next offset is set at the first area of the refresh
+int32_t vscroll_offset;
+int32_t vscroll_offset_next;
+// Rows scrolled since the start of the last refresh
+int32_t vscroll_frame_dy;
+// Set the scroll area again at the first area of the refresh
+bool vscroll_redefine;
+bool vscroll_frame_started;
+// The refresh sends the content moved by the panel and the bytes sent in the scroll area
+bool vscroll_frame_scrolled;
+uint32_t vscroll_frame_bytes;
+// Replace the invalidation of the scrolled object by the exposed lines
+bool vscroll_crop;
+lv_area_t vscroll_exposed;
+// Color transfers to complete before the flush is ready
+volatile uint32_t vscroll_pending;
+
+#endif
+
+smartdisplay_vscroll_stats_t vscroll_stats;
+
+#ifdef SMARTDISPLAY_VSCROLL
+
+// Scroll area of the object. False if the panel rows are not vertical in the rotation or the object is not full width
+bool vscroll_get_area(lv_obj_t *obj, int32_t *y1, int32_t *height, bool *mirror)
+{
+  const lv_display_rotation_t rotation = lv_display_get_rotation(display);
+#ifdef DISPLAY_SOFTWARE_ROTATION
+  if (rotation != LV_DISPLAY_ROTATION_0)
+    return false;
+#endif
+  // See lvgl_display_resolution_changed_callback
+  const bool rotated = rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270;
+  if (rotated ? !DISPLAY_SWAP_XY : DISPLAY_SWAP_XY)
+    return false;
+
+  *mirror = rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_180 ? !DISPLAY_MIRROR_Y : DISPLAY_MIRROR_Y;
+
+  // The top and bottom border do not scroll
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+  const int32_t border_width = lv_obj_get_style_border_width(obj, LV_PART_MAIN);
+  const lv_border_side_t border_side = lv_obj_get_style_border_side(obj, LV_PART_MAIN);
+  if (border_side & LV_BORDER_SIDE_TOP)
+    coords.y1 += border_width;
+  if (border_side & LV_BORDER_SIDE_BOTTOM)
+    coords.y2 -= border_width;
+
+  coords.y1 = LV_MAX(coords.y1, 0);
+  coords.y2 = LV_MIN(coords.y2, lv_display_get_vertical_resolution(display) - 1);
+  if (coords.x1 > 0 || coords.x2 < lv_display_get_horizontal_resolution(display) - 1 || coords.y2 <= coords.y1)
+    return false;
+
+  *y1 = coords.y1;
+  *height = coords.y2 - coords.y1 + 1;
+  return true;
+}
+
+void vscroll_write_area()
+{
+  const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+  // Without scroll area the complete memory scrolls, at start address 0 the image is not moved
+  const int32_t tfa = vscroll_area.height > 0 ? smartdisplay_scroll_top_fixed_area(&vscroll_area) : 0;
+  const int32_t vsa = vscroll_area.height > 0 ? vscroll_area.height : VSCROLL_GRAM_ROWS;
+  const int32_t bfa = VSCROLL_GRAM_ROWS - tfa - vsa;
+  log_d("tfa: %d, vsa: %d, bfa: %d", tfa, vsa, bfa);
+  ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_VSCRDEF, (uint8_t[]){tfa >> 8, tfa, vsa >> 8, vsa, bfa >> 8, bfa}, 6));
+}
+
+void vscroll_write_start()
+{
+  const esp_lcd_panel_io_handle_t io_handle = display->driver_data;
+  const int32_t start = smartdisplay_scroll_start(&vscroll_area, vscroll_offset);
+  ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_VSCSAD, (uint8_t[]){start >> 8, start}, 2));
+}
+
+// The rows in the panel memory no longer match the display. Render the scroll area again
+void vscroll_reset()
+{
+  if (vscroll_area.height > 0)
+  {
+    const lv_area_t area = {.x1 = 0, .y1 = vscroll_area.y1, .x2 = lv_display_get_horizontal_resolution(display) - 1, .y2 = vscroll_area.y1 + vscroll_area.height - 1};
+    lv_inv_area(display, &area);
+  }
+
+  vscroll_redefine = true;
+}
+
+void vscroll_frame_start()
+{
+  if (display->rotation != vscroll_rotation)
+  {
+    // Rendered completely after rotating
+    vscroll_rotation = display->rotation;
+    vscroll_redefine = true;
+  }
+
+  if (vscroll_redefine)
+  {
+    vscroll_redefine = false;
+    vscroll_offset = vscroll_offset_next = 0;
+    vscroll_stats.active = vscroll_obj != NULL && vscroll_get_area(vscroll_obj, &vscroll_area.y1, &vscroll_area.height, &vscroll_area.mirror);
+    if (!vscroll_stats.active)
+      vscroll_area.height = 0;
+
+    vscroll_write_area();
+    vscroll_write_start();
+    return;
+  }
+
+  if (vscroll_offset_next != vscroll_offset)
+  {
+    vscroll_frame_scrolled = true;
+    vscroll_offset = vscroll_offset_next;
+    vscroll_write_start();
+  }
+}
+
+void vscroll_refresh_start(lv_event_t *event)
+{
+  vscroll_frame_started = false;
+  vscroll_frame_scrolled = false;
+  vscroll_frame_bytes = 0;
+  vscroll_crop = false;
+  vscroll_frame_dy = 0;
+}
+
+void vscroll_invalidate_area(lv_event_t *event)
+{
+  if (!vscroll_crop)
+    return;
+
+  // The invalidation of the scrolled object follows the scroll event
+  if (smartdisplay_scroll_crop(&vscroll_area, lv_display_get_horizontal_resolution(display), &vscroll_exposed, lv_event_get_param(event)))
+    vscroll_crop = false;
+}
+
+void vscroll_scroll_event(lv_event_t *event)
+{
+  const int32_t scroll_y = lv_obj_get_scroll_y(vscroll_obj);
+  const int32_t dy = scroll_y - vscroll_scroll_y;
+  vscroll_scroll_y = scroll_y;
+  if (dy == 0 || !vscroll_stats.active || vscroll_redefine)
+    return;
+
+  // Moved, resized or rotated
+  int32_t y1, height;
+  bool mirror;
+  if (display->rotation != vscroll_rotation || !vscroll_get_area(vscroll_obj, &y1, &height, &mirror) || y1 != vscroll_area.y1 || height != vscroll_area.height)
+  {
+    vscroll_reset();
+    vscroll_stats.fallbacks++;
+    return;
+  }
+
+  // Nothing to keep, or changes in the scroll area that can not be moved with the content. Otherwise the changes
+  // invalidated before the scroll are moved with the content
+  const int32_t width = lv_display_get_horizontal_resolution(display);
+  if (LV_ABS(vscroll_frame_dy + dy) >= vscroll_area.height || !smartdisplay_scroll_move_areas(&vscroll_area, width, dy, display->inv_areas, display->inv_p, &vscroll_exposed))
+  {
+    vscroll_stats.fallbacks++;
+    return;
+  }
+
+  vscroll_frame_dy += dy;
+  vscroll_offset_next = smartdisplay_scroll_offset(&vscroll_area, vscroll_offset_next, dy);
+
+  // The scrollbar does not move with the content. Invalidated before the crop, it is rendered completely
+  lv_area_t hor_area, ver_area;
+  lv_obj_get_scrollbar_area(vscroll_obj, &hor_area, &ver_area);
+  if (lv_area_get_width(&ver_area) > 0)
+  {
+    ver_area.y1 = vscroll_area.y1;
+    ver_area.y2 = vscroll_area.y1 + vscroll_area.height - 1;
+    lv_inv_area(display, &ver_area);
+  }
+
+  vscroll_crop = true;
+  vscroll_stats.scrolls++;
+  vscroll_stats.lines += LV_ABS(dy);
+}
+
+void vscroll_delete_event(lv_event_t *event)
+{
+  vscroll_obj = NULL;
+  vscroll_reset();
+}
+
+void lvgl_vscroll_init(lv_display_t *display)
+{
+  log_v("display:0x%08x", display);
+
+  vscroll_rotation = display->rotation;
+  lv_display_add_event_cb(display, vscroll_refresh_start, LV_EVENT_REFR_START, NULL);
+  lv_display_add_event_cb(display, vscroll_invalidate_area, LV_EVENT_INVALIDATE_AREA, NULL);
+}
+
+// Called by the SPI flush after byte swapping. Returns false if the area must be sent as usual
+bool lvgl_vscroll_flush(lv_display_t *display, const lv_area_t *area, const uint16_t *pixels)
+{
+  // Move the content before sending the exposed lines
+  if (!vscroll_frame_started)
+  {
+    vscroll_frame_started = true;
+    vscroll_frame_start();
+  }
+
+  // Saved are the bytes of the scroll area that were not sent in the refresh
+  vscroll_frame_bytes += smartdisplay_scroll_bytes(&vscroll_area, area, sizeof(uint16_t));
+  if (vscroll_frame_scrolled && lv_display_flush_is_last(display))
+  {
+    const uint32_t scroll_bytes = vscroll_area.height * lv_display_get_horizontal_resolution(display) * sizeof(uint16_t);
+    vscroll_stats.bytes_saved += scroll_bytes > vscroll_frame_bytes ? scroll_bytes - vscroll_frame_bytes : 0;
+  }
+
+  if (vscroll_area.height == 0 || vscroll_offset == 0 || area->y2 < vscroll_area.y1 || area->y1 > vscroll_area.y1 + vscroll_area.height - 1)
+    return false;
+
+  smartdisplay_scroll_window_t windows[SMARTDISPLAY_SCROLL_MAX_WINDOWS];
+  const uint32_t count = smartdisplay_scroll_windows(&vscroll_area, vscroll_offset, area, windows);
+
+  const esp_lcd_panel_handle_t panel_handle = display->user_data;
+  const int32_t width = lv_area_get_width(area);
+  vscroll_pending = count;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const smartdisplay_scroll_window_t *window = &windows[i];
+    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, window->dest_y, area->x2 + 1, window->dest_y + window->y2 - window->y1 + 1, pixels + (window->y1 - area->y1) * width));
+  }
+
+  return true;
+}
+
+// Called from the color transfer done ISR. Returns true when the last window of the area is sent
+bool IRAM_ATTR lvgl_vscroll_color_trans_done()
+{
+  if (vscroll_pending == 0)
+    return true;
+
+  return --vscroll_pending == 0;
+}
+
+#endif
+
+bool smartdisplay_vscroll_attach(lv_obj_t *obj)
+{
+  log_v("obj:0x%08x", obj);
+#ifdef SMARTDISPLAY_VSCROLL
+  smartdisplay_vscroll_detach();
+  lv_obj_update_layout(obj);
+  vscroll_obj = obj;
+  vscroll_scroll_y = lv_obj_get_scroll_y(obj);
+  lv_obj_add_event_cb(obj, vscroll_scroll_event, LV_EVENT_SCROLL, NULL);
+  lv_obj_add_event_cb(obj, vscroll_delete_event, LV_EVENT_DELETE, NULL);
+  // The panel memory matches the display, the scroll area is set at the next refresh
+  vscroll_redefine = true;
+  int32_t y1, height;
+  bool mirror;
+  return vscroll_get_area(obj, &y1, &height, &mirror);
+#else
+  return false;
+#endif
+}
+
+void smartdisplay_vscroll_detach()
+{
+#ifdef SMARTDISPLAY_VSCROLL
+  if (vscroll_obj == NULL)
+    return;
+
+  log_v("obj:0x%08x", vscroll_obj);
+  lv_obj_remove_event_cb(vscroll_obj, vscroll_scroll_event);
+  lv_obj_remove_event_cb(vscroll_obj, vscroll_delete_event);
+  vscroll_obj = NULL;
+  vscroll_reset();
+#endif
+}
+
+void smartdisplay_vscroll_get_stats(smartdisplay_vscroll_stats_t *stats)
+{
+  *stats = vscroll_stats;
+}
@@ -0,0 +1,137 @@
+#include <esp32_smartdisplay_window.h>
+#include <esp_attr.h>
+#include <esp_err.h>
+#include <esp_lcd_panel_ops.h>
+#include <math.h>
+#include <string.h>
+
+void smartdisplay_window_begin(smartdisplay_window_list_t *list, const lv_area_t *area)
+{
+  list->area = *area;
+  list->count = 0;
+  list->bytes = 0;
+}
+
+void smartdisplay_window_add(smartdisplay_window_list_t *list, int32_t y, int32_t x1, int32_t x2)
+{
+  const uint32_t row_bytes = (x2 - x1 + 1) * sizeof(uint16_t);
+  if (list->count > 0 && list->count <= list->max_windows)
+  {
+    smartdisplay_window_t *last = &list->windows[list->count - 1];
+    const uint32_t last_bytes = (last->x2 - last->x1 + 1) * (last->y2 - last->y1 + 1) * sizeof(uint16_t);
+    const uint32_t merged_bytes = (LV_MAX(last->x2, x2) - LV_MIN(last->x1, x1) + 1) * (y - last->y1 + 1) * sizeof(uint16_t);
+    if (last->y2 == y - 1 && merged_bytes <= last_bytes + row_bytes + list->window_cost)
+    {
+      list->bytes += merged_bytes - last_bytes;
+      *last = (smartdisplay_window_t){.x1 = LV_MIN(last->x1, x1), .y1 = last->y1, .x2 = LV_MAX(last->x2, x2), .y2 = y};
+      return;
+    }
+  }
+
+  if (list->count < list->max_windows)
+    list->windows[list->count] = (smartdisplay_window_t){.x1 = x1, .y1 = y, .x2 = x2, .y2 = y};
+
+  // Count on overflow to detect it
+  list->count++;
+  list->bytes += row_bytes;
+}
+
+void smartdisplay_window_add_changes(smartdisplay_window_list_t *list, int32_t y, const uint16_t *pixels, const uint16_t *gram)
+{
+  const int32_t width = lv_area_get_width(&list->area);
+  int32_t first = -1, last = -1;
+  for (int32_t x = 0; x < width; x++)
+  {
+    if (pixels[x] == gram[x])
+      continue;
+
+    if (first < 0)
+      first = x;
+    else if ((x - last - 1) * sizeof(uint16_t) > list->window_cost)
+    {
+      // Gap is more expensive than a new window
+      smartdisplay_window_add(list, y, first, last);
+      first = x;
+    }
+
+    last = x;
+  }
+
+  if (first >= 0)
+    smartdisplay_window_add(list, y, first, last);
+}
+
+void smartdisplay_window_end(smartdisplay_window_list_t *list, bool last)
+{
+  const uint32_t area_bytes = lv_area_get_size(&list->area) * sizeof(uint16_t);
+  if (list->count > list->max_windows || (list->count > 1 && list->bytes + (list->count - 1) * list->window_cost >= area_bytes))
+  {
+    list->windows[0] = (smartdisplay_window_t){.x1 = 0, .y1 = list->area.y1, .x2 = lv_area_get_width(&list->area) - 1, .y2 = list->area.y2};
+    list->count = 1;
+    list->bytes = area_bytes;
+  }
+
+  list->frame_bytes += area_bytes;
+  list->frame_bytes_sent += list->bytes;
+  list->frame_windows += list->count;
+  if (last)
+  {
+    list->stats.frame_bytes = list->frame_bytes;
+    list->stats.frame_bytes_sent = list->frame_bytes_sent;
+    list->stats.frame_windows = list->frame_windows;
+    list->stats.bytes_sent += list->frame_bytes_sent;
+    list->stats.bytes_saved += list->frame_bytes - list->frame_bytes_sent;
+    list->stats.frames++;
+    list->frame_bytes = list->frame_bytes_sent = list->frame_windows = 0;
+  }
+}
+
+bool smartdisplay_window_send(smartdisplay_window_list_t *list, esp_lcd_panel_handle_t panel_handle, uint16_t *pixels)
+{
+  if (list->count == 0)
+    return false;
+
+  // The windows are in order, so the rows only move to lower addresses
+  const int32_t width = lv_area_get_width(&list->area);
+  for (uint32_t i = 0; i < list->count; i++)
+  {
+    const smartdisplay_window_t *window = &list->windows[i];
+    const int32_t window_width = window->x2 - window->x1 + 1;
+    if (window_width == width)
+      continue;
+
+    uint16_t *dest = pixels + (window->y1 - list->area.y1) * width + window->x1;
+    for (int32_t y = window->y1 + 1; y <= window->y2; y++)
+      memmove(dest + (y - window->y1) * window_width, pixels + (y - list->area.y1) * width + window->x1, window_width * sizeof(uint16_t));
+  }
+
+  list->pending = list->count;
+  for (uint32_t i = 0; i < list->count; i++)
+  {
+    const smartdisplay_window_t *window = &list->windows[i];
+    ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, list->area.x1 + window->x1, window->y1, list->area.x1 + window->x2 + 1, window->y2 + 1, pixels + (window->y1 - list->area.y1) * width + window->x1));
+  }
+
+  return true;
+}
+
+bool IRAM_ATTR smartdisplay_window_trans_done(smartdisplay_window_list_t *list)
+{
+  if (list->pending == 0)
+    return true;
+
+  return --list->pending == 0;
+}
+
+void smartdisplay_window_circle(int32_t width, int32_t height, int16_t *x1, int16_t *x2)
+{
+  // Pixel centers inside the circle
+  const float radius = LV_MIN(width, height) / 2.0f;
+  for (int32_t y = 0; y < height; y++)
+  {
+    const float dy = y + 0.5f - height / 2.0f;
+    const float half_width = dy * dy < radius * radius ? sqrtf(radius * radius - dy * dy) : 0;
+    x1[y] = ceilf(width / 2.0f - half_width - 0.5f);
+    x2[y] = floorf(width / 2.0f + half_width - 0.5f);
+  }
+}
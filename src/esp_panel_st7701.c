@@ -322,4 +322,14 @@ esp_err_t esp_lcd_new_panel_st7701(const esp_lcd_panel_io_handle_t io, const esp
     return ESP_OK;
 }
 
+esp_err_t esp_lcd_panel_st7701_get_rgb_panel(esp_lcd_panel_handle_t panel, esp_lcd_panel_handle_t *rgb_panel)
+{
+    log_v("panel:0x%08x, rgb_panel:0x%08x", panel, rgb_panel);
+    if (panel == NULL || rgb_panel == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    *rgb_panel = ((st7701_panel_t *)panel)->lcd_panel;
+    return ESP_OK;
+}
+
 #endif
\ No newline at end of file
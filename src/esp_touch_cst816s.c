@@ -4,6 +4,7 @@
 #include <string.h>
 #include <esp_rom_gpio.h>
 #include <esp32-hal-log.h>
+#include <esp32_smartdisplay_trace.h>
 
 // Registers
 #define CST816S_GESTURE_REG 0x01
@@ -153,7 +154,6 @@ esp_err_t cst816s_enter_sleep(esp_lcd_touch_handle_t th)
 
 esp_err_t cst816s_read_data(esp_lcd_touch_handle_t th)
 {
-    log_v("th:0x%08x", th);
     if (th == NULL)
         return ESP_ERR_INVALID_ARG;
 
@@ -167,6 +167,7 @@ esp_err_t cst816s_read_data(esp_lcd_touch_handle_t th)
         return res;
     }
 
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_TOUCH_READ, buffer.fingerNum);
     portENTER_CRITICAL(&th->data.lock);
     if ((th->data.points = buffer.fingerNum) > 0)
     {
@@ -182,7 +183,6 @@ esp_err_t cst816s_read_data(esp_lcd_touch_handle_t th)
 
 bool cst816s_get_xy(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
 {
-    log_v("th:0x%08x, x:0x%08x, y:0x%08x, strength:0x%08x, point_num:0x%08x, max_point_num:%d", th, x, y, strength, point_num, max_point_num);
     if (th == NULL || x == NULL || y == NULL || point_num == NULL)
         return ESP_ERR_INVALID_ARG;
 
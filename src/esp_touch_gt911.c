@@ -4,6 +4,7 @@
 #include <string.h>
 #include <esp_rom_gpio.h>
 #include <esp32-hal-log.h>
+#include <esp32_smartdisplay_trace.h>
 
 // Registers
 const uint16_t GT911_KEYS_REG = 0x8093;
@@ -115,8 +116,6 @@ esp_err_t gt911_reset(esp_lcd_touch_handle_t th)
 // This function is called if the coordinates do not match the returned coordinates. This is the case for display having another form factor, e.g. 472x320
 void gt911_process_coordinates(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
 {
-    log_v("th:0x%08x, x:0x%08x, y:0x%08x, strength:0x%08x, point_num:0x%08x, max_point_num:%d", th, x, y, strength, point_num, max_point_num);
-
     portENTER_CRITICAL(&th->data.lock);
     uint8_t points_available = *point_num > max_point_num ? max_point_num : *point_num;
     for (uint8_t i = 0; i < points_available; i++)
@@ -124,7 +123,7 @@ void gt911_process_coordinates(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t
         // Correct the points for the info obtained from the GT911 and configured resolution
         x[i] = (x[i] * th->config.x_max) / gt911_resolution.x;
         y[i] = (y[i] * th->config.y_max) / gt911_resolution.y;
-        log_d("Processed coordinates: (%d,%d), area:%d", x[i], y[i], strength[i]);
+        smartdisplay_trace_d(SMARTDISPLAY_TRACE_TOUCH_POINT, i, x[i], y[i], strength[i]);
     }
 
     portEXIT_CRITICAL(&th->data.lock);
@@ -216,7 +215,6 @@ esp_err_t gt911_exit_sleep(esp_lcd_touch_handle_t th)
 
 esp_err_t gt911_read_data(esp_lcd_touch_handle_t th)
 {
-    log_v("th:0x%08x", th);
     if (th == NULL)
         return ESP_ERR_INVALID_ARG;
 
@@ -254,7 +252,7 @@ esp_err_t gt911_read_data(esp_lcd_touch_handle_t th)
         //  Check if data is present
         if (flags.number_points > 0)
         {
-            log_v("Points available: %d", flags.number_points);
+            smartdisplay_trace_v(SMARTDISPLAY_TRACE_TOUCH_READ, flags.number_points);
             // Read the number of touch points
             if (flags.number_points <= GT911_TOUCH_POINTS_MAX)
             {
@@ -269,7 +267,7 @@ esp_err_t gt911_read_data(esp_lcd_touch_handle_t th)
                 portENTER_CRITICAL(&th->data.lock);
                 for (uint8_t i = 0; i < points; i++)
                 {
-                    log_d("Point: #%d, event:%d, point:(%d,%d), area:%d", i, buffer.data.touch_points[i].event, buffer.data.touch_points[i].point.x, buffer.data.touch_points[i].point.y, buffer.data.touch_points[i].area);
+                    smartdisplay_trace_d(SMARTDISPLAY_TRACE_TOUCH_POINT, i, buffer.data.touch_points[i].point.x, buffer.data.touch_points[i].point.y, buffer.data.touch_points[i].area);
                     th->data.coords[i].x = buffer.data.touch_points[i].point.x;
                     th->data.coords[i].y = buffer.data.touch_points[i].point.y;
                     th->data.coords[i].strength = buffer.data.touch_points[i].area;
@@ -293,7 +291,6 @@ esp_err_t gt911_read_data(esp_lcd_touch_handle_t th)
 
 bool gt911_get_xy(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
 {
-    log_v("th:0x%08x, x:0x%08x, y:0x%08x, strength:0x%08x, point_num:0x%08x, max_point_num:%d", th, x, y, strength, point_num, max_point_num);
     if (th == NULL || x == NULL || y == NULL || point_num == NULL)
         return ESP_ERR_INVALID_ARG;
 
@@ -306,7 +303,7 @@ bool gt911_get_xy(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t *y, uint16_t
         if (strength != NULL)
             strength[i] = th->data.coords[i].strength;
 
-        log_d("Touch data: x:%d, y:%d, strength:%d", x[i], y[i], th->data.coords[i].strength);
+        smartdisplay_trace_d(SMARTDISPLAY_TRACE_TOUCH_POINT, i, x[i], y[i], th->data.coords[i].strength);
     }
 
     th->data.points = 0;
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <esp_rom_gpio.h>
 #include <esp32-hal-log.h>
+#include <esp32_smartdisplay_trace.h>
 
 // See datasheet XPT2046.pdf
 const uint8_t XPT2046_START_Z1_CONVERSION = 0xB1;  // S=1, ADDR=011, MODE=0 (12bits), SER/DFR=0, PD1=0, PD2=1
@@ -63,7 +64,6 @@ esp_err_t xpt2046_exit_sleep(esp_lcd_touch_handle_t th)
 
 esp_err_t xpt2046_read_data(esp_lcd_touch_handle_t th)
 {
-    log_v("th:0x%08x", th);
     if (th == NULL)
         return ESP_ERR_INVALID_ARG;
 
@@ -114,6 +114,7 @@ esp_err_t xpt2046_read_data(esp_lcd_touch_handle_t th)
         points = 1;
     }
 
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_TOUCH_READ, points);
     portENTER_CRITICAL(&th->data.lock);
     th->data.coords[0].x = x;
     th->data.coords[0].y = y;
@@ -126,7 +127,6 @@ esp_err_t xpt2046_read_data(esp_lcd_touch_handle_t th)
 
 bool xpt2046_get_xy(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
 {
-    log_v("th:0x%08x, x:0x%08x, y:0x%08x, strength:0x%08x, point_num:0x%08x, max_point_num:%d", th, x, y, strength, point_num, max_point_num);
     if (th == NULL || x == NULL || y == NULL || point_num == NULL)
         return ESP_ERR_INVALID_ARG;
 
@@ -139,7 +139,7 @@ bool xpt2046_get_xy(esp_lcd_touch_handle_t th, uint16_t *x, uint16_t *y, uint16_
         if (strength != NULL)
             strength[i] = th->data.coords[i].strength;
 
-        log_d("Touch data: x:%d, y:%d, area:%d", x[i], y[i], strength != NULL ? strength[i] : 0);
+        smartdisplay_trace_d(SMARTDISPLAY_TRACE_TOUCH_POINT, i, x[i], y[i], th->data.coords[i].strength);
     }
 
     th->data.points = 0;
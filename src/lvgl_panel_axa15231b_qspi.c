@@ -6,10 +6,20 @@
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
 
+#ifdef SMARTDISPLAY_IO_RECORDER
+extern esp_lcd_panel_io_handle_t lvgl_io_recorder_wrap(esp_lcd_panel_io_handle_t io, const char *name);
+#endif
+
+#ifdef SMARTDISPLAY_TIMELINE
+extern void lvgl_timeline_transfer_done();
+#endif
+
 bool axs15231b_color_trans_done(esp_lcd_panel_io_handle_t panel_io_handle, esp_lcd_panel_io_event_data_t *panel_io_event_data, void *user_ctx)
 {
-    log_v("panel_io_handle:0x%08x, panel_io_event_data:%0x%08x, user_ctx:0x%08x", panel_io_handle, panel_io_event_data, user_ctx);
-
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_FLUSH_DONE);
+#ifdef SMARTDISPLAY_TIMELINE
+    lvgl_timeline_transfer_done();
+#endif
     lv_display_t *display = user_ctx;
     lv_display_flush_ready(display);
     return false;
@@ -18,7 +28,7 @@ bool axs15231b_color_trans_done(esp_lcd_panel_io_handle_t panel_io_handle, esp_l
 void axs15231b_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
 {
     // Hardware rotation is supported
-    log_v("display:0x%08x, area:%0x%08x, color_map:0x%08x", display, area, px_map);
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_FLUSH, area->x1, area->y1, area->x2, area->y2);
 
     esp_lcd_panel_handle_t panel_handle = display->user_data;
     uint32_t pixels = lv_area_get_size(area);
@@ -94,6 +104,10 @@ lv_display_t *lvgl_lcd_init()
     
     esp_lcd_panel_io_handle_t io_handle;
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)AXS15231B_SPI_HOST, &io_spi_config, &io_handle));
+#ifdef SMARTDISPLAY_IO_RECORDER
+    // Record the command stream and bus traffic
+    io_handle = lvgl_io_recorder_wrap(io_handle, "axs15231b");
+#endif
 
     // Create axs15231b panel handle
     const esp_lcd_panel_dev_config_t panel_dev_config = {
@@ -125,6 +139,8 @@ lv_display_t *lvgl_lcd_init()
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
 
     display->user_data = panel_handle;
+    // Panel IO for commands outside of the esp_lcd_panel interface (sleep, ...)
+    display->driver_data = io_handle;
     display->flush_cb = axs15231b_lv_flush;
 
     return display;
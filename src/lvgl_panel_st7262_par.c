@@ -1,11 +1,66 @@
 #ifdef DISPLAY_ST7262_PAR
 
 #include <esp32_smartdisplay.h>
+#include <esp_idf_version.h>
 #include <esp_lcd_panel_rgb.h>
 #include <esp_lcd_panel_ops.h>
 
+#ifdef SMARTDISPLAY_RGB_DMA_COPY
+extern bool lvgl_rgb_dma_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+extern bool lvgl_rgb_dma_pending();
+#endif
+
+#ifdef SMARTDISPLAY_RGB_VSYNC
+extern bool lvgl_rgb_vsync_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+extern bool lvgl_rgb_vsync_frame_done();
+#endif
+
+#ifdef SMARTDISPLAY_RENDER_L8
+extern void lvgl_rgb_l8_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+extern bool lvgl_rgb_l8_bounce_empty(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx);
+#endif
+
+#ifdef SMARTDISPLAY_DRS
+extern bool lvgl_drs_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+#endif
+
+#ifdef SMARTDISPLAY_TIMELINE
+extern void lvgl_timeline_transfer_done();
+#endif
+
+extern void lvgl_rgb_bounce_frame_done();
+#if defined(ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX) && ESP_IDF_VERSION_MAJOR >= 5
+extern bool lvgl_rgb_bounce_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx);
+#endif
+
+// RGB panel for the esp_lcd_rgb_panel_* functions
+esp_lcd_panel_handle_t rgb_panel_handle;
+
+// Frame done (ESP-IDF 4.4) or vsync (ESP-IDF 5) interrupt
+#if ESP_IDF_VERSION_MAJOR >= 5
+bool direct_io_frame_trans_done(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+#else
 bool direct_io_frame_trans_done(esp_lcd_panel_handle_t panel, esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+#endif
 {
+    // Frame timing and underruns
+    lvgl_rgb_bounce_frame_done();
+
+#ifdef SMARTDISPLAY_RGB_VSYNC
+    // The flush is ready when the presented frame buffer is scanned out
+    if (!lvgl_rgb_vsync_frame_done())
+        return false;
+#endif
+#ifdef SMARTDISPLAY_RGB_DMA_COPY
+    // The flush is ready when the copy is complete
+    if (lvgl_rgb_dma_pending())
+        return false;
+#endif
+
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_FLUSH_DONE);
+#ifdef SMARTDISPLAY_TIMELINE
+    lvgl_timeline_transfer_done();
+#endif
     lv_display_t *display = user_ctx;
     lv_display_flush_ready(display);
     return false;
@@ -14,11 +69,34 @@ bool direct_io_frame_trans_done(esp_lcd_panel_handle_t panel, esp_lcd_rgb_panel_
 void direct_io_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
 {
     // Hardware rotation is not supported
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_FLUSH, area->x1, area->y1, area->x2, area->y2);
     const esp_lcd_panel_handle_t panel_handle = display->user_data;
 
+#ifdef SMARTDISPLAY_RENDER_L8
+    // Copied into the 8 bit frame buffer, expanded in the bounce buffers
+    lvgl_rgb_l8_flush(display, area, px_map);
+    lv_display_flush_ready(display);
+    return;
+#endif
+
     lv_display_rotation_t rotation = lv_display_get_rotation(display);
     if (rotation == LV_DISPLAY_ROTATION_0)
     {
+#ifdef SMARTDISPLAY_DRS
+        // Rendered at half resolution, upscaled into the frame buffer
+        if (lvgl_drs_flush(display, area, px_map))
+            return;
+#endif
+#ifdef SMARTDISPLAY_RGB_VSYNC
+        // Rendered in the frame buffer, flip at the next vsync
+        if (lvgl_rgb_vsync_flush(display, area, px_map))
+            return;
+#endif
+#ifdef SMARTDISPLAY_RGB_DMA_COPY
+        // Copy into the frame buffer by the GDMA
+        if (lvgl_rgb_dma_flush(display, area, px_map))
+            return;
+#endif
         ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map));
         return;
     }
@@ -98,13 +176,54 @@ lv_display_t *lvgl_lcd_init()
         // LV_COLOR_16_SWAP is handled by mapping of the data
         .data_gpio_nums = {ST7262_PANEL_CONFIG_DATA_R0, ST7262_PANEL_CONFIG_DATA_R1, ST7262_PANEL_CONFIG_DATA_R2, ST7262_PANEL_CONFIG_DATA_R3, ST7262_PANEL_CONFIG_DATA_R4, ST7262_PANEL_CONFIG_DATA_G0, ST7262_PANEL_CONFIG_DATA_G1, ST7262_PANEL_CONFIG_DATA_G2, ST7262_PANEL_CONFIG_DATA_G3, ST7262_PANEL_CONFIG_DATA_G4, ST7262_PANEL_CONFIG_DATA_G5, ST7262_PANEL_CONFIG_DATA_B0, ST7262_PANEL_CONFIG_DATA_B1, ST7262_PANEL_CONFIG_DATA_B2, ST7262_PANEL_CONFIG_DATA_B3, ST7262_PANEL_CONFIG_DATA_B4},
         .disp_gpio_num = ST7262_PANEL_CONFIG_DISP,
+#ifdef ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+        // Scan out from internal RAM, refilled from the frame buffer in PSRAM
+        .bounce_buffer_size_px = ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX,
+#endif
+#if defined(SMARTDISPLAY_RGB_VSYNC) && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+        // One frame buffer is scanned out while LVGL renders in the other
+        .num_fbs = 2,
+#endif
+#if ESP_IDF_VERSION_MAJOR >= 5
+        // The callbacks are registered after creating the panel
+#ifdef SMARTDISPLAY_RENDER_L8
+        // No frame buffer, the bounce buffers are filled from the 8 bit frame buffer
+        .flags = {.disp_active_low = ST7262_PANEL_CONFIG_FLAGS_DISP_ACTIVE_LOW, .no_fb = true}};
+#else
+        .flags = {.disp_active_low = ST7262_PANEL_CONFIG_FLAGS_DISP_ACTIVE_LOW, .fb_in_psram = ST7262_PANEL_CONFIG_FLAGS_FB_IN_PSRAM}};
+#endif
+#else
         .on_frame_trans_done = direct_io_frame_trans_done,
         .user_ctx = display,
         .flags = {.disp_active_low = ST7262_PANEL_CONFIG_FLAGS_DISP_ACTIVE_LOW, .relax_on_idle = ST7262_PANEL_CONFIG_FLAGS_RELAX_ON_IDLE, .fb_in_psram = ST7262_PANEL_CONFIG_FLAGS_FB_IN_PSRAM}};
-    log_d("rgb_panel_config: clk_src:%d, timings:{pclk_hz:%d, h_res:%d, v_res:%d, hsync_pulse_width:%d, hsync_back_porch:%d, hsync_front_porch:%d, vsync_pulse_width:%d, vsync_back_porch:%d, vsync_front_porch:%d, flags:{hsync_idle_low:%d, vsync_idle_low:%d, de_idle_high:%d, pclk_active_neg:%d, pclk_idle_high:%d}}, data_width:%d, sram_trans_align:%d, psram_trans_align:%d, hsync_gpio_num:%d, vsync_gpio_num:%d, de_gpio_num:%d, pclk_gpio_num:%d, data_gpio_nums:[%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,], disp_gpio_num:%d, on_frame_trans_done:0x%08x, user_ctx:0x%08x, flags:{disp_active_low:%d, relax_on_idle:%d, fb_in_psram:%d}", rgb_panel_config.clk_src, rgb_panel_config.timings.pclk_hz, rgb_panel_config.timings.h_res, rgb_panel_config.timings.v_res, rgb_panel_config.timings.hsync_pulse_width, rgb_panel_config.timings.hsync_back_porch, rgb_panel_config.timings.hsync_front_porch, rgb_panel_config.timings.vsync_pulse_width, rgb_panel_config.timings.vsync_back_porch, rgb_panel_config.timings.vsync_front_porch, rgb_panel_config.timings.flags.hsync_idle_low, rgb_panel_config.timings.flags.vsync_idle_low, rgb_panel_config.timings.flags.de_idle_high, rgb_panel_config.timings.flags.pclk_active_neg, rgb_panel_config.timings.flags.pclk_idle_high, rgb_panel_config.data_width, rgb_panel_config.sram_trans_align, rgb_panel_config.psram_trans_align, rgb_panel_config.hsync_gpio_num, rgb_panel_config.vsync_gpio_num, rgb_panel_config.de_gpio_num, rgb_panel_config.pclk_gpio_num, rgb_panel_config.data_gpio_nums[0], rgb_panel_config.data_gpio_nums[1], rgb_panel_config.data_gpio_nums[2], rgb_panel_config.data_gpio_nums[3], rgb_panel_config.data_gpio_nums[4], rgb_panel_config.data_gpio_nums[5], rgb_panel_config.data_gpio_nums[6], rgb_panel_config.data_gpio_nums[7], rgb_panel_config.data_gpio_nums[8], rgb_panel_config.data_gpio_nums[9], rgb_panel_config.data_gpio_nums[10], rgb_panel_config.data_gpio_nums[11], rgb_panel_config.data_gpio_nums[12], rgb_panel_config.data_gpio_nums[13], rgb_panel_config.data_gpio_nums[14], rgb_panel_config.data_gpio_nums[15], rgb_panel_config.disp_gpio_num, rgb_panel_config.on_frame_trans_done, rgb_panel_config.user_ctx, rgb_panel_config.flags.disp_active_low, rgb_panel_config.flags.relax_on_idle, rgb_panel_config.flags.fb_in_psram);
+#endif
+    log_d("rgb_panel_config: clk_src:%d, timings:{pclk_hz:%d, h_res:%d, v_res:%d, hsync_pulse_width:%d, hsync_back_porch:%d, hsync_front_porch:%d, vsync_pulse_width:%d, vsync_back_porch:%d, vsync_front_porch:%d, flags:{hsync_idle_low:%d, vsync_idle_low:%d, de_idle_high:%d, pclk_active_neg:%d, pclk_idle_high:%d}}, data_width:%d, sram_trans_align:%d, psram_trans_align:%d, hsync_gpio_num:%d, vsync_gpio_num:%d, de_gpio_num:%d, pclk_gpio_num:%d, data_gpio_nums:[%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,], disp_gpio_num:%d", rgb_panel_config.clk_src, rgb_panel_config.timings.pclk_hz, rgb_panel_config.timings.h_res, rgb_panel_config.timings.v_res, rgb_panel_config.timings.hsync_pulse_width, rgb_panel_config.timings.hsync_back_porch, rgb_panel_config.timings.hsync_front_porch, rgb_panel_config.timings.vsync_pulse_width, rgb_panel_config.timings.vsync_back_porch, rgb_panel_config.timings.vsync_front_porch, rgb_panel_config.timings.flags.hsync_idle_low, rgb_panel_config.timings.flags.vsync_idle_low, rgb_panel_config.timings.flags.de_idle_high, rgb_panel_config.timings.flags.pclk_active_neg, rgb_panel_config.timings.flags.pclk_idle_high, rgb_panel_config.data_width, rgb_panel_config.sram_trans_align, rgb_panel_config.psram_trans_align, rgb_panel_config.hsync_gpio_num, rgb_panel_config.vsync_gpio_num, rgb_panel_config.de_gpio_num, rgb_panel_config.pclk_gpio_num, rgb_panel_config.data_gpio_nums[0], rgb_panel_config.data_gpio_nums[1], rgb_panel_config.data_gpio_nums[2], rgb_panel_config.data_gpio_nums[3], rgb_panel_config.data_gpio_nums[4], rgb_panel_config.data_gpio_nums[5], rgb_panel_config.data_gpio_nums[6], rgb_panel_config.data_gpio_nums[7], rgb_panel_config.data_gpio_nums[8], rgb_panel_config.data_gpio_nums[9], rgb_panel_config.data_gpio_nums[10], rgb_panel_config.data_gpio_nums[11], rgb_panel_config.data_gpio_nums[12], rgb_panel_config.data_gpio_nums[13], rgb_panel_config.data_gpio_nums[14], rgb_panel_config.data_gpio_nums[15], rgb_panel_config.disp_gpio_num);
+#if ESP_IDF_VERSION_MAJOR >= 5
+    log_d("rgb_panel_config: flags:{disp_active_low:%d, fb_in_psram:%d, no_fb:%d}", rgb_panel_config.flags.disp_active_low, rgb_panel_config.flags.fb_in_psram, rgb_panel_config.flags.no_fb);
+#else
+    log_d("rgb_panel_config: on_frame_trans_done:0x%08x, user_ctx:0x%08x, flags:{disp_active_low:%d, relax_on_idle:%d, fb_in_psram:%d}", rgb_panel_config.on_frame_trans_done, rgb_panel_config.user_ctx, rgb_panel_config.flags.disp_active_low, rgb_panel_config.flags.relax_on_idle, rgb_panel_config.flags.fb_in_psram);
+#endif
     log_d("refresh rate: %d Hz", (ST7262_PANEL_CONFIG_TIMINGS_PCLK_HZ * ST7262_PANEL_CONFIG_DATA_WIDTH) / (ST7262_PANEL_CONFIG_TIMINGS_H_RES + ST7262_PANEL_CONFIG_TIMINGS_HSYNC_PULSE_WIDTH + ST7262_PANEL_CONFIG_TIMINGS_HSYNC_BACK_PORCH + ST7262_PANEL_CONFIG_TIMINGS_HSYNC_FRONT_PORCH) / (ST7262_PANEL_CONFIG_TIMINGS_V_RES + ST7262_PANEL_CONFIG_TIMINGS_VSYNC_PULSE_WIDTH + ST7262_PANEL_CONFIG_TIMINGS_VSYNC_BACK_PORCH + ST7262_PANEL_CONFIG_TIMINGS_VSYNC_FRONT_PORCH) / SOC_LCD_RGB_DATA_WIDTH);
+#ifdef ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+    log_d("bounce_buffer_size_px: %d", rgb_panel_config.bounce_buffer_size_px);
+#endif
     esp_lcd_panel_handle_t panel_handle;
     ESP_ERROR_CHECK(esp_lcd_new_rgb_panel(&rgb_panel_config, &panel_handle));
+    rgb_panel_handle = panel_handle;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    const esp_lcd_rgb_panel_event_callbacks_t rgb_panel_callbacks = {
+        .on_vsync = direct_io_frame_trans_done,
+#ifdef ST7262_PANEL_CONFIG_BOUNCE_BUFFER_SIZE_PX
+        // Underruns of the bounce buffers
+        .on_bounce_frame_finish = lvgl_rgb_bounce_frame_finish,
+#endif
+#ifdef SMARTDISPLAY_RENDER_L8
+        // No frame buffer, the bounce buffers are filled from the 8 bit frame buffer
+        .on_bounce_empty = lvgl_rgb_l8_bounce_empty,
+#endif
+    };
+    ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(rgb_panel_handle, &rgb_panel_callbacks, display));
+#endif
     ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
     ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
 #ifdef DISPLAY_IPS
@@ -7,8 +7,83 @@
 #include <esp_lcd_panel_vendor.h>
 #include <esp_lcd_panel_ops.h>
 
+#ifdef SMARTDISPLAY_IO_RECORDER
+extern esp_lcd_panel_io_handle_t lvgl_io_recorder_wrap(esp_lcd_panel_io_handle_t io, const char *name);
+#endif
+
+#ifdef SMARTDISPLAY_SPI_CLOCK_TUNE
+extern uint32_t lvgl_spi_clock_tune();
+#endif
+
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+extern bool lvgl_shadow_flush(lv_display_t *display, const lv_area_t *area, uint16_t *pixels);
+extern bool lvgl_shadow_color_trans_done();
+#endif
+
+#ifdef SMARTDISPLAY_RENDER_L8
+extern bool lvgl_l8_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+extern bool lvgl_l8_color_trans_done();
+#endif
+
+#ifdef SMARTDISPLAY_VSCROLL
+extern bool lvgl_vscroll_flush(lv_display_t *display, const lv_area_t *area, const uint16_t *pixels);
+extern bool lvgl_vscroll_color_trans_done();
+#endif
+
+#ifdef SMARTDISPLAY_SPI_BOUNCE
+extern bool lvgl_spi_bounce_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+extern bool lvgl_spi_bounce_color_trans_done();
+#endif
+
+#ifdef SMARTDISPLAY_FLUSH_PIPELINE
+extern bool lvgl_pipeline_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+extern bool lvgl_pipeline_color_trans_done();
+#endif
+
+#ifdef SMARTDISPLAY_TIMELINE
+extern void lvgl_timeline_transfer_done();
+#endif
+
+#ifdef SMARTDISPLAY_TE_GPIO
+extern void lvgl_te_wait(lv_display_t *display);
+extern void lvgl_te_transfer_done();
+#endif
+
 bool st7796_color_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
 {
+#ifdef SMARTDISPLAY_RENDER_L8
+    // Wait for the last chunk of the area
+    if (!lvgl_l8_color_trans_done())
+        return false;
+#endif
+#ifdef SMARTDISPLAY_SPI_BOUNCE
+    // Wait for the last chunk copied from PSRAM
+    if (!lvgl_spi_bounce_color_trans_done())
+        return false;
+#endif
+#ifdef SMARTDISPLAY_FLUSH_PIPELINE
+    // Wait for the last chunk of the area
+    if (!lvgl_pipeline_color_trans_done())
+        return false;
+#endif
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+    // Wait for the last changed span of the area
+    if (!lvgl_shadow_color_trans_done())
+        return false;
+#endif
+#ifdef SMARTDISPLAY_VSCROLL
+    // Wait for the last part of the area
+    if (!lvgl_vscroll_color_trans_done())
+        return false;
+#endif
+
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_FLUSH_DONE);
+#ifdef SMARTDISPLAY_TIMELINE
+    lvgl_timeline_transfer_done();
+#endif
+#ifdef SMARTDISPLAY_TE_GPIO
+    lvgl_te_transfer_done();
+#endif
     lv_display_t *display = user_ctx;
     lv_display_flush_ready(display);
     return false;
@@ -17,7 +92,24 @@ bool st7796_color_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_i
 void st7796_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
 {
     // Hardware rotation is supported
+    smartdisplay_trace_v(SMARTDISPLAY_TRACE_FLUSH, area->x1, area->y1, area->x2, area->y2);
     esp_lcd_panel_handle_t panel_handle = display->user_data;
+#ifdef SMARTDISPLAY_RENDER_L8
+    // Expanded to RGB565 (byte swapped) while sending
+    if (lvgl_l8_flush(display, area, px_map))
+        return;
+#endif
+#ifdef SMARTDISPLAY_SPI_BOUNCE
+    // Draw buffer in PSRAM, copied and swapped in chunks to internal DMA buffers
+    if (lvgl_spi_bounce_flush(display, area, px_map))
+        return;
+#endif
+#ifdef SMARTDISPLAY_FLUSH_PIPELINE
+    // Byte swapped in chunks, the next chunk while the previous one is sent
+    if (lvgl_pipeline_flush(display, area, px_map))
+        return;
+#endif
+
     uint32_t pixels = lv_area_get_size(area);
     uint16_t *p = (uint16_t *)px_map;
     while (pixels--)
@@ -26,6 +118,21 @@ void st7796_lv_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_m
         p++;
     }
 
+#ifdef SMARTDISPLAY_TE_GPIO
+    // Start writing the frame after the panel scanned the last line
+    lvgl_te_wait(display);
+#endif
+#ifdef SMARTDISPLAY_VSCROLL
+    // Rows in the hardware scroll area are moved in the panel memory
+    if (lvgl_vscroll_flush(display, area, (uint16_t *)px_map))
+        return;
+#endif
+#ifdef SMARTDISPLAY_SHADOW_BUFFER
+    // Send only the pixels that differ from the panel memory
+    if (lvgl_shadow_flush(display, area, (uint16_t *)px_map))
+        return;
+#endif
+
     ESP_ERROR_CHECK(esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map));
 };
 
@@ -51,12 +158,19 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     log_d("spi_bus_config: mosi_io_num:%d, miso_io_num:%d, sclk_io_num:%d, quadwp_io_num:%d, quadhd_io_num:%d, max_transfer_sz:%d, flags:0x%08x, intr_flags:0x%04x", spi_bus_config.mosi_io_num, spi_bus_config.miso_io_num, spi_bus_config.sclk_io_num, spi_bus_config.quadwp_io_num, spi_bus_config.quadhd_io_num, spi_bus_config.max_transfer_sz, spi_bus_config.flags, spi_bus_config.intr_flags);
     ESP_ERROR_CHECK_WITHOUT_ABORT(spi_bus_initialize(ST7796_SPI_HOST, &spi_bus_config, ST7796_SPI_DMA_CHANNEL));
 
+#ifdef SMARTDISPLAY_SPI_CLOCK_TUNE
+    // Highest pixel clock verified by reading back the panel memory
+    const uint32_t pclk_hz = lvgl_spi_clock_tune();
+#else
+    const uint32_t pclk_hz = ST7796_SPI_CONFIG_PCLK_HZ;
+#endif
+
     // Attach the LCD controller to the SPI bus
     const esp_lcd_panel_io_spi_config_t io_spi_config = {
         .cs_gpio_num = ST7796_SPI_CONFIG_CS,
         .dc_gpio_num = ST7796_SPI_CONFIG_DC,
         .spi_mode = ST7796_SPI_CONFIG_SPI_MODE,
-        .pclk_hz = ST7796_SPI_CONFIG_PCLK_HZ,
+        .pclk_hz = pclk_hz,
         .on_color_trans_done = st7796_color_trans_done,
         .user_ctx = display,
         .trans_queue_depth = ST7796_SPI_CONFIG_TRANS_QUEUE_DEPTH,
@@ -70,6 +184,10 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     log_d("io_spi_config: cs_gpio_num:%d, dc_gpio_num:%d, spi_mode:%d, pclk_hz:%d, trans_queue_depth:%d, user_ctx:0x%08x, on_color_trans_done:0x%08x, lcd_cmd_bits:%d, lcd_param_bits:%d, flags:{dc_as_cmd_phase:%d, dc_low_on_data:%d, octal_mode:%d, lsb_first:%d}", io_spi_config.cs_gpio_num, io_spi_config.dc_gpio_num, io_spi_config.spi_mode, io_spi_config.pclk_hz, io_spi_config.trans_queue_depth, io_spi_config.user_ctx, io_spi_config.on_color_trans_done, io_spi_config.lcd_cmd_bits, io_spi_config.lcd_param_bits, io_spi_config.flags.dc_as_cmd_phase, io_spi_config.flags.dc_low_on_data, io_spi_config.flags.octal_mode, io_spi_config.flags.lsb_first);
     esp_lcd_panel_io_handle_t io_handle;
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)ST7796_SPI_HOST, &io_spi_config, &io_handle));
+#ifdef SMARTDISPLAY_IO_RECORDER
+    // Record the command stream and bus traffic
+    io_handle = lvgl_io_recorder_wrap(io_handle, "st7796");
+#endif
 
     // Create st7796 panel handle
     const esp_lcd_panel_dev_config_t panel_dev_config = {
@@ -101,6 +219,8 @@ lv_display_t *lvgl_lcd_init(uint32_t hor_res, uint32_t ver_res)
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
 
     display->user_data = panel_handle;
+    // Panel IO for commands outside of the esp_lcd_panel interface (sleep, ...)
+    display->driver_data = io_handle;
     display->flush_cb = st7796_lv_flush;
 
     return display;
@@ -4,6 +4,10 @@
 #include <esp32_smartdisplay.h>
 #include "driver/i2c.h"
 
+#ifdef SMARTDISPLAY_IO_RECORDER
+extern esp_lcd_panel_io_handle_t lvgl_io_recorder_wrap(esp_lcd_panel_io_handle_t io, const char *name);
+#endif
+
 void cst816s_lvgl_touch_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
     esp_lcd_touch_handle_t touch_handle = indev->user_data;
@@ -21,7 +25,7 @@ void cst816s_lvgl_touch_cb(lv_indev_t *indev, lv_indev_data_t *data)
         data->point.x = x[0];
         data->point.y = y[0];
         data->state = LV_INDEV_STATE_PRESSED;
-        log_v("Pressed at: (%d,%d)", data->point.x, data->point.y);
+        smartdisplay_trace_v(SMARTDISPLAY_TRACE_TOUCH_PRESSED, data->point.x, data->point.y);
     }
     else
         data->state = LV_INDEV_STATE_RELEASED;
@@ -60,6 +64,10 @@ lv_indev_t *lvgl_touch_init()
     log_d("io_i2c_config: dev_addr:0x%02x, control_phase_bytes:%d, user_ctx:0x%08x, dc_bit_offset:%d, lcd_cmd_bits:%d, lcd_param_bits:%d, flags:{.dc_low_on_data:%d, disable_control_phase:%d}", io_i2c_config.dev_addr, io_i2c_config.control_phase_bytes, io_i2c_config.user_ctx, io_i2c_config.dc_bit_offset, io_i2c_config.lcd_cmd_bits, io_i2c_config.lcd_param_bits, io_i2c_config.flags.dc_low_on_data, io_i2c_config.flags.disable_control_phase);
     esp_lcd_panel_io_handle_t io_handle;
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)CST816S_I2C_HOST, &io_i2c_config, &io_handle));
+#ifdef SMARTDISPLAY_IO_RECORDER
+    // Record the command stream and bus traffic
+    io_handle = lvgl_io_recorder_wrap(io_handle, "cst816s");
+#endif
 
     // Create touch configuration
     const esp_lcd_touch_config_t touch_config = {
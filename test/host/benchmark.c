@@ -0,0 +1,143 @@
+// Renders the scenes of smartdisplay_benchmark_run() through the SPI panel driver of the configuration (the *_lv_flush
+// and *_color_trans_done paths of lvgl_panel_<panel>_spi.c and esp_panel_<panel>.c) to a panel IO that times the
+// transactions at the pixel clock. The board is set by the compile definitions, see CMakeLists.txt.
+//
+// Every frame renders the complete screen, so the bus traffic does not depend on the invalidation of the scenes. The
+// table is compared with the baseline by tools/smartdisplay_benchmark.py:
+//   scene,fps,bus_pct,render_ms,bytes,transactions
+// fps is the frame rate the bus can carry, bus_pct the bus time of a frame relative to the LVGL refresh period and
+// render_ms the CPU time of the host per frame without the flush. Bytes and transactions per frame include the commands.
+// The render time depends on the host and is not in the baseline.
+#include <esp32_smartdisplay.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+
+// Frames rendered before measuring (loading the scene) and measured per scene
+#define BENCHMARK_WARMUP_FRAMES 2
+#define BENCHMARK_FRAMES 30
+// Setup of a transaction (queueing, CS and DC) [us]
+#define TIMED_BUS_TRANSACTION_US 5.0
+
+extern lv_display_t *lvgl_lcd_init();
+// Scenes and measurements of smartdisplay_benchmark_run()
+extern const char *const benchmark_scene_names[SMARTDISPLAY_BENCHMARK_SCENES];
+extern uint32_t benchmark_frames;
+extern int64_t benchmark_render_time, benchmark_flush_time, benchmark_wait_time;
+extern void benchmark_display_event(lv_event_t *event);
+extern void benchmark_create_scene(lv_obj_t *screen, smartdisplay_benchmark_scene_t scene);
+
+lv_display_t *display;
+
+// Timed panel IO: a transaction is complete when started, the time it takes on the bus is accumulated
+struct esp_lcd_panel_io_t
+{
+    esp_lcd_panel_io_spi_config_t config;
+};
+
+struct esp_lcd_panel_io_t timed_bus_io;
+double timed_bus_us;
+uint64_t timed_bus_bytes;
+uint32_t timed_bus_transactions;
+
+void timed_bus_transfer(esp_lcd_panel_io_handle_t io, size_t size)
+{
+    const size_t bytes = io->config.lcd_cmd_bits / 8 + size;
+    timed_bus_us += TIMED_BUS_TRANSACTION_US + bytes * 8 * 1e6 / io->config.pclk_hz;
+    timed_bus_bytes += bytes;
+    timed_bus_transactions++;
+}
+
+esp_err_t esp_lcd_new_panel_io_spi(esp_lcd_spi_bus_handle_t bus, const esp_lcd_panel_io_spi_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io)
+{
+    timed_bus_io.config = *io_config;
+    *ret_io = &timed_bus_io;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
+{
+    timed_bus_transfer(io, param_size);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size)
+{
+    timed_bus_transfer(io, color_size);
+    // Transfer done interrupt
+    esp_lcd_panel_io_event_data_t edata;
+    io->config.on_color_trans_done(io, &edata, io->config.user_ctx);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel) { return panel->reset(panel); }
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel) { return panel->init(panel); }
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data) { return panel->draw_bitmap(panel, x_start, y_start, x_end, y_end, color_data); }
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool invert_color_data) { return panel->invert_color(panel, invert_color_data); }
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y) { return panel->mirror(panel, mirror_x, mirror_y); }
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes) { return panel->swap_xy(panel, swap_axes); }
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap, int y_gap) { return panel->set_gap(panel, x_gap, y_gap); }
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off) { return panel->disp_off(panel, !on_off); }
+
+void benchmark_frame(lv_obj_t *screen)
+{
+    lv_tick_inc(LV_DEF_REFR_PERIOD);
+    // The changes of the scene are inside the screen
+    lv_obj_invalidate(screen);
+    // Runs the animations and renders
+    lv_refr_now(display);
+}
+
+// Returns false if not every frame was rendered
+bool benchmark_scene(smartdisplay_benchmark_scene_t scene)
+{
+    lv_obj_t *previous_screen = lv_screen_active();
+    lv_obj_t *screen = lv_obj_create(NULL);
+    benchmark_create_scene(screen, scene);
+    lv_screen_load(screen);
+    for (uint32_t i = 0; i < BENCHMARK_WARMUP_FRAMES; i++)
+        benchmark_frame(screen);
+
+    benchmark_frames = 0;
+    benchmark_render_time = benchmark_flush_time = benchmark_wait_time = 0;
+    timed_bus_us = 0;
+    timed_bus_bytes = 0;
+    timed_bus_transactions = 0;
+    lv_display_add_event_cb(display, benchmark_display_event, LV_EVENT_ALL, NULL);
+    for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+        benchmark_frame(screen);
+
+    lv_display_remove_event_cb_with_user_data(display, benchmark_display_event, NULL);
+    lv_screen_load(previous_screen);
+    lv_obj_delete(screen);
+
+    const uint32_t frames = LV_MAX(benchmark_frames, 1);
+    const double bus_us = timed_bus_us / frames;
+    // Render time without the flush, as measured on the device
+    const double render_ms = (benchmark_render_time - benchmark_flush_time - benchmark_wait_time) / 1000.0 / frames;
+    printf("%s,%.2f,%.1f,%.3f,%llu,%u\n", benchmark_scene_names[scene], 1e6 / bus_us, bus_us / 10 / LV_DEF_REFR_PERIOD, render_ms, (unsigned long long)(timed_bus_bytes / frames), timed_bus_transactions / frames);
+    if (benchmark_frames != BENCHMARK_FRAMES)
+    {
+        fprintf(stderr, "%s: %u of %u frames rendered\n", benchmark_scene_names[scene], benchmark_frames, BENCHMARK_FRAMES);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    lv_init();
+    display = lvgl_lcd_init();
+
+    bool rendered = true;
+    printf("scene,fps,bus_pct,render_ms,bytes,transactions\n");
+    for (int scene = 0; scene < SMARTDISPLAY_BENCHMARK_SCENES; scene++)
+        rendered &= benchmark_scene((smartdisplay_benchmark_scene_t)scene);
+
+    return rendered ? 0 : 1;
+}
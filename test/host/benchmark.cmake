@@ -0,0 +1,19 @@
+# Runs a benchmark configuration and compares the result with the baseline, or updates the baseline with UPDATE=ON
+execute_process(COMMAND ${BENCHMARK} OUTPUT_FILE ${OUTPUT} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Benchmark ${BENCHMARK} failed")
+endif()
+
+if(UPDATE)
+    execute_process(COMMAND ${PYTHON} ${TOOL} ${OUTPUT} --update ${BASELINE} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Update of ${BASELINE} failed")
+    endif()
+    return()
+endif()
+
+# The bus traffic is deterministic, the tolerance only covers the last digit of the table
+execute_process(COMMAND ${PYTHON} ${TOOL} ${OUTPUT} --baseline ${BASELINE} --tolerance 0.5 RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Benchmark result ${OUTPUT} regressed from ${BASELINE}")
+endif()
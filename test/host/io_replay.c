@@ -0,0 +1,268 @@
+// Replays a scripted scene or touch trace through the panel and touch drivers with a recording panel IO.
+// The recording is printed in the format of smartdisplay_io_recorder_dump() and compared with a golden recording by
+// tools/smartdisplay_io_diff.py. Usage: io_replay <scene>
+//
+// Scene commands, one per line (# starts a comment). Coordinates of fill are inclusive like the LVGL areas:
+//   panel <st7796|gc9a01|ili9341> [bgr]   create the panel with the recording IO named after the controller
+//   reset | init | disp <on|off> | invert <0|1> | mirror <x> <y> | swap_xy <0|1> | gap <x> <y>
+//   fill <x1> <y1> <x2> <y2> <rgb565>     draw a rectangle in a solid color
+//   poke <io> <register> <byte>...        set the registers returned by rx_param of the IO
+//   touch <gt911|cst816s> <x_max> <y_max> create the touch controller with the recording IO named after the controller
+//   read                                  read the touch controller
+//   expect <points> [<x> <y>]...          the touch points that must be returned after the read
+#include <esp_panel_gc9a01.h>
+#include <esp_panel_ili9341.h>
+#include <esp_panel_st7796.h>
+#include <esp_touch_cst816s.h>
+#include <esp_touch_gt911.h>
+#include <esp_lcd_panel_interface.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAX_IO 4
+#define REPLAY_MAX_ARGS 16
+
+typedef enum
+{
+    REPLAY_RX_PARAM,
+    REPLAY_TX_PARAM,
+    REPLAY_TX_COLOR
+} replay_op_t;
+
+const char *const replay_op_names[] = {"rx_param", "tx_param", "tx_color"};
+
+// Recording panel IO, the registers are the data returned by rx_param
+struct esp_lcd_panel_io_t
+{
+    const char *name;
+    uint8_t registers[0x10000];
+};
+
+typedef struct
+{
+    const char *io;
+    replay_op_t op;
+    int cmd;
+    size_t size;
+    uint32_t crc;
+} replay_entry_t;
+
+struct esp_lcd_panel_io_t replay_ios[REPLAY_MAX_IO];
+uint8_t replay_io_count;
+replay_entry_t *replay_entries;
+size_t replay_count, replay_capacity;
+
+// CRC32 as calculated by esp_rom_crc32_le(0, data, size) in the recorder
+uint32_t replay_crc32(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xffffffff;
+    while (size--)
+    {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+
+    return ~crc;
+}
+
+void replay_add(esp_lcd_panel_io_handle_t io, replay_op_t op, int cmd, const void *data, size_t size)
+{
+    if (replay_count == replay_capacity)
+    {
+        replay_capacity = replay_capacity ? replay_capacity * 2 : 256;
+        replay_entries = realloc(replay_entries, replay_capacity * sizeof(replay_entry_t));
+    }
+
+    replay_entries[replay_count++] = (replay_entry_t){.io = io->name, .op = op, .cmd = cmd, .size = size, .crc = data != NULL ? replay_crc32(data, size) : 0};
+}
+
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size)
+{
+    if (lcd_cmd < 0 || lcd_cmd + param_size > sizeof(io->registers))
+        return ESP_ERR_INVALID_ARG;
+
+    replay_add(io, REPLAY_RX_PARAM, lcd_cmd, NULL, param_size);
+    memcpy(param, io->registers + lcd_cmd, param_size);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
+{
+    replay_add(io, REPLAY_TX_PARAM, lcd_cmd, param, param_size);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size)
+{
+    replay_add(io, REPLAY_TX_COLOR, lcd_cmd, color, color_size);
+    return ESP_OK;
+}
+
+esp_lcd_panel_io_handle_t replay_io(const char *name)
+{
+    for (uint8_t i = 0; i < replay_io_count; i++)
+        if (strcmp(replay_ios[i].name, name) == 0)
+            return &replay_ios[i];
+
+    if (replay_io_count == REPLAY_MAX_IO)
+        return NULL;
+
+    replay_ios[replay_io_count].name = strdup(name);
+    return &replay_ios[replay_io_count++];
+}
+
+// The panel bits per pixel are always RGB565, the color is sent in the byte order of the flush (big endian)
+esp_err_t replay_fill(esp_lcd_panel_handle_t panel, int x1, int y1, int x2, int y2, uint16_t color)
+{
+    const size_t pixels = (size_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    uint8_t *data = malloc(pixels * 2);
+    for (size_t i = 0; i < pixels; i++)
+    {
+        data[i * 2] = color >> 8;
+        data[i * 2 + 1] = color;
+    }
+
+    const esp_err_t res = panel->draw_bitmap(panel, x1, y1, x2 + 1, y2 + 1, data);
+    free(data);
+    return res;
+}
+
+// Returns false on an unknown command, wrong arguments, a failed driver call or an unexpected touch point
+bool replay_command(int argc, char **argv, esp_lcd_panel_handle_t *panel, esp_lcd_touch_handle_t *touch)
+{
+    const char *command = argv[0];
+    long args[REPLAY_MAX_ARGS];
+    for (int i = 1; i < argc; i++)
+        args[i - 1] = strtol(argv[i], NULL, 0);
+
+    if (strcmp(command, "panel") == 0 && argc >= 2)
+    {
+        const esp_lcd_panel_dev_config_t config = {
+            .reset_gpio_num = GPIO_NUM_NC,
+            .color_space = argc >= 3 && strcmp(argv[2], "bgr") == 0 ? ESP_LCD_COLOR_SPACE_BGR : ESP_LCD_COLOR_SPACE_RGB,
+            .bits_per_pixel = 16};
+        esp_lcd_panel_io_handle_t io = replay_io(argv[1]);
+        if (strcmp(argv[1], "st7796") == 0)
+            return esp_lcd_new_panel_st7796(io, &config, panel) == ESP_OK;
+        if (strcmp(argv[1], "gc9a01") == 0)
+            return esp_lcd_new_panel_gc9a01(io, &config, panel) == ESP_OK;
+        if (strcmp(argv[1], "ili9341") == 0)
+            return esp_lcd_new_panel_ili9341(io, &config, panel) == ESP_OK;
+        return false;
+    }
+
+    if (strcmp(command, "touch") == 0 && argc == 4)
+    {
+        const esp_lcd_touch_config_t config = {.x_max = args[1], .y_max = args[2], .rst_gpio_num = GPIO_NUM_NC, .int_gpio_num = GPIO_NUM_NC};
+        esp_lcd_panel_io_handle_t io = replay_io(argv[1]);
+        if (strcmp(argv[1], "gt911") == 0)
+            return esp_lcd_touch_new_i2c_gt911(io, &config, touch) == ESP_OK;
+        if (strcmp(argv[1], "cst816s") == 0)
+            return esp_lcd_touch_new_i2c_cst816s(io, &config, touch) == ESP_OK;
+        return false;
+    }
+
+    if (strcmp(command, "poke") == 0 && argc >= 4)
+    {
+        esp_lcd_panel_io_handle_t io = replay_io(argv[1]);
+        if (io == NULL || args[1] < 0 || args[1] + argc - 3 > (long)sizeof(io->registers))
+            return false;
+
+        for (int i = 3; i < argc; i++)
+            io->registers[args[1] + i - 3] = args[i - 1];
+        return true;
+    }
+
+    if (strcmp(command, "read") == 0 && argc == 1 && *touch != NULL)
+        return esp_lcd_touch_read_data(*touch) == ESP_OK;
+
+    if (strcmp(command, "expect") == 0 && argc >= 2 && argc == 2 + args[0] * 2 && *touch != NULL)
+    {
+        uint16_t x[CONFIG_ESP_LCD_TOUCH_MAX_POINTS], y[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+        uint8_t points = 0;
+        esp_lcd_touch_get_coordinates(*touch, x, y, NULL, &points, CONFIG_ESP_LCD_TOUCH_MAX_POINTS);
+        bool match = points == args[0];
+        for (uint8_t i = 0; match && i < points; i++)
+            match = x[i] == args[1 + i * 2] && y[i] == args[2 + i * 2];
+
+        if (!match)
+            fprintf(stderr, "Expected %ld touch points, got %u (%u,%u)\n", args[0], points, points > 0 ? x[0] : 0, points > 0 ? y[0] : 0);
+
+        return match;
+    }
+
+    // Panel operations
+    if (*panel == NULL)
+        return false;
+
+    if (strcmp(command, "reset") == 0 && argc == 1)
+        return (*panel)->reset(*panel) == ESP_OK;
+    if (strcmp(command, "init") == 0 && argc == 1)
+        return (*panel)->init(*panel) == ESP_OK;
+    if (strcmp(command, "disp") == 0 && argc == 2)
+        return (*panel)->disp_off(*panel, strcmp(argv[1], "off") == 0) == ESP_OK;
+    if (strcmp(command, "invert") == 0 && argc == 2)
+        return (*panel)->invert_color(*panel, args[0]) == ESP_OK;
+    if (strcmp(command, "mirror") == 0 && argc == 3)
+        return (*panel)->mirror(*panel, args[0], args[1]) == ESP_OK;
+    if (strcmp(command, "swap_xy") == 0 && argc == 2)
+        return (*panel)->swap_xy(*panel, args[0]) == ESP_OK;
+    if (strcmp(command, "gap") == 0 && argc == 3)
+        return (*panel)->set_gap(*panel, args[0], args[1]) == ESP_OK;
+    if (strcmp(command, "fill") == 0 && argc == 6)
+        return replay_fill(*panel, args[0], args[1], args[2], args[3], args[4]) == ESP_OK;
+
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <scene>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *scene = fopen(argv[1], "r");
+    if (scene == NULL)
+    {
+        fprintf(stderr, "Unable to open %s\n", argv[1]);
+        return 2;
+    }
+
+    esp_lcd_panel_handle_t panel = NULL;
+    esp_lcd_touch_handle_t touch = NULL;
+    char line[256];
+    for (int line_number = 1; fgets(line, sizeof(line), scene) != NULL; line_number++)
+    {
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+
+        char *command_argv[REPLAY_MAX_ARGS + 1];
+        int command_argc = 0;
+        for (char *token = strtok(line, " \t\r\n"); token != NULL && command_argc <= REPLAY_MAX_ARGS; token = strtok(NULL, " \t\r\n"))
+            command_argv[command_argc++] = token;
+
+        if (command_argc > 0 && !replay_command(command_argc, command_argv, &panel, &touch))
+        {
+            fprintf(stderr, "%s:%d: %s failed\n", argv[1], line_number, command_argv[0]);
+            return 1;
+        }
+    }
+
+    fclose(scene);
+
+    // Same format as smartdisplay_io_recorder_dump()
+    printf("# io_recorder entries:%zu overflows:0\n", replay_count);
+    for (size_t i = 0; i < replay_count; i++)
+    {
+        const replay_entry_t *entry = &replay_entries[i];
+        printf("%s %s 0x%02x %zu 0x%08x\n", entry->io, replay_op_names[entry->op], entry->cmd, entry->size, entry->crc);
+    }
+
+    printf("# end\n");
+    return 0;
+}
@@ -0,0 +1,15 @@
+# Replays a scene and compares the recording with the golden recording, or updates the golden recording with UPDATE=ON
+execute_process(COMMAND ${REPLAY} ${SCENE} OUTPUT_FILE ${OUTPUT} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Replay of ${SCENE} failed")
+endif()
+
+if(UPDATE)
+    configure_file(${OUTPUT} ${GOLDEN} COPYONLY)
+    return()
+endif()
+
+execute_process(COMMAND ${PYTHON} ${DIFF} ${GOLDEN} ${OUTPUT} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Recording of ${SCENE} differs from ${GOLDEN}")
+endif()
@@ -0,0 +1,17 @@
+#pragma once
+
+// The parts of the Arduino core used by the library, for the host benchmark
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <esp32-hal-log.h>
+
+#define log_printf printf
+
+static inline uint32_t millis() { return (uint32_t)(esp_timer_get_time() / 1000); }
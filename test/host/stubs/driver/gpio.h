@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC -1
+#define GPIO_IS_VALID_GPIO(gpio_num) ((gpio_num) >= 0 && (gpio_num) < 49)
+#define BIT64(nr) (1ULL << (nr))
+
+typedef enum
+{
+    GPIO_MODE_DISABLE,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+    GPIO_MODE_OUTPUT_OD
+} gpio_mode_t;
+
+typedef enum
+{
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE
+} gpio_int_type_t;
+
+typedef struct
+{
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    int pull_up_en;
+    int pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void *arg);
+
+static inline esp_err_t gpio_config(const gpio_config_t *config) { return ESP_OK; }
+static inline esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) { return ESP_OK; }
+static inline esp_err_t gpio_reset_pin(gpio_num_t gpio_num) { return ESP_OK; }
+static inline esp_err_t gpio_install_isr_service(int flags) { return ESP_OK; }
+static inline esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) { return ESP_OK; }
+static inline esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) { return ESP_OK; }
+static inline esp_err_t gpio_intr_enable(gpio_num_t gpio_num) { return ESP_OK; }
+static inline esp_err_t gpio_intr_disable(gpio_num_t gpio_num) { return ESP_OK; }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+#include <driver/gpio.h>
+
+typedef enum
+{
+    SPI1_HOST,
+    SPI2_HOST,
+    SPI3_HOST
+} spi_host_device_t;
+
+typedef enum
+{
+    SPI_DMA_DISABLED,
+    SPI_DMA_CH1,
+    SPI_DMA_CH2,
+    SPI_DMA_CH_AUTO
+} spi_dma_chan_t;
+
+typedef struct
+{
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+    int intr_flags;
+} spi_bus_config_t;
+
+static inline esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan) { return ESP_OK; }
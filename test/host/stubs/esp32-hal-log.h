@@ -0,0 +1,14 @@
+#pragma once
+
+#define ARDUHAL_LOG_LEVEL_NONE (0)
+#define ARDUHAL_LOG_LEVEL_ERROR (1)
+#define ARDUHAL_LOG_LEVEL_WARN (2)
+#define ARDUHAL_LOG_LEVEL_INFO (3)
+#define ARDUHAL_LOG_LEVEL_DEBUG (4)
+#define ARDUHAL_LOG_LEVEL_VERBOSE (5)
+
+#define log_v(format, ...)
+#define log_d(format, ...)
+#define log_i(format, ...)
+#define log_w(format, ...)
+#define log_e(format, ...)
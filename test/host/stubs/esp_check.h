@@ -0,0 +1,11 @@
+#pragma once
+
+#include <esp_err.h>
+
+#define ESP_RETURN_ON_ERROR(x, log_tag, format, ...) \
+    do \
+    { \
+        const esp_err_t err_rc_ = (x); \
+        if (err_rc_ != ESP_OK) \
+            return err_rc_; \
+    } while (0)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <esp_lcd_types.h>
+
+typedef struct
+{
+    int reset_gpio_num;
+    esp_lcd_color_space_t color_space;
+    unsigned int bits_per_pixel;
+    struct
+    {
+        unsigned int reset_active_high : 1;
+    } flags;
+    void *vendor_config;
+} esp_lcd_panel_dev_config_t;
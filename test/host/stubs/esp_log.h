@@ -0,0 +1,7 @@
+#pragma once
+
+#define ESP_LOGE(tag, format, ...) (void)(tag)
+#define ESP_LOGW(tag, format, ...)
+#define ESP_LOGI(tag, format, ...)
+#define ESP_LOGD(tag, format, ...)
+#define ESP_LOGV(tag, format, ...)
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <esp_heap_caps.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef int portMUX_TYPE;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define portMAX_DELAY ((TickType_t)0xffffffff)
+#define portYIELD_FROM_ISR()
+
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portMUX_INITIALIZE(mux) (*(mux) = 0)
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// Delays are not needed on the host
+static inline void vTaskDelay(TickType_t ticks) {}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+
+// Implemented by the tests: taking the semaphore completes the transfers (the interrupts) the code waits for
+typedef struct stub_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken);
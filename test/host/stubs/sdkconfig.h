@@ -0,0 +1,4 @@
+#pragma once
+
+#define CONFIG_ESP_LCD_TOUCH_MAX_POINTS 5
+#define CONFIG_ESP_LCD_TOUCH_MAX_BUTTONS 0
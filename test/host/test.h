@@ -0,0 +1,39 @@
+#ifndef TEST_H
+#define TEST_H
+
+// Minimal helpers for the host tests. A failed check is reported and the test continues
+#include <stdio.h>
+
+static int test_failures;
+
+#define TEST_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_CHECK_EQUAL(expected, actual) \
+    do \
+    { \
+        const long long test_expected = (long long)(expected), test_actual = (long long)(actual); \
+        if (test_expected != test_actual) \
+        { \
+            fprintf(stderr, "%s:%d: %s: expected %lld, got %lld\n", __FILE__, __LINE__, #actual, test_expected, test_actual); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RUN(test) \
+    do \
+    { \
+        printf("%s\n", #test); \
+        test(); \
+    } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif
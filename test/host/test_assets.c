@@ -0,0 +1,255 @@
+// Asset bundle: maps bundles written to a temporary file (the Linux mmap path) and checks that corrupt bundles are rejected
+#include <esp32_smartdisplay_assets.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+
+// Layout of the test bundle: header, index, raw data, image, font
+#define RAW_OFFSET (sizeof(smartdisplay_assets_header_t) + 3 * sizeof(smartdisplay_assets_entry_t))
+#define RAW_SIZE 8
+#define IMAGE_OFFSET (RAW_OFFSET + RAW_SIZE)
+#define IMAGE_SIZE (sizeof(smartdisplay_assets_image_t) + 2 * 4)
+#define FONT_OFFSET (IMAGE_OFFSET + IMAGE_SIZE)
+// Offsets within the font data
+#define FONT_CMAPS_OFFSET sizeof(smartdisplay_assets_font_t)
+#define FONT_LIST_OFFSET (FONT_CMAPS_OFFSET + 2 * sizeof(smartdisplay_assets_cmap_t))
+#define FONT_GLYPH_DSC_OFFSET (FONT_LIST_OFFSET + 2 * sizeof(uint16_t))
+#define FONT_GLYPH_COUNT 5
+#define FONT_GLYPH_BITMAP_OFFSET (FONT_GLYPH_DSC_OFFSET + FONT_GLYPH_COUNT * sizeof(lv_font_fmt_txt_glyph_dsc_t))
+#define FONT_SIZE (FONT_GLYPH_BITMAP_OFFSET + (FONT_GLYPH_COUNT - 1) * 2)
+#define BUNDLE_SIZE (FONT_OFFSET + FONT_SIZE)
+
+typedef struct
+{
+    smartdisplay_assets_header_t *header;
+    smartdisplay_assets_entry_t *index;
+    smartdisplay_assets_image_t *image;
+    smartdisplay_assets_font_t *font;
+    smartdisplay_assets_cmap_t *cmaps;
+    lv_font_fmt_txt_glyph_dsc_t *glyph_dsc;
+} bundle_t;
+
+static uint8_t bundle_data[BUNDLE_SIZE];
+static char bundle_path[] = "/tmp/smartdisplay_assets_XXXXXX";
+
+static void bundle_entry(smartdisplay_assets_entry_t *entry, const char *name, smartdisplay_asset_type_t type, uint32_t offset, uint32_t size)
+{
+    strncpy(entry->name, name, SMARTDISPLAY_ASSETS_NAME_LENGTH);
+    entry->type = type;
+    entry->offset = offset;
+    entry->size = size;
+}
+
+// Valid bundle with a raw entry, a 2x2 RGB565 image and a font with two character maps
+static bundle_t bundle_create()
+{
+    memset(bundle_data, 0, sizeof(bundle_data));
+    bundle_t bundle = {
+        .header = (smartdisplay_assets_header_t *)bundle_data,
+        .index = (smartdisplay_assets_entry_t *)(bundle_data + sizeof(smartdisplay_assets_header_t)),
+        .image = (smartdisplay_assets_image_t *)(bundle_data + IMAGE_OFFSET),
+        .font = (smartdisplay_assets_font_t *)(bundle_data + FONT_OFFSET),
+        .cmaps = (smartdisplay_assets_cmap_t *)(bundle_data + FONT_OFFSET + FONT_CMAPS_OFFSET),
+        .glyph_dsc = (lv_font_fmt_txt_glyph_dsc_t *)(bundle_data + FONT_OFFSET + FONT_GLYPH_DSC_OFFSET)};
+
+    memcpy(bundle.header->magic, SMARTDISPLAY_ASSETS_MAGIC, sizeof(bundle.header->magic));
+    bundle.header->version = SMARTDISPLAY_ASSETS_VERSION;
+    bundle.header->count = 3;
+    bundle.header->size = BUNDLE_SIZE;
+    bundle_entry(&bundle.index[0], "raw", SMARTDISPLAY_ASSET_RAW, RAW_OFFSET, RAW_SIZE);
+    bundle_entry(&bundle.index[1], "image", SMARTDISPLAY_ASSET_IMAGE, IMAGE_OFFSET, IMAGE_SIZE);
+    bundle_entry(&bundle.index[2], "font", SMARTDISPLAY_ASSET_FONT, FONT_OFFSET, FONT_SIZE);
+    memcpy(bundle_data + RAW_OFFSET, "rawdata", RAW_SIZE);
+
+    *bundle.image = (smartdisplay_assets_image_t){.cf = LV_COLOR_FORMAT_RGB565, .w = 2, .h = 2, .stride = 4};
+
+    *bundle.font = (smartdisplay_assets_font_t){
+        .line_height = 4,
+        .base_line = 1,
+        .bpp = 4,
+        .cmap_num = 2,
+        .glyph_count = FONT_GLYPH_COUNT,
+        .glyph_dsc_offset = FONT_GLYPH_DSC_OFFSET,
+        .glyph_bitmap_offset = FONT_GLYPH_BITMAP_OFFSET,
+        .cmaps_offset = FONT_CMAPS_OFFSET};
+    // 'A' and 'B' are glyphs 1 and 2, U+0100 and U+0105 are glyphs 3 and 4
+    bundle.cmaps[0] = (smartdisplay_assets_cmap_t){.range_start = 'A', .range_length = 2, .glyph_id_start = 1, .type = LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY};
+    bundle.cmaps[1] = (smartdisplay_assets_cmap_t){.range_start = 0x100, .range_length = 6, .glyph_id_start = 3, .list_length = 2, .type = LV_FONT_FMT_TXT_CMAP_SPARSE_TINY, .unicode_list_offset = FONT_LIST_OFFSET};
+    uint16_t *unicode_list = (uint16_t *)(bundle_data + FONT_OFFSET + FONT_LIST_OFFSET);
+    unicode_list[0] = 0;
+    unicode_list[1] = 5;
+    for (uint32_t g = 1; g < FONT_GLYPH_COUNT; g++)
+    {
+        bundle.glyph_dsc[g].bitmap_index = (g - 1) * 2;
+        bundle.glyph_dsc[g].adv_w = 3 * 16;
+        bundle.glyph_dsc[g].box_w = 2;
+        bundle.glyph_dsc[g].box_h = 2;
+    }
+
+    return bundle;
+}
+
+static bool bundle_open(size_t file_size)
+{
+    FILE *file = fopen(bundle_path, "wb");
+    fwrite(bundle_data, 1, file_size, file);
+    fclose(file);
+    return smartdisplay_assets_open(bundle_path);
+}
+
+static void test_valid_bundle()
+{
+    bundle_create();
+    TEST_CHECK(bundle_open(BUNDLE_SIZE));
+
+    smartdisplay_asset_type_t type;
+    uint32_t size;
+    const char *raw = smartdisplay_assets_get("raw", &type, &size);
+    TEST_CHECK(raw != NULL && strcmp(raw, "rawdata") == 0);
+    TEST_CHECK_EQUAL(SMARTDISPLAY_ASSET_RAW, type);
+    TEST_CHECK_EQUAL(RAW_SIZE, size);
+    TEST_CHECK(smartdisplay_assets_get("missing", NULL, NULL) == NULL);
+
+    const lv_image_dsc_t *image = smartdisplay_assets_get_image("image");
+    TEST_CHECK(image != NULL);
+    if (image != NULL)
+    {
+        TEST_CHECK_EQUAL(LV_COLOR_FORMAT_RGB565, image->header.cf);
+        TEST_CHECK_EQUAL(2, image->header.w);
+        TEST_CHECK_EQUAL(4, image->header.stride);
+        TEST_CHECK_EQUAL(8, image->data_size);
+    }
+
+    // Wrong type
+    TEST_CHECK(smartdisplay_assets_get_image("font") == NULL);
+
+    const lv_font_t *font = smartdisplay_assets_get_font("font");
+    TEST_CHECK(font != NULL);
+    if (font != NULL)
+    {
+        TEST_CHECK_EQUAL(4, font->line_height);
+        const lv_font_fmt_txt_dsc_t *dsc = font->dsc;
+        TEST_CHECK_EQUAL(2, dsc->cmap_num);
+        TEST_CHECK_EQUAL('A', dsc->cmaps[0].range_start);
+        TEST_CHECK(dsc->cmaps[0].unicode_list == NULL);
+        TEST_CHECK_EQUAL(5, dsc->cmaps[1].unicode_list[1]);
+        TEST_CHECK_EQUAL(4, dsc->glyph_dsc[3].bitmap_index);
+        TEST_CHECK(dsc->glyph_bitmap == (const uint8_t *)smartdisplay_assets_get("font", NULL, NULL) + FONT_GLYPH_BITMAP_OFFSET);
+    }
+
+    smartdisplay_assets_close();
+}
+
+static void test_corrupt_bundle()
+{
+    bundle_t bundle = bundle_create();
+    bundle.header->magic[0] = 'X';
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Truncated file
+    bundle_create();
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE - 4));
+
+    // Index larger than the bundle
+    bundle = bundle_create();
+    bundle.header->count = 0xffff;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Data beyond the end of the bundle
+    bundle = bundle_create();
+    bundle.index[0].size = BUNDLE_SIZE;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Offset and size overflow
+    bundle = bundle_create();
+    bundle.index[0].offset = RAW_OFFSET;
+    bundle.index[0].size = UINT32_MAX - 4;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Data overlapping the index
+    bundle = bundle_create();
+    bundle.index[0].offset = 0;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.index[0].type = 7;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+}
+
+static void test_corrupt_image()
+{
+    // Smaller than the image header, the pixel data size would underflow
+    bundle_t bundle = bundle_create();
+    bundle.index[1].size = sizeof(smartdisplay_assets_image_t) - 4;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.image->h = 3;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.image->stride = 2;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.image->cf = LV_COLOR_FORMAT_UNKNOWN;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+}
+
+static void test_corrupt_font()
+{
+    bundle_t bundle = bundle_create();
+    bundle.font->cmaps_offset = FONT_SIZE;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.font->cmap_num = 100;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.font->glyph_dsc_offset = FONT_GLYPH_BITMAP_OFFSET;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.font->glyph_bitmap_offset = FONT_SIZE + 4;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.font->bpp = 3;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Unicode list outside of the font data
+    bundle = bundle_create();
+    bundle.cmaps[1].unicode_list_offset = FONT_SIZE - 2;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    bundle = bundle_create();
+    bundle.cmaps[1].unicode_list_offset = 0;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Character map refers to a glyph that does not exist
+    bundle = bundle_create();
+    bundle.cmaps[0].range_length = 10;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+
+    // Glyph bitmap outside of the font data
+    bundle = bundle_create();
+    bundle.glyph_dsc[4].box_w = 4;
+    TEST_CHECK(!bundle_open(BUNDLE_SIZE));
+}
+
+int main()
+{
+    lv_init();
+    const int fd = mkstemp(bundle_path);
+    close(fd);
+
+    TEST_RUN(test_valid_bundle);
+    TEST_RUN(test_corrupt_bundle);
+    TEST_RUN(test_corrupt_image);
+    TEST_RUN(test_corrupt_font);
+
+    unlink(bundle_path);
+    return TEST_RESULT();
+}
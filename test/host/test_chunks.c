@@ -0,0 +1,192 @@
+// Chunks of the L8 expansion, the pipelined byte swap and the bounce buffers: the transfers are completed when the code
+// waits for a buffer (or at the end) and the panel memory is compared with the area
+#include <esp32_smartdisplay_chunks.h>
+#include <esp_lcd_panel_ops.h>
+#include <string.h>
+#include "test.h"
+
+#define WIDTH 64
+#define HEIGHT 64
+#define MAX_PENDING 64
+
+static uint16_t gram[HEIGHT][WIDTH];
+static smartdisplay_chunks_t chunks;
+
+// Transfers queued by the draw, sent when completed
+typedef struct
+{
+    int x1, y1, x2, y2;
+    const uint16_t *data;
+} transfer_t;
+
+static transfer_t pending[MAX_PENDING];
+static uint32_t pending_count, pending_max, draws;
+static bool last_done;
+
+struct stub_semaphore
+{
+    int count;
+};
+
+static struct stub_semaphore semaphore;
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    if (pending_count == MAX_PENDING)
+        return ESP_FAIL;
+
+    pending[pending_count++] = (transfer_t){.x1 = x_start, .y1 = y_start, .x2 = x_end, .y2 = y_end, .data = color_data};
+    pending_max = LV_MAX(pending_max, pending_count);
+    draws++;
+    return ESP_OK;
+}
+
+// Send the oldest transfer, the pixels are read from the buffer now
+static bool complete_transfer()
+{
+    if (pending_count == 0)
+        return false;
+
+    const transfer_t *transfer = &pending[0];
+    const uint16_t *src = transfer->data;
+    for (int y = transfer->y1; y < transfer->y2; y++)
+        for (int x = transfer->x1; x < transfer->x2; x++)
+            gram[y][x] = *src++;
+
+    memmove(pending, pending + 1, --pending_count * sizeof(transfer_t));
+    last_done = smartdisplay_chunks_trans_done(&chunks);
+    return true;
+}
+
+static void complete_all()
+{
+    while (complete_transfer())
+        ;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return &semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    // Blocking: wait for the next transfer
+    if (semaphore->count == 0 && ticks != 0 && !complete_transfer())
+    {
+        fprintf(stderr, "Waiting without a pending transfer\n");
+        abort();
+    }
+
+    if (semaphore->count == 0)
+        return pdFALSE;
+
+    semaphore->count = 0;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken)
+{
+    semaphore->count = 1;
+    return pdTRUE;
+}
+
+static void reset()
+{
+    memset(gram, 0, sizeof(gram));
+    pending_count = pending_max = draws = 0;
+    last_done = false;
+}
+
+static uint16_t swap(uint16_t value)
+{
+    return (uint16_t)((value >> 8) | (value << 8));
+}
+
+static void test_expand_l8()
+{
+    static uint16_t lut[256];
+    for (uint32_t i = 0; i < 256; i++)
+        lut[i] = i * 251;
+
+    // Stride larger than the width, 3 rows per chunk
+    const lv_area_t area = {.x1 = 5, .y1 = 10, .x2 = 14, .y2 = 16};
+    const uint32_t stride = 12;
+    uint8_t px_map[12 * 7];
+    for (uint32_t i = 0; i < sizeof(px_map); i++)
+        px_map[i] = i * 7;
+
+    reset();
+    TEST_CHECK(smartdisplay_chunks_init(&chunks, smartdisplay_chunk_expand_l8, lut, 32));
+    smartdisplay_chunks_send(&chunks, NULL, &area, px_map, stride, chunks.buffer_pixels / lv_area_get_width(&area));
+    complete_all();
+    TEST_CHECK_EQUAL(3, draws);
+    TEST_CHECK(pending_max <= SMARTDISPLAY_CHUNK_BUFFERS);
+    TEST_CHECK(last_done);
+
+    for (int32_t y = area.y1; y <= area.y2; y++)
+        for (int32_t x = area.x1; x <= area.x2; x++)
+            TEST_CHECK_EQUAL(lut[px_map[(y - area.y1) * stride + x - area.x1]], gram[y][x]);
+
+    // Outside of the area
+    TEST_CHECK_EQUAL(0, gram[area.y1][area.x1 - 1]);
+    TEST_CHECK_EQUAL(0, gram[area.y2 + 1][area.x1]);
+}
+
+// Many chunks through two buffers, a buffer is only refilled after its transfer is complete
+static void test_bounce_reuse()
+{
+    static uint16_t pixels[20 * 50];
+    const lv_area_t area = {.x1 = 3, .y1 = 7, .x2 = 22, .y2 = 56};
+    for (uint32_t i = 0; i < 20 * 50; i++)
+        pixels[i] = i * 40503;
+
+    reset();
+    TEST_CHECK(smartdisplay_chunks_init(&chunks, smartdisplay_chunk_swap, NULL, 40));
+    smartdisplay_chunks_send(&chunks, NULL, &area, (uint8_t *)pixels, 20 * sizeof(uint16_t), 2);
+    TEST_CHECK(!last_done);
+    complete_all();
+    TEST_CHECK_EQUAL(25, draws);
+    TEST_CHECK_EQUAL(SMARTDISPLAY_CHUNK_BUFFERS, pending_max);
+    TEST_CHECK(last_done);
+    TEST_CHECK_EQUAL(0, chunks.remaining);
+
+    bool match = true;
+    for (int32_t y = area.y1; y <= area.y2; y++)
+        for (int32_t x = area.x1; x <= area.x2; x++)
+            match &= gram[y][x] == swap(pixels[(y - area.y1) * 20 + x - area.x1]);
+    TEST_CHECK(match);
+}
+
+// Swapped in place in the draw buffer, the odd width gives unaligned chunks
+static void test_in_place()
+{
+    static uint16_t pixels[13 * 9], expected[13 * 9];
+    const lv_area_t area = {.x1 = 0, .y1 = 0, .x2 = 12, .y2 = 8};
+    for (uint32_t i = 0; i < 13 * 9; i++)
+    {
+        pixels[i] = i * 997;
+        expected[i] = swap(pixels[i]);
+    }
+
+    reset();
+    TEST_CHECK(smartdisplay_chunks_init(&chunks, smartdisplay_chunk_swap, NULL, 0));
+    TEST_CHECK(chunks.buffers[0] == NULL);
+    smartdisplay_chunks_send(&chunks, NULL, &area, (uint8_t *)pixels, 13 * sizeof(uint16_t), 3);
+    TEST_CHECK_EQUAL(3, draws);
+    TEST_CHECK_EQUAL(3, pending_count);
+    TEST_CHECK(memcmp(pixels, expected, sizeof(pixels)) == 0);
+    complete_all();
+    TEST_CHECK(last_done);
+
+    // Other transfers (commands) do not wait
+    TEST_CHECK(smartdisplay_chunks_trans_done(&chunks));
+}
+
+int main()
+{
+    TEST_RUN(test_expand_l8);
+    TEST_RUN(test_bounce_reuse);
+    TEST_RUN(test_in_place);
+    return TEST_RESULT();
+}
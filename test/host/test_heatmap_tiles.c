@@ -0,0 +1,92 @@
+// Heatmap: areas counted in the tiles they cover and flushes that do not change the copy of the screen
+#include <esp32_smartdisplay_heatmap_tiles.h>
+#include <string.h>
+#include "test.h"
+
+#define WIDTH 100
+#define HEIGHT 60
+#define TILE 16
+// Partial tiles at the right and bottom edge
+#define TILES_X ((WIDTH + TILE - 1) / TILE)
+#define TILES_Y ((HEIGHT + TILE - 1) / TILE)
+
+static smartdisplay_heatmap_tile_t tiles[TILES_X * TILES_Y];
+
+static void test_tiles()
+{
+    memset(tiles, 0, sizeof(tiles));
+
+    // Inside one tile
+    const lv_area_t small = {.x1 = 17, .y1 = 17, .x2 = 20, .y2 = 18};
+    smartdisplay_heatmap_tiles_add(tiles, TILE, TILES_X, &small, 2, false);
+    TEST_CHECK_EQUAL(1, tiles[1 * TILES_X + 1].flushes);
+    TEST_CHECK_EQUAL(4 * 2 * 2, tiles[1 * TILES_X + 1].bytes);
+
+    // Crossing the tile borders: the bytes of every part add up to the area
+    const lv_area_t area = {.x1 = 10, .y1 = 5, .x2 = 40, .y2 = 20};
+    smartdisplay_heatmap_tiles_add(tiles, TILE, TILES_X, &area, 2, true);
+    uint32_t flushes = 0, bytes = 0, redundant = 0;
+    for (uint32_t i = 0; i < TILES_X * TILES_Y; i++)
+    {
+        flushes += tiles[i].flushes;
+        bytes += tiles[i].bytes;
+        redundant += tiles[i].redundant;
+    }
+
+    TEST_CHECK_EQUAL(1 + 3 * 2, flushes);
+    TEST_CHECK_EQUAL((4 * 2 + 31 * 16) * 2, bytes);
+    TEST_CHECK_EQUAL(3 * 2, redundant);
+    TEST_CHECK_EQUAL(6 * 11 * 2, tiles[0].bytes);
+    TEST_CHECK_EQUAL(16 * 5 * 2 + 4 * 2 * 2, tiles[1 * TILES_X + 1].bytes);
+    TEST_CHECK_EQUAL(2, tiles[1 * TILES_X + 1].flushes);
+    TEST_CHECK_EQUAL(0, tiles[3].flushes);
+
+    // Complete screen with the partial tiles at the edges, L8
+    memset(tiles, 0, sizeof(tiles));
+    const lv_area_t screen = {.x1 = 0, .y1 = 0, .x2 = WIDTH - 1, .y2 = HEIGHT - 1};
+    smartdisplay_heatmap_tiles_add(tiles, TILE, TILES_X, &screen, 1, false);
+    bytes = 0;
+    for (uint32_t i = 0; i < TILES_X * TILES_Y; i++)
+    {
+        TEST_CHECK_EQUAL(1, tiles[i].flushes);
+        bytes += tiles[i].bytes;
+    }
+
+    TEST_CHECK_EQUAL(WIDTH * HEIGHT, bytes);
+    TEST_CHECK_EQUAL((WIDTH - (TILES_X - 1) * TILE) * (HEIGHT - (TILES_Y - 1) * TILE), tiles[TILES_X * TILES_Y - 1].bytes);
+}
+
+static void test_copy()
+{
+    static uint16_t copy[WIDTH * HEIGHT];
+    // Area of 8x3 pixels in a buffer with a stride of 10 pixels
+    uint16_t pixels[3 * 10];
+    const lv_area_t area = {.x1 = 20, .y1 = 30, .x2 = 27, .y2 = 32};
+    memset(copy, 0, sizeof(copy));
+    memset(pixels, 0, sizeof(pixels));
+    TEST_CHECK(smartdisplay_heatmap_copy_update((uint8_t *)copy, WIDTH, &area, (const uint8_t *)pixels, 10 * sizeof(uint16_t), sizeof(uint16_t)));
+
+    // A change in the last row is copied, the padding of the stride is not
+    pixels[2 * 10 + 7] = 0x1234;
+    pixels[2 * 10 + 8] = 0x5678;
+    TEST_CHECK(!smartdisplay_heatmap_copy_update((uint8_t *)copy, WIDTH, &area, (const uint8_t *)pixels, 10 * sizeof(uint16_t), sizeof(uint16_t)));
+    TEST_CHECK_EQUAL(0x1234, copy[32 * WIDTH + 27]);
+    TEST_CHECK_EQUAL(0, copy[32 * WIDTH + 28]);
+
+    // Flushed again without changes
+    TEST_CHECK(smartdisplay_heatmap_copy_update((uint8_t *)copy, WIDTH, &area, (const uint8_t *)pixels, 10 * sizeof(uint16_t), sizeof(uint16_t)));
+
+    // A change in the first row, the following rows are copied as well
+    pixels[0] = 1;
+    pixels[10] = 2;
+    TEST_CHECK(!smartdisplay_heatmap_copy_update((uint8_t *)copy, WIDTH, &area, (const uint8_t *)pixels, 10 * sizeof(uint16_t), sizeof(uint16_t)));
+    TEST_CHECK_EQUAL(1, copy[30 * WIDTH + 20]);
+    TEST_CHECK_EQUAL(2, copy[31 * WIDTH + 20]);
+}
+
+int main()
+{
+    TEST_RUN(test_tiles);
+    TEST_RUN(test_copy);
+    return TEST_RESULT();
+}
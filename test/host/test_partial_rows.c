@@ -0,0 +1,56 @@
+// Partial display area: clipping of the invalidated areas and the panel rows of the partial area
+#include <esp32_smartdisplay_partial_rows.h>
+#include "test.h"
+
+static void test_clip()
+{
+    lv_area_t area = {.x1 = 10, .y1 = 20, .x2 = 30, .y2 = 30};
+    TEST_CHECK_EQUAL(SMARTDISPLAY_PARTIAL_INSIDE, smartdisplay_partial_clip(&area, 0, 39));
+    TEST_CHECK_EQUAL(20, area.y1);
+    TEST_CHECK_EQUAL(30, area.y2);
+
+    // Crossing the top and the bottom row
+    area = (lv_area_t){.x1 = 10, .y1 = 20, .x2 = 30, .y2 = 50};
+    TEST_CHECK_EQUAL(SMARTDISPLAY_PARTIAL_CLIPPED, smartdisplay_partial_clip(&area, 25, 39));
+    TEST_CHECK_EQUAL(25, area.y1);
+    TEST_CHECK_EQUAL(39, area.y2);
+    TEST_CHECK_EQUAL(10, area.x1);
+    TEST_CHECK_EQUAL(30, area.x2);
+
+    // Completely outside, not changed
+    area = (lv_area_t){.x1 = 10, .y1 = 40, .x2 = 30, .y2 = 50};
+    TEST_CHECK_EQUAL(SMARTDISPLAY_PARTIAL_OUTSIDE, smartdisplay_partial_clip(&area, 0, 39));
+    TEST_CHECK_EQUAL(40, area.y1);
+    TEST_CHECK_EQUAL(50, area.y2);
+    area = (lv_area_t){.x1 = 10, .y1 = 0, .x2 = 30, .y2 = 9};
+    TEST_CHECK_EQUAL(SMARTDISPLAY_PARTIAL_OUTSIDE, smartdisplay_partial_clip(&area, 10, 39));
+    TEST_CHECK_EQUAL(0, area.y1);
+}
+
+static void test_rows()
+{
+    int32_t start, end;
+    smartdisplay_partial_rows(320, 0, false, 0, 39, &start, &end);
+    TEST_CHECK_EQUAL(0, start);
+    TEST_CHECK_EQUAL(39, end);
+
+    smartdisplay_partial_rows(320, 20, false, 10, 19, &start, &end);
+    TEST_CHECK_EQUAL(30, start);
+    TEST_CHECK_EQUAL(39, end);
+
+    // Mirrored: the top rows of the display are the last rows of the panel memory
+    smartdisplay_partial_rows(320, 0, true, 0, 39, &start, &end);
+    TEST_CHECK_EQUAL(280, start);
+    TEST_CHECK_EQUAL(319, end);
+
+    smartdisplay_partial_rows(320, 20, true, 10, 19, &start, &end);
+    TEST_CHECK_EQUAL(280, start);
+    TEST_CHECK_EQUAL(289, end);
+}
+
+int main()
+{
+    TEST_RUN(test_clip);
+    TEST_RUN(test_rows);
+    return TEST_RESULT();
+}
@@ -0,0 +1,191 @@
+// Hardware vertical scroll: the windows are written to a simulated panel memory that is scanned out from the scroll
+// start address, the result is compared with the display rows
+#include <esp32_smartdisplay_scroll.h>
+#include "test.h"
+
+#define GRAM_ROWS 320
+#define HEIGHT 240
+
+// Content shown at every row of the panel memory, in display rows (the mirroring is done by the panel)
+static int32_t gram[GRAM_ROWS];
+
+// Content of display row y: the rows of the scroll area show the content scrolled scroll_y rows
+static int32_t content(const smartdisplay_scroll_area_t *scroll, int32_t scroll_y, int32_t y)
+{
+    return y >= scroll->y1 && y < scroll->y1 + scroll->height ? scroll_y + y : -y;
+}
+
+static void gram_write(const smartdisplay_scroll_area_t *scroll, int32_t scroll_y, const smartdisplay_scroll_window_t *windows, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        for (int32_t y = windows[i].y1; y <= windows[i].y2; y++)
+            gram[windows[i].dest_y + y - windows[i].y1] = content(scroll, scroll_y, y);
+}
+
+// Content shown at display row y: the rows of the scroll area are scanned out from the offset and wrap around
+static int32_t gram_scan(const smartdisplay_scroll_area_t *scroll, int32_t offset, int32_t y)
+{
+    if (y < scroll->y1 || y >= scroll->y1 + scroll->height)
+        return gram[y];
+
+    return gram[scroll->y1 + (y - scroll->y1 + offset) % scroll->height];
+}
+
+static bool gram_match(const smartdisplay_scroll_area_t *scroll, int32_t scroll_y, int32_t offset)
+{
+    bool match = true;
+    for (int32_t y = 0; y < HEIGHT; y++)
+        match &= gram_scan(scroll, offset, y) == content(scroll, scroll_y, y);
+
+    return match;
+}
+
+static void test_start()
+{
+    smartdisplay_scroll_area_t scroll = {.gram_rows = GRAM_ROWS, .gap_y = 0, .y1 = 40, .height = 200};
+    TEST_CHECK_EQUAL(40, smartdisplay_scroll_top_fixed_area(&scroll));
+    TEST_CHECK_EQUAL(40, smartdisplay_scroll_start(&scroll, 0));
+    TEST_CHECK_EQUAL(50, smartdisplay_scroll_start(&scroll, 10));
+
+    // Mirrored: the fixed area at the top of the display is at the bottom of the panel memory
+    scroll.mirror = true;
+    scroll.gap_y = 20;
+    TEST_CHECK_EQUAL(GRAM_ROWS - 20 - 40 - 200, smartdisplay_scroll_top_fixed_area(&scroll));
+    TEST_CHECK_EQUAL(60, smartdisplay_scroll_start(&scroll, 0));
+    TEST_CHECK_EQUAL(60 + 190, smartdisplay_scroll_start(&scroll, 10));
+
+    // No scroll area
+    scroll.height = 0;
+    TEST_CHECK_EQUAL(0, smartdisplay_scroll_start(&scroll, 0));
+}
+
+static void test_offset()
+{
+    const smartdisplay_scroll_area_t scroll = {.gram_rows = GRAM_ROWS, .y1 = 0, .height = 200};
+    TEST_CHECK_EQUAL(30, smartdisplay_scroll_offset(&scroll, 10, 20));
+    TEST_CHECK_EQUAL(10, smartdisplay_scroll_offset(&scroll, 190, 20));
+    TEST_CHECK_EQUAL(190, smartdisplay_scroll_offset(&scroll, 10, -20));
+    TEST_CHECK_EQUAL(0, smartdisplay_scroll_offset(&scroll, 0, -400));
+}
+
+static void test_move_areas()
+{
+    const smartdisplay_scroll_area_t scroll = {.gram_rows = GRAM_ROWS, .y1 = 40, .height = 200};
+    lv_area_t exposed;
+
+    // Scrolled down 10 rows: the rows at the bottom are exposed, the areas move up with the content
+    lv_area_t areas[] = {{.x1 = 0, .y1 = 0, .x2 = 9, .y2 = 39}, {.x1 = 5, .y1 = 100, .x2 = 9, .y2 = 119}, {.x1 = 0, .y1 = 40, .x2 = 9, .y2 = 45}};
+    TEST_CHECK(smartdisplay_scroll_move_areas(&scroll, 240, 10, areas, 3, &exposed));
+    TEST_CHECK_EQUAL(230, exposed.y1);
+    TEST_CHECK_EQUAL(239, exposed.y2);
+    TEST_CHECK_EQUAL(239, exposed.x2);
+    // Outside the scroll area
+    TEST_CHECK_EQUAL(0, areas[0].y1);
+    TEST_CHECK_EQUAL(39, areas[0].y2);
+    TEST_CHECK_EQUAL(90, areas[1].y1);
+    TEST_CHECK_EQUAL(109, areas[1].y2);
+    TEST_CHECK_EQUAL(5, areas[1].x1);
+    // Scrolled out
+    TEST_CHECK_EQUAL(230, areas[2].y1);
+    TEST_CHECK_EQUAL(239, areas[2].y2);
+
+    // Scrolled up 10 rows: the rows at the top are exposed
+    TEST_CHECK(smartdisplay_scroll_move_areas(&scroll, 240, -10, areas, 2, &exposed));
+    TEST_CHECK_EQUAL(40, exposed.y1);
+    TEST_CHECK_EQUAL(49, exposed.y2);
+    TEST_CHECK_EQUAL(100, areas[1].y1);
+
+    // An area crossing the edge of the scroll area is not changed
+    lv_area_t crossing[] = {{.x1 = 0, .y1 = 100, .x2 = 9, .y2 = 109}, {.x1 = 0, .y1 = 30, .x2 = 9, .y2 = 50}};
+    TEST_CHECK(!smartdisplay_scroll_move_areas(&scroll, 240, 10, crossing, 2, &exposed));
+    TEST_CHECK_EQUAL(100, crossing[0].y1);
+    TEST_CHECK_EQUAL(30, crossing[1].y1);
+}
+
+// The display scrolled in steps: after writing only the exposed rows the panel shows the scrolled content
+static void test_windows()
+{
+    const smartdisplay_scroll_area_t scroll = {.gram_rows = GRAM_ROWS, .y1 = 40, .height = 180};
+    const lv_area_t screen = {.x1 = 0, .y1 = 0, .x2 = 239, .y2 = HEIGHT - 1};
+    smartdisplay_scroll_window_t windows[SMARTDISPLAY_SCROLL_MAX_WINDOWS];
+    int32_t scroll_y = 0, offset = 0;
+    uint32_t count = smartdisplay_scroll_windows(&scroll, offset, &screen, windows);
+    TEST_CHECK_EQUAL(3, count);
+    gram_write(&scroll, scroll_y, windows, count);
+    TEST_CHECK(gram_match(&scroll, scroll_y, offset));
+
+    const int32_t steps[] = {7, 30, -12, 179, -100, 1, -1, 55, -179};
+    for (uint32_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        lv_area_t exposed;
+        TEST_CHECK(smartdisplay_scroll_move_areas(&scroll, 240, steps[i], NULL, 0, &exposed));
+        scroll_y += steps[i];
+        offset = smartdisplay_scroll_offset(&scroll, offset, steps[i]);
+        count = smartdisplay_scroll_windows(&scroll, offset, &exposed, windows);
+        TEST_CHECK(count >= 1 && count <= 2);
+        gram_write(&scroll, scroll_y, windows, count);
+        TEST_CHECK(gram_match(&scroll, scroll_y, offset));
+    }
+
+    // The complete screen is split in the rows above, both parts of the scroll area and the rows below
+    count = smartdisplay_scroll_windows(&scroll, offset, &screen, windows);
+    TEST_CHECK_EQUAL(SMARTDISPLAY_SCROLL_MAX_WINDOWS, count);
+    TEST_CHECK_EQUAL(0, windows[0].y1);
+    TEST_CHECK_EQUAL(39, windows[0].y2);
+    TEST_CHECK_EQUAL(40 + offset, windows[1].dest_y);
+    TEST_CHECK_EQUAL(40, windows[2].dest_y);
+    TEST_CHECK_EQUAL(220, windows[3].y1);
+    TEST_CHECK_EQUAL(220, windows[3].dest_y);
+    scroll_y += 1000;
+    gram_write(&scroll, scroll_y, windows, count);
+    TEST_CHECK(gram_match(&scroll, scroll_y, offset));
+}
+
+// The invalidations following a scroll in the order of LVGL: the moved areas, the scrollbar and the scrolled object.
+// Only the invalidation of the object is replaced by the exposed rows, the bytes sent are those of the exposed rows
+// and the scrollbar
+static void test_crop_sequence()
+{
+    const smartdisplay_scroll_area_t scroll = {.gram_rows = GRAM_ROWS, .y1 = 40, .height = 200};
+    lv_area_t exposed;
+    lv_area_t areas[] = {{.x1 = 10, .y1 = 100, .x2 = 49, .y2 = 119}};
+    TEST_CHECK(smartdisplay_scroll_move_areas(&scroll, 240, 12, areas, 1, &exposed));
+
+    // The scrollbar is invalidated before the crop is set, and does not match as it is not full width
+    lv_area_t scrollbar = {.x1 = 234, .y1 = 40, .x2 = 239, .y2 = 239};
+    TEST_CHECK(!smartdisplay_scroll_crop(&scroll, 240, &exposed, &scrollbar));
+    TEST_CHECK_EQUAL(234, scrollbar.x1);
+    TEST_CHECK_EQUAL(40, scrollbar.y1);
+    TEST_CHECK_EQUAL(239, scrollbar.y2);
+
+    // A child of the object does not cover the scroll area
+    lv_area_t child = {.x1 = 0, .y1 = 60, .x2 = 239, .y2 = 99};
+    TEST_CHECK(!smartdisplay_scroll_crop(&scroll, 240, &exposed, &child));
+    TEST_CHECK_EQUAL(60, child.y1);
+
+    // The scrolled object, extending above the scroll area
+    lv_area_t object = {.x1 = 0, .y1 = 20, .x2 = 239, .y2 = 239};
+    TEST_CHECK(smartdisplay_scroll_crop(&scroll, 240, &exposed, &object));
+    TEST_CHECK_EQUAL(0, object.x1);
+    TEST_CHECK_EQUAL(228, object.y1);
+    TEST_CHECK_EQUAL(239, object.x2);
+    TEST_CHECK_EQUAL(239, object.y2);
+
+    // Bytes in the scroll area of the sent areas, rows outside the scroll area are not counted
+    uint32_t bytes = smartdisplay_scroll_bytes(&scroll, &areas[0], 2) + smartdisplay_scroll_bytes(&scroll, &scrollbar, 2) + smartdisplay_scroll_bytes(&scroll, &object, 2);
+    TEST_CHECK_EQUAL((20 * 40 + 200 * 6 + 12 * 240) * 2, bytes);
+    const lv_area_t above = {.x1 = 0, .y1 = 0, .x2 = 239, .y2 = 45};
+    TEST_CHECK_EQUAL(6 * 240 * 2, smartdisplay_scroll_bytes(&scroll, &above, 2));
+    const lv_area_t outside = {.x1 = 0, .y1 = 0, .x2 = 239, .y2 = 39};
+    TEST_CHECK_EQUAL(0, smartdisplay_scroll_bytes(&scroll, &outside, 2));
+}
+
+int main()
+{
+    TEST_RUN(test_start);
+    TEST_RUN(test_offset);
+    TEST_RUN(test_move_areas);
+    TEST_RUN(test_windows);
+    TEST_RUN(test_crop_sequence);
+    return TEST_RESULT();
+}
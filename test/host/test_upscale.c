@@ -0,0 +1,113 @@
+// 2x upscaling of the dynamic resolution scaling: nearest neighbour pixels, bilinear interpolation and the rows at the
+// edges of the stripes
+#include <esp32_smartdisplay_upscale.h>
+#include <string.h>
+#include "test.h"
+
+#define WIDTH 16
+#define HEIGHT 12
+
+static uint16_t frame_buffer[HEIGHT * 2][WIDTH * 2];
+static uint16_t source[HEIGHT][WIDTH];
+static smartdisplay_upscale_t upscale;
+
+static uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b)
+{
+    return (r << 11) | (g << 5) | b;
+}
+
+// Average of two pixels per channel, rounded down
+static uint16_t average(uint16_t a, uint16_t b)
+{
+    return rgb565(((a >> 11) + (b >> 11)) / 2, (((a >> 5) & 0x3f) + ((b >> 5) & 0x3f)) / 2, ((a & 0x1f) + (b & 0x1f)) / 2);
+}
+
+static void source_fill()
+{
+    uint32_t seed = 7;
+    for (int32_t y = 0; y < HEIGHT; y++)
+        for (int32_t x = 0; x < WIDTH; x++)
+        {
+            seed = seed * 1103515245 + 12345;
+            source[y][x] = seed >> 16;
+        }
+}
+
+static void test_nearest()
+{
+    source_fill();
+    memset(frame_buffer, 0, sizeof(frame_buffer));
+    const lv_area_t area = {.x1 = 2, .y1 = 3, .x2 = 9, .y2 = 7};
+    smartdisplay_upscale_nearest(&frame_buffer[0][0], WIDTH * 2, &area, &source[area.y1][area.x1], WIDTH);
+
+    bool match = true;
+    for (int32_t y = 2 * area.y1; y <= 2 * area.y2 + 1; y++)
+        for (int32_t x = 2 * area.x1; x <= 2 * area.x2 + 1; x++)
+            match &= frame_buffer[y][x] == source[y / 2][x / 2];
+    TEST_CHECK(match);
+
+    // Outside of the area
+    TEST_CHECK_EQUAL(0, frame_buffer[2 * area.y1 - 1][2 * area.x1]);
+    TEST_CHECK_EQUAL(0, frame_buffer[2 * area.y1][2 * area.x2 + 2]);
+}
+
+static void test_bilinear()
+{
+    source_fill();
+    memset(frame_buffer, 0, sizeof(frame_buffer));
+    const lv_area_t area = {.x1 = 0, .y1 = 0, .x2 = WIDTH - 1, .y2 = HEIGHT - 1};
+    smartdisplay_upscale_reset(&upscale);
+    TEST_CHECK_EQUAL(0, smartdisplay_upscale_bilinear(&upscale, &frame_buffer[0][0], WIDTH * 2, &area, &source[0][0], WIDTH));
+
+    bool match = true;
+    for (int32_t y = 0; y < HEIGHT; y++)
+        for (int32_t x = 0; x < WIDTH; x++)
+        {
+            const int32_t x1 = LV_MIN(x + 1, WIDTH - 1), y1 = LV_MIN(y + 1, HEIGHT - 1);
+            const uint16_t right = average(source[y][x], source[y][x1]);
+            match &= frame_buffer[2 * y][2 * x] == source[y][x];
+            match &= frame_buffer[2 * y][2 * x + 1] == right;
+            match &= frame_buffer[2 * y + 1][2 * x] == average(source[y][x], source[y1][x]);
+            match &= frame_buffer[2 * y + 1][2 * x + 1] == average(right, average(source[y1][x], source[y1][x1]));
+        }
+    TEST_CHECK(match);
+}
+
+// Stripes of a partial render give the same frame buffer as the complete area
+static void test_bilinear_stripes()
+{
+    source_fill();
+    const lv_area_t area = {.x1 = 0, .y1 = 0, .x2 = WIDTH - 1, .y2 = HEIGHT - 1};
+    smartdisplay_upscale_reset(&upscale);
+    smartdisplay_upscale_bilinear(&upscale, &frame_buffer[0][0], WIDTH * 2, &area, &source[0][0], WIDTH);
+    static uint16_t expected[HEIGHT * 2][WIDTH * 2];
+    memcpy(expected, frame_buffer, sizeof(frame_buffer));
+
+    memset(frame_buffer, 0, sizeof(frame_buffer));
+    smartdisplay_upscale_reset(&upscale);
+    const int32_t stripes[] = {0, 5, 6, 11};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const lv_area_t stripe = {.x1 = 0, .y1 = stripes[i], .x2 = WIDTH - 1, .y2 = stripes[i + 1] - (i < 2 ? 1 : 0)};
+        const int32_t first_row = smartdisplay_upscale_bilinear(&upscale, &frame_buffer[0][0], WIDTH * 2, &stripe, &source[stripe.y1][0], WIDTH);
+        // The odd row above the stripe is written again
+        TEST_CHECK_EQUAL(i == 0 ? 0 : 2 * stripe.y1 - 1, first_row);
+    }
+
+    TEST_CHECK(memcmp(expected, frame_buffer, sizeof(frame_buffer)) == 0);
+
+    // Not below the previous area: the row is not changed
+    const uint16_t before = frame_buffer[3][0];
+    const lv_area_t below = {.x1 = 0, .y1 = 2, .x2 = 3, .y2 = 3};
+    TEST_CHECK_EQUAL(4, smartdisplay_upscale_bilinear(&upscale, &frame_buffer[0][0], WIDTH * 2, &below, &source[2][0], WIDTH));
+    TEST_CHECK_EQUAL(before, frame_buffer[3][0]);
+}
+
+int main()
+{
+    TEST_CHECK(smartdisplay_upscale_init(&upscale, WIDTH));
+    TEST_RUN(test_nearest);
+    TEST_RUN(test_bilinear);
+    TEST_RUN(test_bilinear_stripes);
+    return TEST_RESULT();
+}
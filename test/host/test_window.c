@@ -0,0 +1,254 @@
+// Address windows of the shadow buffer and round mask: the windows are drawn on a simulated panel memory and the result
+// is compared with the rendered area
+#include <esp32_smartdisplay_window.h>
+#include <esp_lcd_panel_ops.h>
+#include <string.h>
+#include "test.h"
+
+#define WIDTH 240
+#define HEIGHT 240
+#define WINDOW_COST 96
+
+static uint16_t gram[HEIGHT][WIDTH];
+static uint32_t draws;
+
+static smartdisplay_window_t windows[HEIGHT];
+static smartdisplay_window_list_t list;
+
+// Panel memory, the rows of the window are contiguous in the color data
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    const uint16_t *src = color_data;
+    for (int y = y_start; y < y_end; y++)
+        for (int x = x_start; x < x_end; x++)
+            gram[y][x] = *src++;
+
+    draws++;
+    return ESP_OK;
+}
+
+static void list_init(uint32_t max_windows)
+{
+    memset(&list, 0, sizeof(list));
+    list.windows = windows;
+    list.max_windows = max_windows;
+    list.window_cost = WINDOW_COST;
+}
+
+// Pixels of the area with the value of the position on the display
+static void area_fill(const lv_area_t *area, uint16_t *pixels)
+{
+    for (int32_t y = area->y1; y <= area->y2; y++)
+        for (int32_t x = area->x1; x <= area->x2; x++)
+            *pixels++ = y * WIDTH + x;
+}
+
+static void test_circle()
+{
+    int16_t x1[HEIGHT], x2[HEIGHT];
+    smartdisplay_window_circle(WIDTH, HEIGHT, x1, x2);
+    // Top row and a full row in the middle
+    TEST_CHECK_EQUAL(109, x1[0]);
+    TEST_CHECK_EQUAL(130, x2[0]);
+    TEST_CHECK_EQUAL(0, x1[HEIGHT / 2]);
+    TEST_CHECK_EQUAL(WIDTH - 1, x2[HEIGHT / 2]);
+    for (int32_t y = 0; y < HEIGHT; y++)
+    {
+        // Symmetric in both directions
+        TEST_CHECK_EQUAL(WIDTH - 1, x1[y] + x2[y]);
+        TEST_CHECK_EQUAL(x1[y], x1[HEIGHT - 1 - y]);
+    }
+}
+
+static void test_round_clip()
+{
+    int16_t x1[HEIGHT], x2[HEIGHT];
+    smartdisplay_window_circle(WIDTH, HEIGHT, x1, x2);
+    static uint16_t pixels[WIDTH * 40];
+    const lv_area_t area = {.x1 = 0, .y1 = 0, .x2 = WIDTH - 1, .y2 = 39};
+    area_fill(&area, pixels);
+    memset(gram, 0xff, sizeof(gram));
+    draws = 0;
+
+    list_init(HEIGHT);
+    smartdisplay_window_begin(&list, &area);
+    for (int32_t y = area.y1; y <= area.y2; y++)
+        smartdisplay_window_add(&list, y, x1[y], x2[y]);
+    smartdisplay_window_end(&list, true);
+    TEST_CHECK(list.count > 1);
+    TEST_CHECK(list.bytes < lv_area_get_size(&area) * sizeof(uint16_t));
+    TEST_CHECK(smartdisplay_window_send(&list, NULL, pixels));
+    TEST_CHECK_EQUAL(list.count, draws);
+
+    // Every visible pixel is sent with the right value, the merged windows send only a few pixels outside the circle
+    uint32_t outside = 0;
+    for (int32_t y = area.y1; y <= area.y2; y++)
+        for (int32_t x = 0; x < WIDTH; x++)
+        {
+            if (x >= x1[y] && x <= x2[y])
+                TEST_CHECK_EQUAL(y * WIDTH + x, gram[y][x]);
+            else if (gram[y][x] != 0xffff)
+            {
+                TEST_CHECK_EQUAL(y * WIDTH + x, gram[y][x]);
+                outside++;
+            }
+        }
+
+    TEST_CHECK(outside * sizeof(uint16_t) <= (list.count + area.y2 - area.y1) * WINDOW_COST);
+    TEST_CHECK_EQUAL(list.bytes, list.stats.frame_bytes_sent);
+    TEST_CHECK_EQUAL(lv_area_get_size(&area) * sizeof(uint16_t), list.stats.frame_bytes);
+    TEST_CHECK_EQUAL(list.count, list.stats.frame_windows);
+}
+
+static void test_round_outside()
+{
+    int16_t x1[HEIGHT], x2[HEIGHT];
+    smartdisplay_window_circle(WIDTH, HEIGHT, x1, x2);
+    uint16_t pixels[20 * 10];
+    const lv_area_t area = {.x1 = 0, .y1 = 0, .x2 = 19, .y2 = 9};
+    draws = 0;
+
+    list_init(HEIGHT);
+    smartdisplay_window_begin(&list, &area);
+    for (int32_t y = area.y1; y <= area.y2; y++)
+        if (x1[y] <= area.x2)
+            smartdisplay_window_add(&list, y, x1[y], LV_MIN(x2[y], area.x2));
+    smartdisplay_window_end(&list, true);
+    TEST_CHECK_EQUAL(0, list.count);
+    TEST_CHECK(!smartdisplay_window_send(&list, NULL, pixels));
+    TEST_CHECK_EQUAL(0, draws);
+    TEST_CHECK_EQUAL(0, list.stats.frame_bytes_sent);
+    TEST_CHECK_EQUAL(sizeof(pixels), list.stats.bytes_saved);
+}
+
+static void test_shadow_gaps()
+{
+    uint16_t pixels[WIDTH] = {0}, copy[WIDTH] = {0};
+    const lv_area_t area = {.x1 = 0, .y1 = 5, .x2 = WIDTH - 1, .y2 = 5};
+
+    // Gap of 27 pixels is cheaper than a window
+    pixels[2] = pixels[30] = 1;
+    list_init(HEIGHT);
+    smartdisplay_window_begin(&list, &area);
+    smartdisplay_window_add_changes(&list, 5, pixels, copy);
+    TEST_CHECK_EQUAL(1, list.count);
+    TEST_CHECK_EQUAL(2, windows[0].x1);
+    TEST_CHECK_EQUAL(30, windows[0].x2);
+    TEST_CHECK_EQUAL(29 * sizeof(uint16_t), list.bytes);
+
+    // Gap of 69 pixels is more expensive
+    pixels[30] = 0;
+    pixels[72] = 1;
+    smartdisplay_window_begin(&list, &area);
+    smartdisplay_window_add_changes(&list, 5, pixels, copy);
+    TEST_CHECK_EQUAL(2, list.count);
+    TEST_CHECK_EQUAL(72, windows[1].x1);
+    TEST_CHECK_EQUAL(72, windows[1].x2);
+
+    // No changes
+    smartdisplay_window_begin(&list, &area);
+    smartdisplay_window_add_changes(&list, 5, copy, copy);
+    TEST_CHECK_EQUAL(0, list.count);
+}
+
+static void test_fallback()
+{
+    const lv_area_t area = {.x1 = 10, .y1 = 0, .x2 = 19, .y2 = 3};
+
+    // Windows plus their cost are not cheaper than the area
+    list_init(HEIGHT);
+    smartdisplay_window_begin(&list, &area);
+    for (int32_t y = 0; y <= 3; y += 2)
+        smartdisplay_window_add(&list, y, 0, 5);
+    smartdisplay_window_end(&list, false);
+    TEST_CHECK_EQUAL(1, list.count);
+    TEST_CHECK_EQUAL(0, windows[0].x1);
+    TEST_CHECK_EQUAL(0, windows[0].y1);
+    TEST_CHECK_EQUAL(9, windows[0].x2);
+    TEST_CHECK_EQUAL(3, windows[0].y2);
+    TEST_CHECK_EQUAL(lv_area_get_size(&area) * sizeof(uint16_t), list.bytes);
+    // Not the last area of the frame
+    TEST_CHECK_EQUAL(0, list.stats.frames);
+
+    // More windows than the list holds
+    list_init(2);
+    const lv_area_t wide = {.x1 = 0, .y1 = 0, .x2 = WIDTH - 1, .y2 = 0};
+    smartdisplay_window_begin(&list, &wide);
+    for (int32_t x = 0; x < 3; x++)
+        smartdisplay_window_add(&list, 0, x * 100, x * 100);
+    smartdisplay_window_end(&list, true);
+    TEST_CHECK_EQUAL(1, list.count);
+    TEST_CHECK_EQUAL(WIDTH - 1, windows[0].x2);
+    TEST_CHECK_EQUAL(1, list.stats.frames);
+}
+
+// Random changes on a copy of the panel memory: after sending the windows the panel memory matches the area
+static void test_shadow_random()
+{
+    static uint16_t pixels[WIDTH * 64], copy[WIDTH * 64];
+    const lv_area_t area = {.x1 = 16, .y1 = 100, .x2 = 16 + 199, .y2 = 100 + 63};
+    const int32_t width = lv_area_get_width(&area);
+    uint32_t seed = 1;
+    for (int32_t frame = 0; frame < 50; frame++)
+    {
+        for (int32_t y = area.y1; y <= area.y2; y++)
+            for (int32_t x = area.x1; x <= area.x2; x++)
+                copy[(y - area.y1) * width + x - area.x1] = gram[y][x];
+
+        // Sparse changes, some rows completely changed
+        memcpy(pixels, copy, sizeof(pixels));
+        const uint32_t changes = frame % 8 == 0 ? 1 : 50 * (frame % 5);
+        for (uint32_t i = 0; i < changes; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            pixels[(seed >> 8) % (width * 64)] = seed >> 16;
+        }
+
+        if (frame % 7 == 0)
+            memset(pixels + (frame % 64) * width, frame, width * sizeof(uint16_t));
+
+        list_init(128);
+        smartdisplay_window_begin(&list, &area);
+        for (int32_t y = area.y1; y <= area.y2; y++)
+            smartdisplay_window_add_changes(&list, y, pixels + (y - area.y1) * width, copy + (y - area.y1) * width);
+        smartdisplay_window_end(&list, true);
+        // The windows are moved together in the pixels, keep the rendered area
+        memcpy(copy, pixels, sizeof(pixels));
+        smartdisplay_window_send(&list, NULL, pixels);
+        TEST_CHECK(list.bytes <= sizeof(pixels));
+
+        bool match = true;
+        for (int32_t y = area.y1; y <= area.y2; y++)
+            match &= memcmp(&gram[y][area.x1], copy + (y - area.y1) * width, width * sizeof(uint16_t)) == 0;
+        TEST_CHECK(match);
+    }
+}
+
+static void test_trans_done()
+{
+    const lv_area_t area = {.x1 = 0, .y1 = 0, .x2 = WIDTH - 1, .y2 = 0};
+    uint16_t pixels[WIDTH] = {0};
+    list_init(HEIGHT);
+    smartdisplay_window_begin(&list, &area);
+    smartdisplay_window_add(&list, 0, 0, 0);
+    smartdisplay_window_add(&list, 0, 200, 200);
+    smartdisplay_window_end(&list, true);
+    TEST_CHECK(smartdisplay_window_send(&list, NULL, pixels));
+    TEST_CHECK_EQUAL(2, list.pending);
+    TEST_CHECK(!smartdisplay_window_trans_done(&list));
+    TEST_CHECK(smartdisplay_window_trans_done(&list));
+    // Other transfers (commands) do not wait
+    TEST_CHECK(smartdisplay_window_trans_done(&list));
+}
+
+int main()
+{
+    TEST_RUN(test_circle);
+    TEST_RUN(test_round_clip);
+    TEST_RUN(test_round_outside);
+    TEST_RUN(test_shadow_gaps);
+    TEST_RUN(test_fallback);
+    TEST_RUN(test_shadow_random);
+    TEST_RUN(test_trans_done);
+    return TEST_RESULT();
+}
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Render benchmark table and regression check for the esp32-smartdisplay boards.
+
+Reads the result of
+  - the host benchmark (test/host/benchmark.c): the scenes are rendered by LVGL and flushed through the SPI panel
+    driver of a configuration to a panel IO timed at its pixel clock. CSV table with the columns
+    scene,fps,bus_pct,render_ms,bytes,transactions
+  - a device: the serial output of smartdisplay_benchmark_print(), the lines starting with 'benchmark,'
+
+and prints the fps, bus occupancy and CPU render time per scene.
+
+With --baseline the result is compared with a previous result (a table written by --update or a serial log) and the
+script fails if the fps drops, or the bus occupancy, bytes or transactions per frame grow, more than --tolerance
+percent. The render time is only compared between results of a device: on the host it depends on the machine, so it is
+not written to the baseline of a host result.
+
+Examples:
+    python tools/smartdisplay_benchmark.py build/host/benchmark_ili9341_spi_24mhz.csv --baseline test/host/benchmark/ili9341_spi_24mhz.csv
+    python tools/smartdisplay_benchmark.py serial.log --baseline serial_baseline.csv --tolerance 5
+    python tools/smartdisplay_benchmark.py serial.log --update serial_baseline.csv
+"""
+
+import argparse
+import csv
+import sys
+
+SCENES = ["scroll", "arcs", "fade", "text"]
+# Values that regress when lower or higher
+LOWER_IS_WORSE = ["fps"]
+HIGHER_IS_WORSE = ["bus_pct", "bytes", "transactions", "render_ms"]
+# Columns of the device output of smartdisplay_benchmark_print(), after the 'benchmark' prefix
+DEVICE_COLUMNS = ["scene", "fps", "render_ms", "bus_pct", "flush_ms", "wait_ms", "pixels_per_frame", "scaled_pct"]
+
+
+def on_host(result):
+    # Only the host benchmark counts the bus traffic
+    return "bytes" in result
+
+
+def read_results(path):
+    results = {}
+    with open(path) as file:
+        lines = [line.strip() for line in file if line.strip()]
+
+    if lines and lines[0].startswith("scene,"):
+        # Table of the host benchmark or written by --update
+        for row in csv.DictReader(lines):
+            results[row["scene"]] = {column: float(value) for column, value in row.items() if column != "scene"}
+        return results
+
+    # Serial log of a device
+    for line in lines:
+        fields = line.split(",")
+        if len(fields) >= 5 and fields[0] == "benchmark" and fields[1] in SCENES:
+            # Columns not printed by older versions are missing
+            results[fields[1]] = {column: float(value) for column, value in zip(DEVICE_COLUMNS[1:], fields[2:])}
+    return results
+
+
+def write_baseline(path, results):
+    columns = ["fps", "bus_pct"]
+    if all(on_host(result) for result in results.values()):
+        columns += ["bytes", "transactions"]
+    else:
+        columns += ["render_ms"]
+    with open(path, "w", newline="") as file:
+        writer = csv.writer(file, lineterminator="\n")
+        writer.writerow(["scene"] + columns)
+        for scene, result in results.items():
+            writer.writerow([scene] + [f"{result[column]:g}" for column in columns])
+
+
+def compare(results, baseline, tolerance):
+    regressions = []
+    compared = 0
+    for scene, result in results.items():
+        previous = baseline.get(scene)
+        if previous is None:
+            regressions.append(f"{scene}: not in the baseline")
+            continue
+        compared += 1
+        for column in LOWER_IS_WORSE + HIGHER_IS_WORSE:
+            if column not in result or column not in previous:
+                continue
+            if column == "render_ms" and (on_host(result) or on_host(previous)):
+                continue
+            if column in LOWER_IS_WORSE:
+                regressed = result[column] < previous[column] * (1 - tolerance / 100)
+            else:
+                regressed = result[column] > previous[column] * (1 + tolerance / 100)
+            if regressed:
+                regressions.append(f"{scene}: {column} {previous[column]:g} -> {result[column]:g}")
+    return compared, regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Render benchmark table and regression check for the esp32-smartdisplay boards")
+    parser.add_argument("result", help="output of the host benchmark or serial log of a device")
+    parser.add_argument("--baseline", help="result to compare with")
+    parser.add_argument("--update", help="write the result as the baseline")
+    parser.add_argument("--tolerance", type=float, default=5, help="allowed regression [%%]")
+    args = parser.parse_args()
+
+    results = read_results(args.result)
+    if not results:
+        sys.exit(f"No benchmark results in {args.result}")
+
+    print(f"{'scene':<7} {'fps':>7} {'bus %':>7} {'render ms':>10} {'bytes':>8} {'transactions':>12}")
+    for scene, result in results.items():
+        bytes_per_frame = f"{result['bytes']:>8.0f}" if on_host(result) else f"{'':>8}"
+        transactions = f"{result['transactions']:>12.0f}" if on_host(result) else f"{'':>12}"
+        print(f"{scene:<7} {result['fps']:>7.2f} {result['bus_pct']:>7.1f} {result.get('render_ms', 0):>10.3f} {bytes_per_frame} {transactions}")
+
+    if args.update:
+        write_baseline(args.update, results)
+        print(f"Baseline written to {args.update}")
+
+    if args.baseline:
+        compared, regressions = compare(results, read_results(args.baseline), args.tolerance)
+        if compared == 0:
+            sys.exit(f"No scenes in both {args.result} and {args.baseline}")
+        print(f"Compared {compared} scenes with the baseline")
+        for regression in regressions:
+            print(f"Regression: {regression}", file=sys.stderr)
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Compare panel and touch IO recordings of esp32-smartdisplay (SMARTDISPLAY_IO_RECORDER) with a golden recording.
+
+A recording is the serial output of smartdisplay_io_recorder_dump(), one transaction per line:
+    <io> <rx_param|tx_param|tx_color> <command> <size> <crc32>
+
+The transactions and bytes per IO and operation are summarized for both recordings. The script fails if the command
+streams differ, or with --bytes-only if the number of transactions or bytes increased.
+
+Example:
+    python tools/smartdisplay_io_diff.py golden/esp32-2432S028R_boot.txt serial.log
+"""
+
+import argparse
+import collections
+import difflib
+import sys
+
+
+def read_recording(path):
+    entries = []
+    recording = False
+    with open(path) as file:
+        for line in file:
+            line = line.strip()
+            if line.startswith("# io_recorder"):
+                # Use the last dump in the log
+                entries = []
+                recording = True
+            elif line == "# end":
+                recording = False
+            elif recording and line:
+                fields = line.split()
+                if len(fields) == 5:
+                    entries.append(tuple(fields))
+    return entries
+
+
+def summarize(entries):
+    summary = collections.defaultdict(lambda: [0, 0])
+    for io, op, _cmd, size, _crc in entries:
+        summary[(io, op)][0] += 1
+        summary[(io, op)][1] += int(size)
+    return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare IO recordings with a golden recording")
+    parser.add_argument("golden", help="golden recording")
+    parser.add_argument("recording", help="new recording (serial log)")
+    parser.add_argument("--bytes-only", action="store_true", help="only fail if transactions or bytes increased")
+    args = parser.parse_args()
+
+    golden = read_recording(args.golden)
+    recording = read_recording(args.recording)
+    golden_summary = summarize(golden)
+    summary = summarize(recording)
+
+    increased = False
+    print(f"{'io':<10} {'operation':<9} {'transactions':>24} {'bytes':>28}")
+    for key in sorted(set(golden_summary) | set(summary)):
+        (golden_transactions, golden_bytes), (transactions, size) = golden_summary.get(key, (0, 0)), summary.get(key, (0, 0))
+        increased |= transactions > golden_transactions or size > golden_bytes
+        print(f"{key[0]:<10} {key[1]:<9} {golden_transactions:>10} -> {transactions:<10} {size - golden_bytes:+} {golden_bytes:>10} -> {size:<10}")
+
+    diff = list(difflib.unified_diff([" ".join(e) for e in golden], [" ".join(e) for e in recording], args.golden, args.recording, lineterm="", n=2))
+    for line in diff:
+        print(line)
+
+    if increased or (diff and not args.bytes_only):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+"""
+Pack images and fonts in an asset bundle for esp32-smartdisplay (see include/esp32_smartdisplay_assets.h).
+
+Inputs are given as [name=]path. The name defaults to the file name without extension.
+- *.png, *.jpg: converted to RGB565 (or ARGB8888 if the image has transparency). Requires Pillow
+- *.bin from the LVGL image converter (LVGL v9 binary image)
+- *.bin from lv_font_conv --format bin --no-compress (kerning is not supported)
+- Other files are stored as raw data
+
+Example:
+    python tools/smartdisplay_pack_assets.py -o assets.bin logo.png roboto_24=roboto_24.bin
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"SDAB"
+VERSION = 1
+NAME_LENGTH = 32
+
+ASSET_RAW = 0
+ASSET_IMAGE = 1
+ASSET_FONT = 2
+
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<32sIIII")
+IMAGE = struct.Struct("<BBHHHHH")
+FONT = struct.Struct("<HhhhBBHIIII")
+CMAP = struct.Struct("<IHHHBBII")
+
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_COLOR_FORMAT_ARGB8888 = 0x10
+LV_COLOR_FORMAT_RGB565 = 0x12
+
+# lv_font_fmt_txt_cmap_type_t
+CMAP_FORMAT0_FULL = 0
+CMAP_SPARSE_FULL = 1
+CMAP_FORMAT0_TINY = 2
+CMAP_SPARSE_TINY = 3
+
+
+def align(data, alignment=4):
+    return data + bytes(-len(data) % alignment)
+
+
+def pack_png(path):
+    from PIL import Image
+
+    image = Image.open(path)
+    has_alpha = image.mode in ("RGBA", "LA", "PA") or "transparency" in image.info
+    if has_alpha:
+        image = image.convert("RGBA")
+        pixels = bytearray()
+        for r, g, b, a in image.getdata():
+            pixels += bytes((b, g, r, a))
+        cf, stride = LV_COLOR_FORMAT_ARGB8888, image.width * 4
+    else:
+        image = image.convert("RGB")
+        pixels = bytearray()
+        for r, g, b in image.getdata():
+            pixels += struct.pack("<H", ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+        cf, stride = LV_COLOR_FORMAT_RGB565, image.width * 2
+
+    return IMAGE.pack(cf, 0, 0, image.width, image.height, stride, 0) + pixels
+
+
+def pack_lvgl_image(data):
+    _, cf, flags, w, h, stride, _ = struct.unpack_from("<BBHHHHH", data)
+    return IMAGE.pack(cf, 0, flags, w, h, stride, 0) + data[12:]
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.position = 0
+
+    def read(self, bits):
+        value = 0
+        for _ in range(bits):
+            byte = self.data[self.position >> 3] if (self.position >> 3) < len(self.data) else 0
+            value = (value << 1) | ((byte >> (7 - (self.position & 7))) & 1)
+            self.position += 1
+        return value
+
+    def read_signed(self, bits):
+        value = self.read(bits)
+        return value - (1 << bits) if bits and value & (1 << (bits - 1)) else value
+
+
+def read_tables(data):
+    tables = {}
+    offset = 0
+    while offset + 8 <= len(data):
+        length, label = struct.unpack_from("<I4s", data, offset)
+        if length < 8:
+            break
+        tables[label.decode("ascii")] = (offset, data[offset:offset + length])
+        offset += length
+    return tables
+
+
+def pack_font(path, data):
+    tables = read_tables(data)
+    (head_offset, head) = tables["head"]
+    (
+        _version, _tables_count, _font_size, ascent, descent, _typo_ascent, _typo_descent, _typo_line_gap, _min_y, _max_y,
+        default_advance_width, _kerning_scale, index_to_loc_format, _glyph_id_format, advance_width_format, bpp, xy_bits,
+        wh_bits, advance_width_bits, compression_id, subpixels_mode, _padding, underline_position, underline_thickness,
+    ) = struct.unpack_from("<IHHHhHhHhhHHBBBBBBBBBBhH", head, 8)
+
+    if compression_id != 0:
+        sys.exit(f"{path}: compressed fonts are not supported, use lv_font_conv --no-compress")
+    if "kern" in tables:
+        print(f"{path}: kerning is not supported and ignored", file=sys.stderr)
+
+    # Character maps
+    _, cmap_table = tables["cmap"]
+    (cmap_count,) = struct.unpack_from("<I", cmap_table, 8)
+    cmaps = []
+    for i in range(cmap_count):
+        data_offset, range_start, range_length, glyph_id_start, entries, format_type, _ = struct.unpack_from("<IIHHHBB", cmap_table, 12 + i * 16)
+        unicode_list = glyph_id_ofs_list = None
+        if format_type == CMAP_FORMAT0_FULL:
+            glyph_id_ofs_list = cmap_table[data_offset:data_offset + entries]
+        elif format_type == CMAP_SPARSE_FULL:
+            unicode_list = cmap_table[data_offset:data_offset + entries * 2]
+            glyph_id_ofs_list = cmap_table[data_offset + entries * 2:data_offset + entries * 4]
+        elif format_type == CMAP_SPARSE_TINY:
+            unicode_list = cmap_table[data_offset:data_offset + entries * 2]
+        cmaps.append((range_start, range_length, glyph_id_start, entries, format_type, unicode_list, glyph_id_ofs_list))
+
+    # Glyph locations and glyphs
+    _, loca_table = tables["loca"]
+    (loca_count,) = struct.unpack_from("<I", loca_table, 8)
+    loca_format = "<H" if index_to_loc_format == 0 else "<I"
+    loca_size = struct.calcsize(loca_format)
+    glyph_offsets = [struct.unpack_from(loca_format, loca_table, 12 + i * loca_size)[0] for i in range(loca_count)]
+
+    _, glyf_table = tables["glyf"]
+    glyph_dsc = bytearray()
+    glyph_bitmap = bytearray()
+    header_bits = advance_width_bits + 2 * xy_bits + 2 * wh_bits
+    for i, start in enumerate(glyph_offsets):
+        end = glyph_offsets[i + 1] if i < loca_count - 1 else len(glyf_table)
+        reader = BitReader(glyf_table[start:end])
+        adv_w = reader.read(advance_width_bits) if advance_width_bits else default_advance_width
+        if advance_width_format == 0:
+            adv_w *= 16
+        ofs_x = reader.read_signed(xy_bits)
+        ofs_y = reader.read_signed(xy_bits)
+        box_w = reader.read(wh_bits)
+        box_h = reader.read(wh_bits)
+        if i == 0:
+            adv_w = ofs_x = ofs_y = box_w = box_h = 0
+
+        bitmap_index = len(glyph_bitmap)
+        if box_w * box_h:
+            # Bitmaps start byte aligned, the header bits are removed
+            glyph_bitmap += bytes(reader.read(8) for _ in range(end - start - header_bits // 8))
+
+        if bitmap_index >= 1 << 20 or adv_w >= 1 << 12:
+            sys.exit(f"{path}: font too large")
+
+        glyph_dsc += struct.pack("<IBBbb", bitmap_index | (adv_w << 20), box_w, box_h, ofs_x, ofs_y)
+
+    # Layout: font header, cmaps, lists, glyph descriptions, bitmaps
+    cmaps_offset = FONT.size
+    lists = bytearray()
+    lists_offset = cmaps_offset + CMAP.size * len(cmaps)
+    cmap_records = bytearray()
+    for range_start, range_length, glyph_id_start, entries, format_type, unicode_list, glyph_id_ofs_list in cmaps:
+        unicode_list_offset = glyph_id_ofs_list_offset = 0
+        if unicode_list is not None:
+            lists = align(lists)
+            unicode_list_offset = lists_offset + len(lists)
+            lists += unicode_list
+        if glyph_id_ofs_list is not None:
+            lists = align(lists)
+            glyph_id_ofs_list_offset = lists_offset + len(lists)
+            lists += glyph_id_ofs_list
+        cmap_records += CMAP.pack(range_start, range_length, glyph_id_start, entries, format_type, 0, unicode_list_offset, glyph_id_ofs_list_offset)
+
+    lists = align(lists)
+    glyph_dsc_offset = lists_offset + len(lists)
+    glyph_bitmap_offset = glyph_dsc_offset + len(glyph_dsc)
+    header = FONT.pack(ascent - descent, -descent, underline_position, underline_thickness, bpp, subpixels_mode, len(cmaps), loca_count, glyph_dsc_offset, glyph_bitmap_offset, cmaps_offset)
+    return header + cmap_records + lists + glyph_dsc + glyph_bitmap
+
+
+def pack_file(path):
+    with open(path, "rb") as file:
+        data = file.read()
+
+    extension = os.path.splitext(path)[1].lower()
+    if extension in (".png", ".jpg", ".jpeg", ".bmp"):
+        return ASSET_IMAGE, pack_png(path)
+    if extension == ".bin" and len(data) >= 12 and data[4:8] == b"head":
+        return ASSET_FONT, pack_font(path, data)
+    if extension == ".bin" and len(data) >= 12 and data[0] == LV_IMAGE_HEADER_MAGIC:
+        return ASSET_IMAGE, pack_lvgl_image(data)
+    return ASSET_RAW, data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack images and fonts in an esp32-smartdisplay asset bundle")
+    parser.add_argument("-o", "--output", required=True, help="bundle file to create")
+    parser.add_argument("--partition-size", type=lambda x: int(x, 0), help="fail if the bundle does not fit the partition")
+    parser.add_argument("inputs", nargs="+", help="[name=]path")
+    args = parser.parse_args()
+
+    entries = []
+    for item in args.inputs:
+        name, _, path = item.rpartition("=")
+        name = name or os.path.splitext(os.path.basename(path))[0]
+        if len(name.encode()) >= NAME_LENGTH:
+            sys.exit(f"{name}: name longer than {NAME_LENGTH - 1} characters")
+        asset_type, data = pack_file(path)
+        entries.append((name, asset_type, data))
+
+    data_offset = HEADER.size + ENTRY.size * len(entries)
+    index = bytearray()
+    data = bytearray()
+    for name, asset_type, asset in entries:
+        index += ENTRY.pack(name.encode(), asset_type, data_offset + len(data), len(asset), 0)
+        data = align(data + asset)
+
+    size = data_offset + len(data)
+    if args.partition_size is not None and size > args.partition_size:
+        sys.exit(f"Bundle size {size} exceeds the partition size {args.partition_size}")
+
+    with open(args.output, "wb") as file:
+        file.write(HEADER.pack(MAGIC, VERSION, len(entries), size, 0) + index + data)
+
+    for name, asset_type, asset in entries:
+        print(f"{name:<{NAME_LENGTH}} {('raw', 'image', 'font')[asset_type]:<6} {len(asset):>8} bytes")
+    print(f"Bundle: {args.output}, {len(entries)} entries, {size} bytes")
+
+
+if __name__ == "__main__":
+    main()
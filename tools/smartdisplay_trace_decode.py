@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Decode the deferred traces of esp32-smartdisplay (SMARTDISPLAY_TRACE_LEVEL).
+
+The input is either the serial output of a build with SMARTDISPLAY_TRACE_BINARY (lines starting with '#T') or, with
+--raw, a memory dump of the ring buffer 'trace_ring', e.g. from gdb:
+    dump binary memory trace_ring.bin &trace_ring ((char*)&trace_ring)+sizeof(trace_ring)
+
+The event names and formats are read from the SMARTDISPLAY_TRACE_EVENTS table in include/esp32_smartdisplay_trace.h.
+
+Example:
+    python tools/smartdisplay_trace_decode.py serial.log
+    python tools/smartdisplay_trace_decode.py --raw trace_ring.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# smartdisplay_trace_entry_t: sequence, timestamp, event, core, level, args[4]
+ENTRY = struct.Struct("<IIHBB4I")
+LEVELS = "NEWIDV"
+
+
+def read_events(header):
+    with open(header) as file:
+        return [(name, fmt) for name, fmt in re.findall(r'EVENT\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', file.read())]
+
+
+def read_serial(path):
+    entries = []
+    with open(path, errors="replace") as file:
+        for line in file:
+            match = re.search(r"#T ((?:[0-9a-f]+ ?){9})", line)
+            if match:
+                fields = [int(field, 16) for field in match.group(1).split()]
+                entries.append(tuple(fields))
+    return entries
+
+
+def read_raw(path):
+    with open(path, "rb") as file:
+        data = file.read()
+    entries = [ENTRY.unpack_from(data, offset) for offset in range(0, len(data) - ENTRY.size + 1, ENTRY.size)]
+    # Unused entries have sequence 0. The oldest entry has the lowest sequence number
+    return sorted((entry for entry in entries if entry[0] != 0), key=lambda entry: entry[0])
+
+
+def format_entry(events, entry):
+    sequence, timestamp, event, core, level, *args = entry
+    if event < len(events):
+        name, fmt = events[event]
+        # The arguments are recorded as uint32_t, %d is signed
+        values = tuple(arg - (1 << 32) if arg & 0x80000000 else arg for arg in args[: fmt.count("%")])
+        message = fmt % values
+    else:
+        message = f"event {event}: {', '.join(str(arg) for arg in args)}"
+    level_char = LEVELS[level] if level < len(LEVELS) else "?"
+    return f"[{timestamp:10}][{level_char}][{core}] {message}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the deferred traces of esp32-smartdisplay")
+    parser.add_argument("input", help="serial log or ring buffer dump (--raw)")
+    parser.add_argument("--raw", action="store_true", help="input is a memory dump of trace_ring")
+    parser.add_argument("--header", default=os.path.join(os.path.dirname(__file__), "..", "include", "esp32_smartdisplay_trace.h"), help="header with the trace events")
+    args = parser.parse_args()
+
+    events = read_events(args.header)
+    if not events:
+        sys.exit(f"No trace events found in {args.header}")
+
+    entries = read_raw(args.input) if args.raw else read_serial(args.input)
+    previous = None
+    for entry in entries:
+        # Gaps in the sequence numbers are entries not drained or overwritten in the dump
+        if previous is not None and entry[0] != previous + 1:
+            print(f"... {entry[0] - previous - 1} entries missing")
+        previous = entry[0]
+        print(format_entry(events, entry))
+
+
+if __name__ == "__main__":
+    main()